@@ -0,0 +1,416 @@
+#include "alpha_beta_engine.h"
+#include "eval/evaluation.h"
+
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+/*! Centipawn value of each piece type used to order captures. */
+const int kValues[] = {0, 100, 320, 330, 500, 900, 0};
+
+/*! Moves searched at full depth before late move reductions apply. */
+const int kLateMoves = 3;
+
+/*! Depth at and above which null move cutoffs are verified. */
+const int kVerifyDepth = 8;
+
+/*! Reverse futility margin per ply of remaining depth. */
+const int kReverseFutilityMargin = 120;
+
+/*! Futility margins indexed by remaining depth. */
+const int kFutilityMargins[] = {0, 200, 450};
+
+/*!
+ * Mate scores are stored relative to the node rather than the root, so that a
+ * mate found through a transposition is reported at the correct distance.
+ */
+inline int to_table(int score, int ply) {
+	if (score > AlphaBetaEngine::kMateBound) return score + ply;
+	if (score < -AlphaBetaEngine::kMateBound) return score - ply;
+	return score;
+}
+
+inline int from_table(int score, int ply) {
+	if (score > AlphaBetaEngine::kMateBound) return score - ply;
+	if (score < -AlphaBetaEngine::kMateBound) return score + ply;
+	return score;
+}
+
+inline bool is_promotion(PackedMove move) {
+	return type(move) >= MoveType::kPromoteQueen;
+}
+
+/*!
+ * Swaps the highest scoring remaining move into position i. Selection sort is
+ * cheaper than sorting the whole list, because a cutoff usually occurs after
+ * the first few moves.
+ */
+inline PackedMove pick(MoveList& list, int* scores, int i) {
+	int best = i;
+	for (int j = i + 1; j < list.size; j++)
+		if (scores[j] > scores[best])
+			best = j;
+	std::swap(list[i], list[best]);
+	std::swap(scores[i], scores[best]);
+	return list[i];
+}
+
+} // namespace
+
+Move AlphaBetaEngine::select(const std::set<Move>& moves) {
+	Board board(_game->history());
+	MoveList list;
+	for (auto move : moves)
+		list.push(pack(move));
+
+	PackedMove best = select(board, list);
+	for (auto move : moves)
+		if (pack(move) == best)
+			return move;
+	return *moves.begin();
+}
+
+PackedMove AlphaBetaEngine::iterate(Board& board, const MoveList& moves,
+		const Limits& limits, int count) {
+	std::vector<PackedMove> root(moves.moves, moves.moves + moves.size);
+	_lines.clear();
+	if (root.empty())
+		return 0;
+
+	_stats = SearchStats();
+	_clock.start(limits);
+
+	// Killers are indexed by ply, which shifts between searches, but history
+	// scores still describe good moves; they are aged so that moves that were
+	// good in the current search soon outweigh those of earlier ones.
+	std::memset(_killers, 0, sizeof(_killers));
+	for (auto& row : _history)
+		for (auto& score : row)
+			score /= 2;
+
+	int max_depth = limits.depth ? limits.depth :
+		limits.open_ended() ? kMaxDepth / 2 : _options.depth;
+	size_t lines = std::min(root.size(), static_cast<size_t>(std::max(count, 1)));
+
+	// Iterative deepening: each iteration searches the best move of the
+	// previous iteration first, which makes the remaining moves cheap to
+	// refute and fills the table with good moves for deeper iterations. It
+	// also means a search may be abandoned at any time; the best move of the
+	// last completed iteration is always available.
+	for (int depth = 1; depth <= max_depth; depth++) {
+		if (depth > 1 && !_clock.deepen())
+			break;
+
+		// Multiple lines are found one at a time: the kth line is the best of
+		// the moves that do not begin one of the k - 1 lines before it.
+		std::vector<Line> found;
+		for (size_t k = 0; k < lines; k++) {
+			int alpha = -kInfinity, beta = kInfinity;
+			size_t best = k;
+
+			for (size_t i = k; i < root.size(); i++) {
+				if (!board.make(root[i]))
+					continue;
+
+				int score;
+				if (alpha == -kInfinity) {
+					score = -search(board, -beta, -alpha, depth - 1, 1, true);
+				} else {
+					score = -search(board, -alpha - 1, -alpha, depth - 1, 1, true);
+					if (score > alpha && !_clock.aborted())
+						score = -search(board, -beta, -alpha, depth - 1, 1, true);
+				}
+				board.undo();
+
+				// Scores of interrupted searches are meaningless, but any move
+				// that completed a search and beat the previous best is safe
+				if (_clock.aborted())
+					break;
+
+				if (score > alpha) {
+					alpha = score;
+					best = i;
+				}
+			}
+
+			std::rotate(root.begin() + k, root.begin() + best,
+				root.begin() + best + 1);
+			if (_clock.aborted() || alpha == -kInfinity)
+				break;
+			found.push_back(Line(alpha, principal_variation(board, root[k])));
+		}
+
+		if (_clock.aborted() || found.empty())
+			break;
+
+		_lines.swap(found);
+		_stats.depth = depth;
+		_stats.score = _lines.front().score;
+		_stats.time = _clock.elapsed();
+		if (_listener)
+			_listener(_stats, _lines);
+	}
+
+	return root.front();
+}
+
+void AlphaBetaEngine::clear() {
+	_table.clear();
+	_pawns.clear();
+	_lines.clear();
+	std::memset(_killers, 0, sizeof(_killers));
+	std::memset(_history, 0, sizeof(_history));
+}
+
+std::vector<PackedMove> AlphaBetaEngine::principal_variation(Board& board,
+		PackedMove first) {
+	std::vector<PackedMove> pv;
+	PackedMove move = first;
+	TableEntry entry;
+
+	while (move && pv.size() < static_cast<size_t>(kMaxDepth)) {
+		// Table moves may come from a different position with a colliding
+		// hash, so make sure the move is actually playable here.
+		MoveList list;
+		board.moves(list);
+		if (std::find(list.begin(), list.end(), move) == list.end() ||
+				!board.make(move))
+			break;
+
+		pv.push_back(move);
+		if (board.is_draw() || !_table.probe(board.key(), entry))
+			break;
+		move = entry.move;
+	}
+
+	for (size_t i = 0; i < pv.size(); i++)
+		board.undo();
+	return pv;
+}
+
+int AlphaBetaEngine::search(Board& board, int alpha, int beta, int depth,
+		int ply, bool null_ok) {
+	if (depth <= 0)
+		return quiesce(board, alpha, beta, ply);
+	if (_clock.check(_stats.nodes + _stats.qnodes))
+		return 0;
+
+	_stats.nodes++;
+	if (board.is_draw())
+		return 0;
+	if (ply >= kMaxDepth - 1)
+		return evaluate(board, _pawns);
+
+	// Endgames in the tablebase are solved: score wins and losses as mates at
+	// the distance the table gives. The root is searched to choose a move.
+	int wdl, dtm;
+	if (_tablebase && ply > 0 && _tablebase->probe(board, wdl, dtm)) {
+		_stats.tablebase_hits++;
+		if (wdl > 0)
+			return kMate - ply - (2 * dtm - 1);
+		return (wdl < 0) ? -(kMate - ply - 2 * dtm) : 0;
+	}
+
+	// Probe the transposition table. Scores are only trusted outside of the
+	// principal variation, so that the PV is never cut short.
+	bool pv = beta - alpha > 1;
+	TableEntry entry;
+	PackedMove best_move = 0;
+	if (_table.probe(board.key(), entry)) {
+		best_move = entry.move;
+		int score = from_table(entry.score, ply);
+		if (!pv && entry.depth >= depth &&
+				(entry.bound == Bound::kExact ||
+				(entry.bound == Bound::kLower && score >= beta) ||
+				(entry.bound == Bound::kUpper && score <= alpha)))
+			return score;
+	}
+
+	bool check = board.in_check();
+	int eval = check ? -kInfinity : evaluate(board, _pawns);
+
+	// Reverse futility pruning: near the horizon, a position whose static
+	// score beats beta by a margin that grows with depth will almost always
+	// fail high, so return without searching it.
+	if (_options.reverse_futility && !pv && !check && depth <= 3 &&
+			std::abs(beta) < kMateBound &&
+			eval - kReverseFutilityMargin * depth >= beta) {
+		_stats.reverse_futility_prunes++;
+		return eval;
+	}
+
+	// Null move pruning: if passing still fails high on a reduced search, a
+	// real move would almost certainly do so too. Passing is only assumed to
+	// be bad when the side to move has pieces besides pawns; king and pawn
+	// endings are riddled with zugzwang, where passing would be best. Deep
+	// cutoffs are verified with a reduced search of the real position.
+	if (_options.null_move && null_ok && !pv && !check && depth >= 3 &&
+			eval >= beta && board.has_pieces(board.turn())) {
+		_stats.null_tries++;
+		int reduction = 2 + depth / 6;
+
+		board.make_null();
+		int score = -search(board, -beta, -beta + 1, depth - 1 - reduction,
+			ply + 1, false);
+		board.undo_null();
+		if (_clock.aborted())
+			return 0;
+
+		if (score >= beta && depth >= kVerifyDepth)
+			score = search(board, beta - 1, beta, depth - 1 - reduction, ply,
+				false);
+
+		if (score >= beta) {
+			_stats.null_cutoffs++;
+			return (score > kMateBound) ? beta : score;
+		}
+	}
+
+	// Futility pruning: at frontier nodes whose static score is far below
+	// alpha, quiet moves cannot raise the score enough to matter.
+	bool futile = _options.futility && !pv && !check && depth <= 2 &&
+		std::abs(alpha) < kMateBound &&
+		eval + kFutilityMargins[depth] <= alpha;
+
+	MoveList list;
+	int scores[256];
+	board.moves(list);
+	order(board, list, scores, best_move, ply);
+
+	int original = alpha;
+	int best = -kInfinity;
+	int legal = 0;
+	best_move = 0;
+
+	for (int i = 0; i < list.size; i++) {
+		PackedMove move = pick(list, scores, i);
+		bool quiet = !board.is_capture(move) && !is_promotion(move);
+		if (!board.make(move))
+			continue;
+
+		legal++;
+		bool gives_check = board.in_check();
+		if (futile && legal > 1 && quiet && !gives_check) {
+			_stats.futility_prunes++;
+			board.undo();
+			continue;
+		}
+
+		int score;
+		if (legal == 1) {
+			score = -search(board, -beta, -alpha, depth - 1, ply + 1, true);
+		} else {
+			// Late move reductions: well ordered moves near the end of the
+			// list rarely raise alpha, so search them to a reduced depth and
+			// only re-search at full depth if they unexpectedly do.
+			int reduction = 0;
+			if (_options.late_move_reductions && depth >= 3 &&
+					legal > kLateMoves && quiet && !check && !gives_check &&
+					move != _killers[ply][0] && move != _killers[ply][1]) {
+				reduction = std::min(depth - 2, (legal > 4 * kLateMoves) ? 2 : 1);
+				_stats.lmr_reductions++;
+			}
+
+			score = -search(board, -alpha - 1, -alpha, depth - 1 - reduction,
+				ply + 1, true);
+			if (reduction && score > alpha) {
+				_stats.lmr_researches++;
+				score = -search(board, -alpha - 1, -alpha, depth - 1, ply + 1, true);
+			}
+			if (score > alpha && score < beta)
+				score = -search(board, -beta, -alpha, depth - 1, ply + 1, true);
+		}
+		board.undo();
+		if (_clock.aborted())
+			return 0;
+
+		if (score > best) {
+			best = score;
+			best_move = move;
+			if (score > alpha)
+				alpha = score;
+			if (score >= beta) {
+				if (quiet) {
+					if (_killers[ply][0] != move) {
+						_killers[ply][1] = _killers[ply][0];
+						_killers[ply][0] = move;
+					}
+					_history[from(move)][to(move)] += depth * depth;
+				}
+				break;
+			}
+		}
+	}
+
+	// No legal moves: checkmate or stalemate
+	if (!legal)
+		return check ? -kMate + ply : 0;
+
+	Bound bound = (best >= beta) ? Bound::kLower :
+		(best > original) ? Bound::kExact : Bound::kUpper;
+	_table.store(board.key(), best_move, to_table(best, ply), depth, bound);
+	return best;
+}
+
+int AlphaBetaEngine::quiesce(Board& board, int alpha, int beta, int ply) {
+	if (_clock.check(_stats.nodes + _stats.qnodes))
+		return 0;
+	_stats.qnodes++;
+
+	// Stand pat: the side to move may usually decline to capture
+	int best = evaluate(board, _pawns);
+	if (best >= beta || ply >= kMaxDepth - 1)
+		return best;
+	if (best > alpha)
+		alpha = best;
+
+	MoveList list;
+	int scores[256];
+	board.captures(list);
+	order(board, list, scores, 0, ply);
+
+	for (int i = 0; i < list.size; i++) {
+		PackedMove move = pick(list, scores, i);
+		if (!board.make(move))
+			continue;
+		int score = -quiesce(board, -beta, -alpha, ply + 1);
+		board.undo();
+		if (_clock.aborted())
+			return 0;
+
+		if (score > best) {
+			best = score;
+			if (score > alpha)
+				alpha = score;
+			if (score >= beta)
+				break;
+		}
+	}
+
+	return best;
+}
+
+void AlphaBetaEngine::order(const Board& board, MoveList& list, int* scores,
+		PackedMove best, int ply) const {
+	for (int i = 0; i < list.size; i++) {
+		PackedMove move = list[i];
+		if (move == best)
+			scores[i] = 1 << 30;
+		else if (board.is_capture(move) || is_promotion(move))
+			scores[i] = (1 << 29) + 8 * kValues[kind(board.at(to(move)))] -
+				kValues[kind(board.at(from(move)))] / 100;
+		else if (move == _killers[ply][0])
+			scores[i] = (1 << 28) + 1;
+		else if (move == _killers[ply][1])
+			scores[i] = 1 << 28;
+		else
+			scores[i] = _history[from(move)][to(move)];
+	}
+}
+
+} // namespace chess
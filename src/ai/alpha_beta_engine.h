@@ -0,0 +1,367 @@
+#ifndef AI_ALPHA_BETA_ENGINE_H
+#define AI_ALPHA_BETA_ENGINE_H
+
+#include "engine.h"
+#include "core/game.h"
+#include "core/move.h"
+#include "struct/board.h"
+#include "struct/transposition_table.h"
+#include "eval/pawn_table.h"
+#include "search/time_manager.h"
+#include "tablebase/tablebase.h"
+
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * Toggles for the selective search heuristics. Every heuristic trades a small
+ * risk of overlooking a tactic for a large reduction in nodes searched; each
+ * may be switched off independently to measure that trade.
+ */
+struct SearchOptions {
+	int depth;
+	size_t table_size;
+	size_t pawn_table_size;
+	bool null_move;
+	bool late_move_reductions;
+	bool reverse_futility;
+	bool futility;
+
+	/*!
+	 * Constructs the default options: a six ply search with a 16 MB
+	 * transposition table, a 1 MB pawn table and every heuristic enabled.
+	 */
+	SearchOptions() : depth(6), table_size(16), pawn_table_size(1),
+		null_move(true), late_move_reductions(true), reverse_futility(true),
+		futility(true) {}
+};
+
+/*!
+ * Counters collected over a single call to select(). Comparing node counts with
+ * and without a heuristic enabled measures how much of the tree it removes.
+ */
+struct SearchStats {
+	int depth;
+	int score;
+	int64_t time;
+	uint64_t nodes;
+	uint64_t qnodes;
+	uint64_t null_tries;
+	uint64_t null_cutoffs;
+	uint64_t lmr_reductions;
+	uint64_t lmr_researches;
+	uint64_t reverse_futility_prunes;
+	uint64_t futility_prunes;
+	uint64_t tablebase_hits;
+
+	SearchStats() : depth(0), score(0), time(0), nodes(0), qnodes(0), null_tries(0), null_cutoffs(0),
+		lmr_reductions(0), lmr_researches(0), reverse_futility_prunes(0),
+		futility_prunes(0), tablebase_hits(0) {}
+};
+
+/*!
+ * One line of analysis: a root move, its score and the principal variation
+ * that begins with it.
+ */
+struct Line {
+	int score;
+	std::vector<PackedMove> moves;
+
+	Line(int score, const std::vector<PackedMove>& moves)
+		: score(score), moves(moves) {}
+};
+
+/*!
+ * This engine selects moves using an iterative deepening, principal variation
+ * alpha-beta search over a Board. The full width search is made selective by
+ * null move pruning, late move reductions and (reverse) futility pruning, each
+ * of which may be toggled through SearchOptions. The engine plays the game it
+ * was constructed with; every call to select() searches the current position.
+ * Searches may be limited by depth, time or nodes and stopped from another
+ * thread, in which case the best move of the deepest completed search is
+ * returned. The transposition table and move ordering history are kept from
+ * one search to the next, so that consecutive moves of a game (and searches
+ * that ponder on the expected reply) build on the work of earlier searches.
+ */
+class AlphaBetaEngine : public Engine {
+public:
+	/*! Score of delivering mate on the current move. */
+	static const int kMate = 30000;
+
+	/*! Scores beyond this magnitude are forced mates. */
+	static const int kMateBound = kMate - 1000;
+
+	/*! Score larger than any reachable score. */
+	static const int kInfinity = 32000;
+
+	/*! Deepest ply the search may reach, including quiescence. */
+	static const int kMaxDepth = 128;
+
+	/*!
+	 * Callback invoked after every completed iteration with the statistics of
+	 * the search so far and the best lines, best first.
+	 */
+	typedef std::function<void(const SearchStats&,
+		const std::vector<Line>&)> Listener;
+
+private:
+	Game* _game;
+	TranspositionTable _table;
+	PawnTable _pawns;
+	SearchOptions _options;
+	SearchStats _stats;
+	TimeManager _clock;
+	Listener _listener;
+	std::vector<Line> _lines;
+	const Tablebase* _tablebase;
+
+	PackedMove _killers[kMaxDepth][2];
+	int _history[64][64];
+
+	/*!
+	 * Searches the position to the specified depth and returns its score from
+	 * the perspective of the side to move. The score is exact if it lies within
+	 * (alpha, beta) and a bound otherwise.
+	 * @param[in, out] board Position to search.
+	 * @param[in] alpha Lower bound of the search window.
+	 * @param[in] beta Upper bound of the search window.
+	 * @param[in] depth Remaining depth in plies.
+	 * @param[in] ply Distance from the root in plies.
+	 * @param[in] null_ok False if the previous move was a null move.
+	 * @return Score of the position.
+	 */
+	int search(Board& board, int alpha, int beta, int depth, int ply,
+		bool null_ok);
+
+	/*!
+	 * Searches captures until the position is quiet, so that the static
+	 * evaluation is never taken in the middle of an exchange.
+	 * @param[in, out] board Position to search.
+	 * @param[in] alpha Lower bound of the search window.
+	 * @param[in] beta Upper bound of the search window.
+	 * @param[in] ply Distance from the root in plies.
+	 * @return Score of the position.
+	 */
+	int quiesce(Board& board, int alpha, int beta, int ply);
+
+	/*!
+	 * Assigns an ordering score to every move in the list. Moves are searched
+	 * in descending order: the table move, captures by most valuable victim and
+	 * least valuable attacker, killer moves and finally by history.
+	 * @param[in] board Position the moves were generated for.
+	 * @param[in] list Moves to score.
+	 * @param[out] scores Ordering score of each move.
+	 * @param[in] best Move suggested by the transposition table.
+	 * @param[in] ply Distance from the root in plies.
+	 */
+	void order(const Board& board, MoveList& list, int* scores,
+		PackedMove best, int ply) const;
+
+	/*!
+	 * Searches the root position by iterative deepening. Each iteration finds
+	 * the best move, then the best of the remaining moves and so on until the
+	 * requested number of lines is found; the lines share the transposition
+	 * table, so every line after the first is cheap to search.
+	 * @param[in, out] board Position to search.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @param[in] limits Search constraints.
+	 * @param[in] count Number of lines to search.
+	 * @return Best move, or zero if there were no candidates.
+	 */
+	PackedMove iterate(Board& board, const MoveList& moves, const Limits& limits,
+		int count);
+
+	/*!
+	 * Reconstructs the principal variation by following best moves through
+	 * the transposition table, starting with the specified root move. The walk
+	 * stops at the first missing or illegal move, or at a repetition.
+	 * @param[in, out] board Root position; restored on return.
+	 * @param[in] first Best move at the root.
+	 * @return Principal variation.
+	 */
+	std::vector<PackedMove> principal_variation(Board& board, PackedMove first);
+
+public:
+	/*!
+	 * Constructs an engine that is not attached to a game. Such an engine may
+	 * only search boards passed to it explicitly.
+	 * @param[in] options Search options.
+	 */
+	explicit AlphaBetaEngine(const SearchOptions& options = SearchOptions())
+		: _game(nullptr), _table(options.table_size),
+		_pawns(options.pawn_table_size), _options(options), _tablebase(nullptr) {
+		clear();
+	}
+
+	/*!
+	 * Constructs an engine that plays the specified game.
+	 * @param[in] game Game to play.
+	 * @param[in] options Search options.
+	 */
+	AlphaBetaEngine(Game& game, const SearchOptions& options = SearchOptions())
+		: _game(&game), _table(options.table_size),
+		_pawns(options.pawn_table_size), _options(options), _tablebase(nullptr) {
+		clear();
+	}
+
+	/*!
+	 * Searches the current position of the game and selects the best of the
+	 * candidate moves. The engine must have been constructed with a game.
+	 * @param[in] moves Candidate moves.
+	 * @return Optimal move.
+	 */
+	Move select(const std::set<Move>& moves) override;
+
+	/*!
+	 * Searches the position on the board and selects the best of the candidate
+	 * moves. The board is restored to its original position on return.
+	 * @param[in, out] board Position to search.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @return Optimal move, or zero if there were no candidates.
+	 */
+	inline PackedMove select(Board& board, const MoveList& moves) {
+		return select(board, moves, Limits());
+	}
+
+	/*!
+	 * Searches the position on the board within the specified limits and
+	 * selects the best of the candidate moves. Unless limited by depth, time
+	 * or nodes, the search deepens to the depth in the search options.
+	 * @param[in, out] board Position to search.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @param[in] limits Search constraints.
+	 * @return Optimal move, or zero if there were no candidates.
+	 */
+	inline PackedMove select(Board& board, const MoveList& moves,
+			const Limits& limits) override {
+		return iterate(board, moves, limits, 1);
+	}
+
+	/*!
+	 * Searches the position on the board within the specified limits and
+	 * returns the specified number of best lines, best first. Fewer lines are
+	 * returned if there are fewer candidates, and none if the search was
+	 * stopped before its first iteration completed.
+	 * @param[in, out] board Position to search.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @param[in] limits Search constraints.
+	 * @param[in] count Number of lines.
+	 * @return Best lines of the deepest completed iteration.
+	 */
+	inline const std::vector<Line>& analyse(Board& board, const MoveList& moves,
+			const Limits& limits, int count) {
+		iterate(board, moves, limits, count);
+		return _lines;
+	}
+
+	/*!
+	 * Stops the current search as soon as possible. Thread-safe; see
+	 * TimeManager::stop().
+	 */
+	inline void stop() {
+		_clock.stop();
+	}
+
+	/*!
+	 * Reports that the opponent played the expected reply, so that a search
+	 * started with Limits::ponder becomes subject to its time limits.
+	 * Thread-safe; see TimeManager::ponderhit().
+	 */
+	inline void ponderhit() {
+		_clock.ponderhit();
+	}
+
+	/*!
+	 * Withdraws a pending stop request or ponder hit. Thread-safe; see
+	 * TimeManager::reset().
+	 */
+	inline void reset() {
+		_clock.reset();
+	}
+
+	/*!
+	 * Forgets everything learned by earlier searches. Should be called between
+	 * unrelated games; within a game, retained knowledge speeds up searches.
+	 */
+	void clear() override;
+
+	/*!
+	 * Registers a callback to be invoked, on the searching thread, after every
+	 * completed iteration. Used to report progress to user interfaces.
+	 * @param[in] listener Progress callback.
+	 */
+	inline void listen(const Listener& listener) {
+		_listener = listener;
+	}
+
+	/*!
+	 * Returns the search options. Options may be changed between searches,
+	 * but table sizes only take effect when the engine is constructed.
+	 * @return Search options.
+	 */
+	inline SearchOptions& options() {
+		return _options;
+	}
+
+	/*!
+	 * Lets the search look up endgames in the tablebase, whose positions then
+	 * need no search at all. The tablebase must outlive the engine.
+	 * @param[in] tablebase Tablebase, or nullptr to search every position.
+	 */
+	inline void tablebase(const Tablebase* tablebase) {
+		_tablebase = tablebase;
+	}
+
+	/*!
+	 * Returns the score of the best line found by the last search.
+	 * @return Score in centipawns, from the perspective of the side to move.
+	 */
+	inline int score() const override {
+		return _stats.score;
+	}
+
+	/*!
+	 * Returns the counters collected by the last call to select().
+	 * @return Search statistics.
+	 */
+	inline const SearchStats& stats() const {
+		return _stats;
+	}
+
+	/*!
+	 * Returns the best lines of the deepest iteration completed by the last
+	 * search, best first.
+	 * @return Best lines.
+	 */
+	inline const std::vector<Line>& lines() const {
+		return _lines;
+	}
+
+	/*!
+	 * Returns the reply the last search expects the opponent to play, which
+	 * is the move to ponder on.
+	 * @return Expected reply, or zero if unknown.
+	 */
+	inline PackedMove prediction() const {
+		if (_lines.empty() || _lines.front().moves.size() < 2)
+			return 0;
+		return _lines.front().moves[1];
+	}
+
+	/*!
+	 * Returns the pawn structure cache, whose hit and miss counters accumulate
+	 * over every search made by this engine.
+	 * @return Pawn table.
+	 */
+	inline const PawnTable& pawns() const {
+		return _pawns;
+	}
+};
+
+} // namespace chess
+
+#endif // AI_ALPHA_BETA_ENGINE_H
@@ -0,0 +1,99 @@
+#include "book.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chess {
+
+namespace {
+
+/*! Identifies book files. */
+const char kMagic[4] = {'C', 'H', 'B', 'K'};
+
+/*! Version of the book format. */
+const uint32_t kVersion = 1;
+
+} // namespace
+
+Book::Book() : _entries(nullptr), _size(0), _mapping(nullptr), _length(0) {}
+
+Book::~Book() {
+	close();
+}
+
+void Book::close() {
+	if (_mapping)
+		munmap(_mapping, _length);
+	_entries = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_length = 0;
+}
+
+bool Book::open(const std::string& path) {
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 ||
+			static_cast<size_t>(info.st_size) < sizeof(Header)) {
+		::close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	size_t length = static_cast<size_t>(info.st_size);
+	void* mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED)
+		return false;
+
+	const Header* header = static_cast<const Header*>(mapping);
+	if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+			header->version != kVersion ||
+			length != sizeof(Header) + header->size * sizeof(BookEntry)) {
+		munmap(mapping, length);
+		return false;
+	}
+
+	_mapping = mapping;
+	_length = length;
+	_size = header->size;
+	_entries = reinterpret_cast<const BookEntry*>(
+		static_cast<const char*>(mapping) + sizeof(Header));
+	return true;
+}
+
+Book::Range Book::probe(uint64_t key) const {
+	BookEntry first = BookEntry(), last = BookEntry();
+	first.key = last.key = key;
+	last.move = UINT16_MAX;
+	const BookEntry* begin = std::lower_bound(_entries, _entries + _size, first);
+	const BookEntry* end = std::upper_bound(begin, _entries + _size, last);
+	return Range(begin, end);
+}
+
+void Book::save(const std::string& path, const BookEntry* entries,
+		size_t size) {
+	Header header;
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.size = size;
+
+	std::ofstream out(path, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(entries), size * sizeof(BookEntry));
+	if (!out)
+		throw std::runtime_error("cannot write " + path);
+}
+
+} // namespace chess
@@ -0,0 +1,121 @@
+#ifndef AI_BOOK_H
+#define AI_BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace chess {
+
+/*!
+ * The statistics of a single move from a single position, aggregated over
+ * every game of the corpus in which it was played. Results are counted from
+ * the perspective of the side that made the move, and elo is the average
+ * rating of the players that made it (zero if none of them were rated).
+ * Entries are written to disk as is, so their layout must never change
+ * without a new version of the file format.
+ */
+struct BookEntry {
+	uint64_t key;
+	uint32_t count;
+	uint32_t wins;
+	uint32_t draws;
+	uint32_t losses;
+	uint16_t move;
+	uint16_t elo;
+	uint32_t reserved;
+
+	/*!
+	 * Returns the fraction of points the move scored, counting draws as half
+	 * a point.
+	 * @return Score between zero and one.
+	 */
+	inline double score() const {
+		return count ? (wins + 0.5 * draws) / count : 0.5;
+	}
+
+	/* Orders entries by position and then by move. */
+	inline bool operator<(const BookEntry& entry) const {
+		return key < entry.key || (key == entry.key && move < entry.move);
+	}
+};
+
+static_assert(sizeof(BookEntry) == 32, "BookEntry is written to disk");
+
+/*!
+ * This class is an opening book: a file of BookEntry records sorted by the
+ * Zobrist hash of their position (see BookBuilder). The file is mapped into
+ * memory rather than read, so that opening even a book of the whole corpus is
+ * instant and costs no memory until it is probed, and the moves of a position
+ * are found by binary search in O(log n). Probing is thread-safe.
+ */
+class Book {
+public:
+	/*!
+	 * The header at the start of every book file, followed by the entries.
+	 */
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t size;
+	};
+
+	/*! A range of entries, all of the same position. */
+	typedef std::pair<const BookEntry*, const BookEntry*> Range;
+
+private:
+	const BookEntry* _entries;
+	size_t _size;
+	void* _mapping;
+	size_t _length;
+
+	/*! Unmaps the book, if any. */
+	void close();
+
+public:
+	/*!
+	 * Constructs an empty book, which knows no positions.
+	 */
+	Book();
+
+	/*!
+	 * Unmaps the book.
+	 */
+	~Book();
+
+	Book(const Book&) = delete;
+	Book& operator=(const Book&) = delete;
+
+	/*!
+	 * Maps a book file, replacing the book that was open.
+	 * @param[in] path Path of the book.
+	 * @return True if the book was mapped, false if the file is missing or is
+	 * not a valid book, in which case the book is left empty.
+	 */
+	bool open(const std::string& path);
+
+	/*!
+	 * Finds the moves played from the position.
+	 * @param[in] key Zobrist hash of the position.
+	 * @return Entries of the position, ordered by move; empty if the position
+	 * is not in the book.
+	 */
+	Range probe(uint64_t key) const;
+
+	/*! Returns the number of entries. */
+	inline size_t size() const { return _size; }
+
+	/*!
+	 * Writes a book file.
+	 * @param[in] path Path of the book.
+	 * @param[in] entries Entries, sorted by position and move.
+	 * @throws std::runtime_error if the file cannot be written.
+	 */
+	static void save(const std::string& path, const BookEntry* entries,
+		size_t size);
+};
+
+} // namespace chess
+
+#endif // AI_BOOK_H
@@ -0,0 +1,77 @@
+#include "builder.h"
+#include "ai/struct/board.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace chess {
+
+BookBuilder::BookBuilder(const BookOptions& options) : _options(options),
+	_games(0), _positions(0) {}
+
+int BookBuilder::add(const Sample& sample) {
+	if (std::max(sample.white_elo, sample.black_elo) < _options.min_elo)
+		return 0;
+
+	Board board;
+	MoveList legal;
+	int plies = std::min<int>(_options.max_plies, sample.moves.size());
+	int counted = 0;
+	for (; counted < plies; counted++) {
+		PackedMove move = pack(sample.moves[counted]);
+		legal.size = 0;
+		board.legal(legal);
+		if (std::find(legal.begin(), legal.end(), move) == legal.end())
+			break;
+
+		// Results of samples are from white's perspective, entries from the mover's
+		bool white = board.turn() == kWhite;
+		int result = white ? sample.result : -sample.result;
+		int elo = white ? sample.white_elo : sample.black_elo;
+
+		Counters& counters = _counters[Key{board.key(), move}];
+		counters.count++;
+		counters.wins += result > 0;
+		counters.draws += result == 0;
+		counters.losses += result < 0;
+		if (elo > 0) {
+			counters.rated++;
+			counters.elo += elo;
+		}
+		board.make(move);
+	}
+
+	_games++;
+	_positions += counted;
+	return counted;
+}
+
+std::vector<BookEntry> BookBuilder::entries() const {
+	std::vector<BookEntry> entries;
+	for (const auto& pair : _counters) {
+		const Counters& counters = pair.second;
+		if (counters.count < _options.min_count)
+			continue;
+
+		BookEntry entry = BookEntry();
+		entry.key = pair.first.key;
+		entry.move = pair.first.move;
+		entry.count = counters.count;
+		entry.wins = counters.wins;
+		entry.draws = counters.draws;
+		entry.losses = counters.losses;
+		entry.elo = static_cast<uint16_t>(counters.rated ? std::min<uint64_t>(
+			counters.elo / counters.rated, std::numeric_limits<uint16_t>::max()) : 0);
+		entries.push_back(entry);
+	}
+	std::sort(entries.begin(), entries.end());
+	return entries;
+}
+
+size_t BookBuilder::save(const std::string& path) const {
+	std::vector<BookEntry> sorted = entries();
+	Book::save(path, sorted.data(), sorted.size());
+	return sorted.size();
+}
+
+} // namespace chess
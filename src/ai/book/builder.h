@@ -0,0 +1,111 @@
+#ifndef AI_BUILDER_H
+#define AI_BUILDER_H
+
+#include "book.h"
+#include "ai/parse/sample.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * Options that control which games and moves make it into a book.
+ */
+struct BookOptions {
+	int max_plies;
+	uint32_t min_count;
+	int min_elo;
+
+	BookOptions() : max_plies(30), min_count(2), min_elo(0) {}
+};
+
+/*!
+ * This class builds an opening book from a corpus of games, such as the
+ * samples parsed from all-games.pgn. Every game is replayed on a Board and
+ * each of its first moves is counted against the Zobrist hash of the position
+ * it was played from, together with the result of the game and the rating of
+ * the player that made it. Transpositions are therefore merged, however the
+ * position was reached. The counts are kept in a hash table while the corpus
+ * is read and sorted by position once it has been, so that the book can be
+ * searched by bisection.
+ */
+class BookBuilder {
+private:
+	/*! A move from a position, which identifies a single entry. */
+	struct Key {
+		uint64_t key;
+		uint16_t move;
+
+		inline bool operator==(const Key& other) const {
+			return key == other.key && move == other.move;
+		}
+	};
+
+	struct KeyHash {
+		inline size_t operator()(const Key& key) const {
+			return static_cast<size_t>(key.key ^ (key.move * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
+	/*! Counters of an entry while the corpus is read. */
+	struct Counters {
+		uint32_t count;
+		uint32_t wins;
+		uint32_t draws;
+		uint32_t losses;
+		uint32_t rated;
+		uint64_t elo;
+
+		Counters() : count(0), wins(0), draws(0), losses(0), rated(0), elo(0) {}
+	};
+
+	BookOptions _options;
+	std::unordered_map<Key, Counters, KeyHash> _counters;
+	uint64_t _games;
+	uint64_t _positions;
+
+public:
+	/*!
+	 * Constructs an empty builder.
+	 * @param[in] options Book options.
+	 */
+	explicit BookBuilder(const BookOptions& options = BookOptions());
+
+	/*!
+	 * Counts the opening moves of a game. Games where neither player reaches
+	 * the minimum rating are skipped, and replay stops at the first illegal
+	 * move, so that corrupt games cannot poison the book.
+	 * @param[in] sample Game to count.
+	 * @return Number of moves counted.
+	 */
+	int add(const Sample& sample);
+
+	/*!
+	 * Returns the entries played at least the minimum number of times, sorted
+	 * by position and move.
+	 * @return Entries of the book.
+	 */
+	std::vector<BookEntry> entries() const;
+
+	/*!
+	 * Writes the book to a file that Book can open.
+	 * @param[in] path Path of the book.
+	 * @return Number of entries written.
+	 * @throws std::runtime_error if the file cannot be written.
+	 */
+	size_t save(const std::string& path) const;
+
+	/*! Returns the number of games counted. */
+	inline uint64_t games() const { return _games; }
+
+	/*! Returns the number of moves counted, over every game. */
+	inline uint64_t positions() const { return _positions; }
+};
+
+} // namespace chess
+
+#endif // AI_BUILDER_H
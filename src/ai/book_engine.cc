@@ -0,0 +1,59 @@
+#include "book_engine.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace chess {
+
+BookEngine::BookEngine(const Book& book, std::unique_ptr<Engine> fallback,
+		uint32_t seed) : _book(book), _fallback(std::move(fallback)),
+		_prng(seed ? seed : std::random_device()()), _hits(0), _searched(false) {}
+
+Move BookEngine::select(const std::set<Move>& moves) {
+	_searched = true;
+	return _fallback->select(moves);
+}
+
+PackedMove BookEngine::select(Board& board, const MoveList& moves,
+		const Limits& limits) {
+	PackedMove move = choose(_book, board, moves, _prng);
+	if (move) {
+		_hits++;
+		_searched = false;
+		return move;
+	}
+	_searched = true;
+	return _fallback->select(board, moves, limits);
+}
+
+void BookEngine::clear() {
+	_fallback->clear();
+	_searched = false;
+}
+
+int BookEngine::score() const {
+	return _searched ? _fallback->score() : 0;
+}
+
+PackedMove BookEngine::choose(const Book& book, const Board& board,
+		const MoveList& moves, std::mt19937& prng) {
+	Book::Range range = book.probe(board.key());
+	std::vector<PackedMove> candidates;
+	std::vector<double> weights;
+	for (const BookEntry* entry = range.first; entry != range.second; entry++) {
+		double points = entry->wins + 0.5 * entry->draws;
+		const PackedMove* end = moves.moves + moves.size;
+		if (points > 0 && std::find(moves.moves, end, entry->move) != end) {
+			candidates.push_back(entry->move);
+			weights.push_back(points);
+		}
+	}
+
+	if (candidates.empty())
+		return 0;
+	std::discrete_distribution<size_t> dis(weights.begin(), weights.end());
+	return candidates[dis(prng)];
+}
+
+} // namespace chess
@@ -0,0 +1,90 @@
+#ifndef AI_BOOK_ENGINE_H
+#define AI_BOOK_ENGINE_H
+
+#include "engine.h"
+#include "book/book.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+
+namespace chess {
+
+/*!
+ * This engine plays from an opening book for as long as the game stays in it,
+ * and hands over to another engine once it leaves. Book moves are chosen at
+ * random in proportion to the points they scored in the corpus, so that
+ * popular moves that do well are played most often, moves that always lost
+ * are never played, and the engine still varies its openings from game to
+ * game. Book moves take no time to play, which leaves the time saved to the
+ * search once the book runs out.
+ */
+class BookEngine : public Engine {
+private:
+	const Book& _book;
+	std::unique_ptr<Engine> _fallback;
+	std::mt19937 _prng;
+	uint64_t _hits;
+	bool _searched;
+
+public:
+	/*!
+	 * Constructs an engine that consults the book before the fallback engine.
+	 * @param[in] book Opening book, which must outlive the engine.
+	 * @param[in] fallback Engine that plays once the book runs out.
+	 * @param[in] seed Seed of the choice between book moves; zero seeds it
+	 * randomly.
+	 */
+	BookEngine(const Book& book, std::unique_ptr<Engine> fallback,
+		uint32_t seed = 0);
+
+	/*!
+	 * Selects a move with the fallback engine; a set of moves carries no
+	 * position to look up in the book.
+	 * @param[in] moves Candidate moves.
+	 * @return Move selected by the fallback engine.
+	 */
+	Move select(const std::set<Move>& moves) override;
+
+	/*!
+	 * Plays a book move if the position is in the book and searches it with
+	 * the fallback engine otherwise.
+	 * @param[in, out] board Position to search; restored on return.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @param[in] limits Search constraints of the fallback engine.
+	 * @return Selected move, or zero if there were no candidates.
+	 */
+	PackedMove select(Board& board, const MoveList& moves,
+		const Limits& limits) override;
+
+	/*! Clears the fallback engine. */
+	void clear() override;
+
+	/*!
+	 * Returns the score of the last search, or zero if the last move came
+	 * from the book.
+	 * @return Score of the last search.
+	 */
+	int score() const override;
+
+	/*! Returns the number of moves played from the book. */
+	inline uint64_t hits() const { return _hits; }
+
+	/*!
+	 * Chooses one of the candidate moves from the book, at random in
+	 * proportion to the points it scored.
+	 * @param[in] book Opening book.
+	 * @param[in] board Position to look up.
+	 * @param[in] moves Candidate moves; book moves that are not candidates
+	 * are never chosen.
+	 * @param[in, out] prng Pseudo-random number generator.
+	 * @return Chosen move, or zero if no candidate scored in the book.
+	 */
+	static PackedMove choose(const Book& book, const Board& board,
+		const MoveList& moves, std::mt19937& prng);
+};
+
+} // namespace chess
+
+#endif // AI_BOOK_ENGINE_H
@@ -2,6 +2,8 @@
 #define AI_ENGINE_H
 
 #include "core/move.h"
+#include "struct/board.h"
+#include "search/time_manager.h"
 
 #include <set>
 
@@ -14,6 +16,12 @@ namespace chess {
  * of any engine is to select the optimal move given a set of candidates.
  */
 struct Engine {	
+	/*!
+	 * According to Item 7 in Scott Meyers' Effective C++, every polymorphic base
+	 * class should have a virtual destructor.
+	 */
+	virtual ~Engine() {}
+
 	/*!
 	 * The goal of any chess engine is to decide what the best possible move
 	 * given a set of candidate moves and a current board positions. While
@@ -22,8 +30,42 @@ struct Engine {
 	 * @param[in] moves Candidate moves.
 	 * @return Optimal move.
 	 */
-	virtual Move select(std::set<Move> moves) = 0;
+	virtual Move select(const std::set<Move>& moves) = 0;
+
+	/*!
+	 * Selects the best of the candidate moves in the position on the board,
+	 * within the specified search limits. This lets engines be driven without
+	 * a Game, as by the tournament runner. By default the candidates are
+	 * converted to a set and passed to the method above, ignoring the limits;
+	 * searching engines override this to search the board directly.
+	 * @param[in, out] board Position to search; restored on return.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @param[in] limits Search constraints.
+	 * @return Optimal move, or zero if there were no candidates.
+	 */
+	virtual PackedMove select(Board& board, const MoveList& moves,
+			const Limits& limits) {
+		if (!moves.size)
+			return 0;
+		std::set<Move> candidates;
+		for (int i = 0; i < moves.size; i++)
+			candidates.insert(unpack(moves.moves[i]));
+		return pack(select(candidates));
+	}
 
+	/*!
+	 * Forgets anything learned about the previous game. Called before every
+	 * new game; engines without memory need not override this.
+	 */
+	virtual void clear() {}
+
+	/*!
+	 * Returns the score of the last position searched by select(), in
+	 * centipawns from the perspective of the side to move. Engines that do not
+	 * evaluate positions return zero.
+	 * @return Score of the last search.
+	 */
+	virtual int score() const { return 0; }
 };
 
 } // namespace chess
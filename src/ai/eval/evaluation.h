@@ -0,0 +1,82 @@
+#ifndef AI_EVALUATION_H
+#define AI_EVALUATION_H
+
+#include "pawn_table.h"
+#include "ai/struct/board.h"
+
+#include <cstdint>
+
+namespace chess {
+
+/*! Game phase contributed by each piece type, indexed by PieceType. */
+const int kPhaseWeights[] = {0, 0, 1, 1, 2, 4, 0};
+
+/*! Game phase of the initial position; phases are clamped to this value. */
+const int kMaxPhase = 24;
+
+/*! Midgame and endgame material values, indexed by PieceType. */
+extern const int16_t kMidgameValues[7];
+extern const int16_t kEndgameValues[7];
+
+/*!
+ * Midgame and endgame piece-square tables, indexed by PieceType and square
+ * from white's perspective (a8 is 0). Black pieces use the vertically mirrored
+ * square, sq ^ 56.
+ */
+extern const int16_t kMidgameTable[7][64];
+extern const int16_t kEndgameTable[7][64];
+
+/*!
+ * Returns the midgame value of the piece standing on the square, from white's
+ * perspective (black pieces have negative values). The Board sums this value
+ * over its pieces incrementally as pieces are placed and removed.
+ * @param[in] piece Piece code.
+ * @param[in] sq Square.
+ * @return Midgame value in centipawns.
+ */
+inline int midgame(int piece, int sq) {
+	int value = (color(piece) == kWhite) ?
+		kMidgameValues[kind(piece)] + kMidgameTable[kind(piece)][sq] :
+		-kMidgameValues[kind(piece)] - kMidgameTable[kind(piece)][sq ^ 56];
+	return value;
+}
+
+/*!
+ * Returns the endgame value of the piece standing on the square, from white's
+ * perspective (black pieces have negative values).
+ * @param[in] piece Piece code.
+ * @param[in] sq Square.
+ * @return Endgame value in centipawns.
+ */
+inline int endgame(int piece, int sq) {
+	int value = (color(piece) == kWhite) ?
+		kEndgameValues[kind(piece)] + kEndgameTable[kind(piece)][sq] :
+		-kEndgameValues[kind(piece)] - kEndgameTable[kind(piece)][sq ^ 56];
+	return value;
+}
+
+/*!
+ * Statically evaluates the position from the perspective of the side to move.
+ * The midgame and endgame scores maintained by the board are blended by the
+ * remaining non-pawn material (the "tapered" evaluation), so piece placement
+ * preferences shift smoothly as pieces are traded off. Because the board keeps
+ * both sums up to date in make() and undo(), evaluation costs a few operations
+ * regardless of how many pieces are on the board.
+ * @param[in] board Position to evaluate.
+ * @return Static score in centipawns.
+ */
+int evaluate(const Board& board);
+
+/*!
+ * Statically evaluates the position from the perspective of the side to move,
+ * including pawn structure terms. Pawn structure is looked up in (and on a miss
+ * computed into) the specified pawn table.
+ * @param[in] board Position to evaluate.
+ * @param[in, out] pawns Pawn structure cache.
+ * @return Static score in centipawns.
+ */
+int evaluate(const Board& board, PawnTable& pawns);
+
+} // namespace chess
+
+#endif // AI_EVALUATION_H
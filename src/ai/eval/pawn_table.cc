@@ -0,0 +1,121 @@
+#include "pawn_table.h"
+
+namespace chess {
+
+namespace {
+
+const int kDoubledMidgame  = -10;
+const int kDoubledEndgame  = -25;
+const int kIsolatedMidgame = -12;
+const int kIsolatedEndgame = -15;
+
+/*! Passed pawn bonuses, indexed by the number of ranks advanced. */
+const int kPassedMidgame[] = {0, 5, 10, 15, 25, 45, 70, 0};
+const int kPassedEndgame[] = {0, 10, 20, 35, 60, 100, 150, 0};
+
+} // namespace
+
+PawnTable::PawnTable(size_t megabytes) : _hits(0), _misses(0) {
+	size_t size = 1;
+	while (2 * size * sizeof(PawnEntry) <= (megabytes << 20))
+		size *= 2;
+	_entries.assign(size, PawnEntry());
+	_mask = size - 1;
+
+	// The zero key belongs to the position without pawns; make sure the empty
+	// slot for it is not mistaken for a cached entry.
+	_entries[0].key = 1;
+}
+
+void PawnTable::clear() {
+	_entries.assign(_entries.size(), PawnEntry());
+	_entries[0].key = 1;
+	_hits = _misses = 0;
+}
+
+const PawnEntry& PawnTable::probe(const Board& board) {
+	PawnEntry& slot = _entries[board.pawn_key() & _mask];
+	if (slot.key == board.pawn_key()) {
+		_hits++;
+		return slot;
+	}
+
+	_misses++;
+	slot = compute(board);
+	return slot;
+}
+
+PawnEntry PawnTable::compute(const Board& board) {
+	// Rows are x coordinates, so white pawns advance toward row 0. For each
+	// file remember how many pawns of each color stand on it and the most
+	// advanced row reached by each color.
+	int count[2][8] = {{0}};
+	int front[2][8];
+	int back[2][8];
+	for (int y = 0; y < 8; y++) {
+		front[kWhite][y] = back[kBlack][y] = 8;
+		front[kBlack][y] = back[kWhite][y] = -1;
+	}
+
+	for (int sq = 0; sq < 64; sq++) {
+		int piece = board.at(sq);
+		if (kind(piece) != kPawn)
+			continue;
+		int c = color(piece), x = sq / 8, y = sq % 8;
+		count[c][y]++;
+		if (c == kWhite) {
+			if (x < front[kWhite][y]) front[kWhite][y] = x;
+			if (x > back[kWhite][y])  back[kWhite][y] = x;
+		} else {
+			if (x > front[kBlack][y]) front[kBlack][y] = x;
+			if (x < back[kBlack][y])  back[kBlack][y] = x;
+		}
+	}
+
+	int mg = 0, eg = 0;
+	for (int c = kWhite; c <= kBlack; c++) {
+		int sign = (c == kWhite) ? 1 : -1;
+		int them = c ^ 1;
+
+		for (int y = 0; y < 8; y++) {
+			if (!count[c][y])
+				continue;
+
+			// Doubled: every pawn beyond the first on a file
+			mg += sign * kDoubledMidgame * (count[c][y] - 1);
+			eg += sign * kDoubledEndgame * (count[c][y] - 1);
+
+			// Isolated: no friendly pawn on either adjacent file
+			if ((y == 0 || !count[c][y - 1]) && (y == 7 || !count[c][y + 1])) {
+				mg += sign * kIsolatedMidgame * count[c][y];
+				eg += sign * kIsolatedEndgame * count[c][y];
+			}
+
+			// Passed: no enemy pawn in front of the most advanced pawn on this
+			// or an adjacent file. Enemy pawns are "in front" if they stand
+			// further along the direction of travel, i.e. their rearmost pawn
+			// has not yet been passed.
+			int x = front[c][y];
+			bool passed = true;
+			for (int f = y - 1; f <= y + 1 && passed; f++) {
+				if (f < 0 || f > 7 || !count[them][f])
+					continue;
+				if (c == kWhite ? back[them][f] < x : back[them][f] > x)
+					passed = false;
+			}
+			if (passed) {
+				int advanced = (c == kWhite) ? 6 - x : x - 1;
+				mg += sign * kPassedMidgame[advanced];
+				eg += sign * kPassedEndgame[advanced];
+			}
+		}
+	}
+
+	PawnEntry entry;
+	entry.key = board.pawn_key();
+	entry.midgame = static_cast<int16_t>(mg);
+	entry.endgame = static_cast<int16_t>(eg);
+	return entry;
+}
+
+} // namespace chess
@@ -0,0 +1,78 @@
+#ifndef AI_PAWN_TABLE_H
+#define AI_PAWN_TABLE_H
+
+#include "ai/struct/board.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * A single pawn table entry: the pawn structure score of every position that
+ * shares the same arrangement of pawns.
+ */
+struct PawnEntry {
+	uint64_t key;
+	int16_t midgame;
+	int16_t endgame;
+};
+
+/*!
+ * This class caches pawn structure evaluation. Doubled, isolated and passed
+ * pawns depend only on where the pawns stand, and pawns move rarely relative to
+ * other pieces, so almost every position a search visits shares its pawn
+ * structure with a position it has already evaluated. Entries are keyed by the
+ * pawn-only Zobrist hash maintained by the Board. This class is not
+ * thread-safe.
+ */
+class PawnTable {
+private:
+	std::vector<PawnEntry> _entries;
+	uint64_t _mask;
+	uint64_t _hits;
+	uint64_t _misses;
+
+	/*!
+	 * Computes the pawn structure score of the position from scratch.
+	 * @param[in] board Position to evaluate.
+	 * @return Entry with midgame and endgame scores, white relative.
+	 */
+	static PawnEntry compute(const Board& board);
+
+public:
+	/*!
+	 * Constructs a table that uses roughly the specified amount of memory. The
+	 * number of entries is rounded down to a power of two.
+	 * @param[in] megabytes Memory budget.
+	 */
+	explicit PawnTable(size_t megabytes);
+
+	/*!
+	 * Returns the pawn structure score of the position, computing and caching
+	 * it on a miss.
+	 * @param[in] board Position to evaluate.
+	 * @return Cached entry with midgame and endgame scores, white relative.
+	 */
+	const PawnEntry& probe(const Board& board);
+
+	/*!
+	 * Discards every entry and resets the counters.
+	 */
+	void clear();
+
+	/*! Returns the number of probes answered from the cache. */
+	inline uint64_t hits() const { return _hits; }
+
+	/*! Returns the number of probes that had to compute the structure. */
+	inline uint64_t misses() const { return _misses; }
+
+	/*! Returns the fraction of probes answered from the cache. */
+	inline double hit_rate() const {
+		return (_hits + _misses) ? double(_hits) / (_hits + _misses) : 0.0;
+	}
+};
+
+} // namespace chess
+
+#endif // AI_PAWN_TABLE_H
@@ -0,0 +1,62 @@
+#include "markov_engine.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace chess {
+
+const int MarkovEngine::kDefaultElo;
+
+MarkovEngine::MarkovEngine(const MarkovChain& chain, uint32_t seed)
+	: _chain(chain), _prng(seed ? seed : std::random_device()()), _hits(0) {}
+
+Move MarkovEngine::select(const std::set<Move>& moves) {
+	std::uniform_int_distribution<size_t> dis(0, moves.size() - 1);
+	std::set<Move>::const_iterator it(moves.begin());
+	std::advance(it, dis(_prng));
+	return *it;
+}
+
+PackedMove MarkovEngine::select(Board& board, const MoveList& moves,
+		const Limits& limits) {
+	if (!moves.size)
+		return 0;
+
+	// Zobrist hashes may collide, so the move drawn must be a candidate
+	PackedMove move = _chain.next(board.key(), _prng);
+	const PackedMove* end = moves.moves + moves.size;
+	if (move && std::find(moves.moves, end, move) != end) {
+		_hits++;
+		return move;
+	}
+	std::uniform_int_distribution<int> dis(0, moves.size - 1);
+	return moves.moves[dis(_prng)];
+}
+
+int MarkovEngine::train(MarkovChain& chain, const Sample& sample,
+		int max_plies) {
+	Board board;
+	MoveList legal;
+	int plies = std::min<int>(max_plies, sample.moves.size());
+	int trained = 0;
+	for (; trained < plies; trained++) {
+		PackedMove move = pack(sample.moves[trained]);
+		legal.size = 0;
+		board.legal(legal);
+		if (std::find(legal.begin(), legal.end(), move) == legal.end())
+			break;
+
+		bool white = board.turn() == kWhite;
+		int result = white ? sample.result : -sample.result;
+		int elo = white ? sample.white_elo : sample.black_elo;
+		float points = (result > 0) ? 1.0f : (result == 0) ? 0.5f : 0.0f;
+		float strength = static_cast<float>(elo > 0 ? elo : kDefaultElo) /
+			kDefaultElo;
+		if (points > 0)
+			chain.add(board.key(), move, points * strength);
+		board.make(move);
+	}
+	return trained;
+}
+
+} // namespace chess
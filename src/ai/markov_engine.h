@@ -2,6 +2,12 @@
 #define AI_MARKOV_ENGINE_H
 
 #include "engine.h"
+#include "parse/sample.h"
+#include "struct/markov_chain.h"
+
+#include <cstdint>
+#include <random>
+#include <set>
 
 namespace chess {
 
@@ -11,12 +17,62 @@ namespace chess {
  * outcome (1, 0, -1 for win, stalemate, or loss) and the strength of the players
  * who chose to make the move (moves taken by "good" players should be higher
  * weighted than moves taken by relatively worse players).
+ *
+ * Every time a move is played in the corpus it adds the points the mover
+ * scored (one for a win, a half for a draw) to its transition, scaled by the
+ * mover's rating relative to kDefaultElo; unrated players count as
+ * kDefaultElo. Moves that only ever lost are therefore never played. Positions
+ * the chain has never seen are played at random.
  */
 class MarkovEngine : public Engine {
 private:
+	const MarkovChain& _chain;
+	std::mt19937 _prng;
+	uint64_t _hits;
 
 public:
+	/*! Rating assumed for unrated players and that weighs a move by one. */
+	static const int kDefaultElo = 2000;
+
+	/*!
+	 * Constructs an engine that draws its moves from the compiled chain.
+	 * @param[in] chain Markov chain, which must outlive the engine.
+	 * @param[in] seed Seed of the pseudo-random number generator; zero seeds
+	 * it randomly.
+	 */
+	explicit MarkovEngine(const MarkovChain& chain, uint32_t seed = 0);
+
+	/*!
+	 * Selects a move uniformly at random; a set of moves carries no position
+	 * to look up in the chain.
+	 * @param[in] moves Candidate moves.
+	 * @return Randomly selected move.
+	 */
+	Move select(const std::set<Move>& moves) override;
+
+	/*!
+	 * Draws the next move from the chain, or a random candidate if the
+	 * position is unknown.
+	 * @param[in] board Position to move from.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @param[in] limits Search constraints, which are ignored.
+	 * @return Selected move, or zero if there were no candidates.
+	 */
+	PackedMove select(Board& board, const MoveList& moves,
+		const Limits& limits) override;
+
+	/*! Returns the number of moves drawn from the chain. */
+	inline uint64_t hits() const { return _hits; }
 
+	/*!
+	 * Trains the chain on the moves of a game. Replay stops at the first
+	 * illegal move.
+	 * @param[in, out] chain Markov chain.
+	 * @param[in] sample Game to train on.
+	 * @param[in] max_plies Number of plies of the game to train on.
+	 * @return Number of moves the chain was trained on.
+	 */
+	static int train(MarkovChain& chain, const Sample& sample, int max_plies);
 };
 
 } // namespace chess
@@ -0,0 +1,79 @@
+#include "elo.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace chess {
+
+namespace {
+
+/*! Largest Elo difference reported for a perfect score. */
+const double kMaxElo = 1000.0;
+
+/*!
+ * Smallest variance of the result of a single game assumed by the SPRT, so
+ * that a match of a single outcome (every game won, or drawn) still moves
+ * towards a bound: a deviation of a tenth of a point.
+ */
+const double kMinVariance = 0.01;
+
+/*! Standard normal quantile of a 95% two-sided confidence interval. */
+const double kQuantile = 1.959964;
+
+/*! Converts an Elo difference into the expected score. */
+inline double expected(double elo) {
+	return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+/*! Converts an expected score into an Elo difference. */
+inline double difference(double ratio) {
+	if (ratio <= 0.0) return -kMaxElo;
+	if (ratio >= 1.0) return kMaxElo;
+	return std::max(-kMaxElo, std::min(kMaxElo,
+		-400.0 * std::log10(1.0 / ratio - 1.0)));
+}
+
+/*! Returns the variance of the result of a single game. */
+inline double variance(const Score& score) {
+	double n = static_cast<double>(score.games()), p = score.ratio();
+	return (score.wins * (1.0 - p) * (1.0 - p) +
+		score.draws * (0.5 - p) * (0.5 - p) +
+		score.losses * p * p) / n;
+}
+
+} // namespace
+
+double elo(const Score& score) {
+	return difference(score.ratio());
+}
+
+double elo_error(const Score& score) {
+	if (score.games() < 2)
+		return kMaxElo;
+	double deviation = std::sqrt(variance(score) / score.games());
+	double p = score.ratio();
+	return (difference(p + kQuantile * deviation) -
+		difference(p - kQuantile * deviation)) / 2.0;
+}
+
+Sprt::Sprt(double elo0, double elo1, double alpha, double beta)
+	: _score0(expected(elo0)), _score1(expected(elo1)),
+	_lower(std::log(beta / (1.0 - alpha))),
+	_upper(std::log((1.0 - beta) / alpha)) {}
+
+double Sprt::llr(const Score& score) const {
+	if (!score.games())
+		return 0.0;
+	double var = std::max(variance(score), kMinVariance);
+	return score.games() * (_score1 - _score0) *
+		(2.0 * score.ratio() - _score0 - _score1) / (2.0 * var);
+}
+
+int Sprt::decide(const Score& score) const {
+	double ratio = llr(score);
+	if (ratio >= _upper) return 1;
+	if (ratio <= _lower) return -1;
+	return 0;
+}
+
+} // namespace chess
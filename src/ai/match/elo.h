@@ -0,0 +1,104 @@
+#ifndef AI_ELO_H
+#define AI_ELO_H
+
+#include <cstdint>
+
+namespace chess {
+
+/*!
+ * The results of a match, from the perspective of the first engine.
+ */
+struct Score {
+	uint64_t wins;
+	uint64_t draws;
+	uint64_t losses;
+
+	Score() : wins(0), draws(0), losses(0) {}
+
+	/*! Returns the number of games played. */
+	inline uint64_t games() const { return wins + draws + losses; }
+
+	/*! Returns the mean score per game, counting draws as half a win. */
+	inline double ratio() const {
+		return games() ? (wins + 0.5 * draws) / games() : 0.5;
+	}
+
+	/*!
+	 * Adds the result of a single game.
+	 * @param[in] result 1 for a win, 0 for a draw, -1 for a loss.
+	 */
+	inline void add(int result) {
+		if (result > 0) wins++;
+		else if (result < 0) losses++;
+		else draws++;
+	}
+};
+
+/*!
+ * Returns the Elo difference that corresponds to the mean score of the match,
+ * using the logistic model of the Elo rating system. Perfect scores, which
+ * correspond to an infinite difference, are clamped.
+ * @param[in] score Results of the match.
+ * @return Estimated Elo difference.
+ */
+double elo(const Score& score);
+
+/*!
+ * Returns the half-width of the 95% confidence interval of the Elo difference,
+ * estimated from the variance of the individual game results.
+ * @param[in] score Results of the match.
+ * @return Error margin in Elo.
+ */
+double elo_error(const Score& score);
+
+/*!
+ * This class implements the sequential probability ratio test, which stops a
+ * match as soon as the results so far are conclusive. Rather than playing a
+ * fixed number of games, the test accumulates the log-likelihood ratio of two
+ * hypotheses, that the Elo difference is elo0 and that it is elo1, and stops
+ * once the ratio crosses a bound set by the acceptable rates of false
+ * positives (alpha) and false negatives (beta). Game results are approximated
+ * as normally distributed, which is accurate after a few dozen games.
+ */
+class Sprt {
+private:
+	double _score0;
+	double _score1;
+	double _lower;
+	double _upper;
+
+public:
+	/*!
+	 * Constructs a test of elo0 against elo1 with the specified error rates.
+	 * @param[in] elo0 Elo difference under the null hypothesis.
+	 * @param[in] elo1 Elo difference under the alternative hypothesis.
+	 * @param[in] alpha Probability of accepting elo1 when elo0 is true.
+	 * @param[in] beta Probability of accepting elo0 when elo1 is true.
+	 */
+	Sprt(double elo0, double elo1, double alpha, double beta);
+
+	/*!
+	 * Returns the log-likelihood ratio of the alternative hypothesis to the
+	 * null hypothesis.
+	 * @param[in] score Results of the match.
+	 * @return Log-likelihood ratio.
+	 */
+	double llr(const Score& score) const;
+
+	/*!
+	 * Decides whether the match may stop.
+	 * @param[in] score Results of the match.
+	 * @return 1 to accept elo1, -1 to accept elo0, or 0 to continue.
+	 */
+	int decide(const Score& score) const;
+
+	/*! Returns the bound below which the null hypothesis is accepted. */
+	inline double lower() const { return _lower; }
+
+	/*! Returns the bound above which the alternative hypothesis is accepted. */
+	inline double upper() const { return _upper; }
+};
+
+} // namespace chess
+
+#endif // AI_ELO_H
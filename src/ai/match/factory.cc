@@ -0,0 +1,76 @@
+#include "factory.h"
+#include "ai/alpha_beta_engine.h"
+#include "ai/mcts_engine.h"
+#include "ai/random_engine.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace chess {
+
+EngineFactory factory(const std::string& spec) {
+	std::string name = spec.substr(0, spec.find(':'));
+	std::istringstream in(spec.size() > name.size() ?
+		spec.substr(name.size() + 1) : "");
+
+	// Many engines may run at once, so their tables default to a few MB
+	SearchOptions search;
+	search.table_size = 4;
+	MctsOptions mcts;
+	mcts.tree_size = 16;
+	uint32_t seed = 0;
+
+	std::string option;
+	while (std::getline(in, option, ',')) {
+		size_t equals = option.find('=');
+		if (equals == std::string::npos)
+			throw std::invalid_argument("expected key=value in " + option);
+		std::string key = option.substr(0, equals);
+		std::string value = option.substr(equals + 1);
+		long long number = std::atoll(value.c_str());
+
+		if (name == "random" && key == "seed") {
+			seed = static_cast<uint32_t>(number);
+		} else if (name == "alphabeta" && key == "depth") {
+			search.depth = static_cast<int>(number);
+		} else if (name == "alphabeta" && key == "hash") {
+			search.table_size = static_cast<size_t>(number);
+		} else if (name == "alphabeta" && key == "null") {
+			search.null_move = number != 0;
+		} else if (name == "alphabeta" && key == "lmr") {
+			search.late_move_reductions = number != 0;
+		} else if (name == "alphabeta" && key == "rfp") {
+			search.reverse_futility = number != 0;
+		} else if (name == "alphabeta" && key == "futility") {
+			search.futility = number != 0;
+		} else if (name == "mcts" && key == "playouts") {
+			mcts.playouts = static_cast<uint64_t>(number);
+		} else if (name == "mcts" && key == "tree") {
+			mcts.tree_size = static_cast<size_t>(number);
+		} else if (name == "mcts" && key == "puct") {
+			mcts.puct = number != 0;
+		} else if (name == "mcts" && key == "threads") {
+			mcts.threads = static_cast<int>(number);
+		} else if (name == "mcts" && key == "seed") {
+			mcts.seed = static_cast<uint32_t>(number);
+		} else {
+			throw std::invalid_argument("unknown option " + key + " of " + name);
+		}
+	}
+
+	if (name == "random")
+		return [seed]() {
+			return std::unique_ptr<Engine>(
+				seed ? new RandomEngine(seed) : new RandomEngine());
+		};
+	if (name == "alphabeta")
+		return [search]() {
+			return std::unique_ptr<Engine>(new AlphaBetaEngine(search));
+		};
+	if (name == "mcts")
+		return [mcts]() { return std::unique_ptr<Engine>(new MctsEngine(mcts)); };
+	throw std::invalid_argument("unknown engine " + name);
+}
+
+} // namespace chess
@@ -0,0 +1,36 @@
+#ifndef AI_FACTORY_H
+#define AI_FACTORY_H
+
+#include "ai/engine.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace chess {
+
+/*!
+ * Creates a new instance of an engine. Every thread of a tournament or of
+ * self-play uses engines of its own, so engines are passed around as
+ * factories.
+ */
+typedef std::function<std::unique_ptr<Engine>()> EngineFactory;
+
+/*!
+ * Creates a factory for the engine described by a specification of the form
+ * name[:key=value,...], as given on the command line. The engines and their
+ * options are:
+ *  - random[:seed=N]
+ *  - alphabeta[:depth=N,hash=MB,null=0|1,lmr=0|1,rfp=0|1,futility=0|1]
+ *  - mcts[:playouts=N,tree=MB,puct=0|1,threads=N,seed=N]
+ * Engines created with a seed make the same choices every time they are
+ * created; the others are seeded randomly.
+ * @param[in] spec Engine specification, e.g. alphabeta:depth=4,null=0.
+ * @return Engine factory.
+ * @throws std::invalid_argument if the specification is malformed.
+ */
+EngineFactory factory(const std::string& spec);
+
+} // namespace chess
+
+#endif // AI_FACTORY_H
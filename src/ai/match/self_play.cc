@@ -0,0 +1,98 @@
+#include "self_play.h"
+#include "ai/struct/board.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*! Returns the number of milliseconds since the specified time. */
+inline int64_t since(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+SelfPlayOptions::SelfPlayOptions() : games(1000),
+	threads(std::max(1u, std::thread::hardware_concurrency())), seed(1),
+	random_plies(8), max_plies(400), rating(0) {}
+
+SelfPlay::SelfPlay(const EngineFactory& factory, SampleWriter& out,
+		const SelfPlayOptions& options)
+	: _factory(factory), _out(out), _options(options) {}
+
+const SelfPlayStats& SelfPlay::run() {
+	_stats = SelfPlayStats();
+	_start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> pool;
+	for (int i = 0; i < std::max(1, _options.threads); i++)
+		pool.push_back(std::thread(&SelfPlay::work, this, i));
+	for (auto& thread : pool)
+		thread.join();
+
+	_stats.time = since(_start);
+	return _stats;
+}
+
+void SelfPlay::work(int worker) {
+	std::unique_ptr<Engine> engine = _factory();
+	std::seed_seq seeds = {_options.seed, static_cast<uint32_t>(worker)};
+	std::mt19937 prng(seeds);
+
+	// Games are dealt round-robin, so each thread's share is fixed in advance
+	uint64_t stride = std::max(1, _options.threads);
+	for (uint64_t game = worker; game < _options.games; game += stride) {
+		Sample sample = play(*engine, prng, _options);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_out.write(sample);
+		_stats.score.add(sample.result);
+		_stats.plies += sample.moves.size();
+		_stats.time = since(_start);
+		if (_listener)
+			_listener(_stats);
+	}
+}
+
+Sample SelfPlay::play(Engine& engine, std::mt19937& prng,
+		const SelfPlayOptions& options) {
+	Sample sample;
+	sample.result = 0;
+	sample.white_elo = options.rating;
+	sample.black_elo = options.rating;
+	engine.clear();
+
+	Board board;
+	for (int ply = 0; ; ply++) {
+		MoveList moves;
+		board.legal(moves);
+		if (!moves.size) {
+			if (board.in_check())
+				sample.result = (board.turn() == kWhite) ? -1 : 1;
+			break;
+		}
+		if (board.is_draw() || board.is_insufficient() || ply >= options.max_plies)
+			break;
+
+		// Positions in the random opening are searched too, so that every
+		// position in the sample is scored, but the search result is not played
+		PackedMove move = engine.select(board, moves, options.limits);
+		if (ply < options.random_plies) {
+			std::uniform_int_distribution<int> dis(0, moves.size - 1);
+			move = moves.moves[dis(prng)];
+		}
+
+		int score = engine.score();
+		sample.scores.push_back((board.turn() == kWhite) ? score : -score);
+		sample.moves.push_back(unpack(move));
+		board.make(move);
+	}
+	return sample;
+}
+
+} // namespace chess
@@ -0,0 +1,126 @@
+#ifndef AI_SELF_PLAY_H
+#define AI_SELF_PLAY_H
+
+#include "elo.h"
+#include "factory.h"
+#include "ai/engine.h"
+#include "ai/parse/sample.h"
+#include "ai/parse/sample_file.h"
+#include "ai/search/time_manager.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+
+namespace chess {
+
+/*!
+ * Parameters of self-play.
+ */
+struct SelfPlayOptions {
+	uint64_t games;
+	int threads;
+	uint32_t seed;
+	Limits limits;
+	int random_plies;
+	int max_plies;
+	int rating;
+
+	/*!
+	 * Constructs the default options: 1000 games on every core, each opened
+	 * with 8 random plies and searched within the engine's own limits, drawn
+	 * after 400 plies. Samples are written with a nominal rating of zero.
+	 */
+	SelfPlayOptions();
+};
+
+/*!
+ * Counters collected over a run of self-play.
+ */
+struct SelfPlayStats {
+	Score score;
+	uint64_t plies;
+	int64_t time;
+
+	SelfPlayStats() : plies(0), time(0) {}
+};
+
+/*!
+ * This class generates training samples by letting an engine play against
+ * itself. Games are played concurrently by a pool of threads, and every
+ * finished game is written as a Sample in the binary sample format (see
+ * SampleWriter), in the same form as the samples the Parser extracts from
+ * PGN, along with the score the engine gave to every position along the way.
+ *
+ * Each game opens with a few uniformly random plies, so that deterministic
+ * engines do not play the same game over and over. The randomness comes from
+ * a generator owned by each thread and seeded by the seed of the run and the
+ * index of the thread, and every thread plays a fixed share of the games, so
+ * a run with the same seed, thread count and engine produces the same games
+ * (in an order that depends on scheduling), as long as moves are limited by
+ * depth or nodes rather than time.
+ */
+class SelfPlay {
+public:
+	/*!
+	 * Callback invoked, under a lock, after every game with the counters so
+	 * far.
+	 */
+	typedef std::function<void(const SelfPlayStats&)> Listener;
+
+private:
+	EngineFactory _factory;
+	SampleWriter& _out;
+	SelfPlayOptions _options;
+	Listener _listener;
+
+	std::mutex _mutex;
+	SelfPlayStats _stats;
+	std::chrono::steady_clock::time_point _start;
+
+	/*!
+	 * Plays every game assigned to the thread with the specified index.
+	 * @param[in] worker Index of the thread.
+	 */
+	void work(int worker);
+
+public:
+	/*!
+	 * Constructs a run of self-play by engines created by the factory.
+	 * @param[in] factory Creates the engine; each thread creates its own.
+	 * @param[in, out] out Writer the samples are written to.
+	 * @param[in] options Self-play options.
+	 */
+	SelfPlay(const EngineFactory& factory, SampleWriter& out,
+		const SelfPlayOptions& options = SelfPlayOptions());
+
+	/*!
+	 * Plays every game and writes the samples.
+	 * @return Counters of the run.
+	 */
+	const SelfPlayStats& run();
+
+	/*!
+	 * Registers a callback to report progress.
+	 * @param[in] listener Progress callback.
+	 */
+	inline void listen(const Listener& listener) {
+		_listener = listener;
+	}
+
+	/*!
+	 * Plays a single game of the engine against itself.
+	 * @param[in, out] engine Engine playing both sides.
+	 * @param[in, out] prng Generator of the random opening plies.
+	 * @param[in] options Limits, random plies, ply limit and rating.
+	 * @return Sample of the game.
+	 */
+	static Sample play(Engine& engine, std::mt19937& prng,
+		const SelfPlayOptions& options);
+};
+
+} // namespace chess
+
+#endif // AI_SELF_PLAY_H
@@ -0,0 +1,149 @@
+#include "tournament.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace chess {
+
+namespace {
+
+/*!
+ * Openings used when none are specified: short, balanced lines from the most
+ * common openings, so that games between deterministic engines differ.
+ */
+const char* const kOpenings[] = {
+	"e2e4 e7e5 g1f3 b8c6 f1b5",
+	"e2e4 e7e5 g1f3 b8c6 f1c4",
+	"e2e4 c7c5 g1f3 d7d6 d2d4",
+	"e2e4 c7c5 b1c3 b8c6 g2g3",
+	"e2e4 e7e6 d2d4 d7d5 b1c3",
+	"e2e4 c7c6 d2d4 d7d5 e4e5",
+	"d2d4 d7d5 c2c4 e7e6 b1c3",
+	"d2d4 d7d5 c2c4 c7c6 g1f3",
+	"d2d4 g8f6 c2c4 e7e6 b1c3",
+	"d2d4 g8f6 c2c4 g7g6 b1c3",
+	"c2c4 e7e5 b1c3 g8f6 g2g3",
+	"g1f3 d7d5 g2g3 g8f6 f1g2",
+};
+
+} // namespace
+
+MatchOptions::MatchOptions() : games(1000),
+	threads(std::max(1u, std::thread::hardware_concurrency())), time(0),
+	increment(0), max_plies(400),
+	openings(std::begin(kOpenings), std::end(kOpenings)), sprt(false),
+	elo0(0.0), elo1(10.0), alpha(0.05), beta(0.05) {}
+
+Tournament::Tournament(const EngineFactory& first, const EngineFactory& second,
+		const MatchOptions& options)
+	: _first(first), _second(second), _options(options),
+	_sprt(options.elo0, options.elo1, options.alpha, options.beta),
+	_time_losses(0), _decision(0), _next(0), _done(false) {
+	if (_options.openings.empty())
+		_options.openings.push_back("");
+}
+
+const Score& Tournament::run() {
+	std::vector<std::thread> pool;
+	for (int i = 0; i < std::max(1, _options.threads); i++)
+		pool.push_back(std::thread(&Tournament::work, this));
+	for (auto& thread : pool)
+		thread.join();
+	return _score;
+}
+
+void Tournament::work() {
+	std::unique_ptr<Engine> first = _first();
+	std::unique_ptr<Engine> second = _second();
+
+	while (!_done.load()) {
+		uint64_t game = _next.fetch_add(1);
+		if (game >= _options.games)
+			break;
+
+		// Consecutive games play the same opening with colors reversed
+		const std::string& opening =
+			_options.openings[(game / 2) % _options.openings.size()];
+		bool swapped = game % 2, timeout = false;
+		int result = swapped ?
+			-play(*second, *first, opening, _options, timeout) :
+			play(*first, *second, opening, _options, timeout);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_score.add(result);
+		_time_losses += timeout;
+		if (_options.sprt && !_decision)
+			_decision = _sprt.decide(_score);
+		if (_decision)
+			_done.store(true);
+		if (_listener)
+			_listener(_score);
+	}
+}
+
+int Tournament::play(Engine& white, Engine& black, const std::string& opening,
+		const MatchOptions& options, bool& timeout) {
+	Board board = setup(opening);
+	Engine* engines[] = {&white, &black};
+	int64_t clocks[] = {options.time, options.time};
+	white.clear();
+	black.clear();
+	timeout = false;
+
+	for (int ply = 0; ; ply++) {
+		MoveList moves;
+		board.legal(moves);
+		int side = board.turn();
+		int loss = (side == kWhite) ? -1 : 1;
+
+		if (!moves.size)
+			return board.in_check() ? loss : 0;
+		if (board.is_draw() || board.is_insufficient() || ply >= options.max_plies)
+			return 0;
+
+		Limits limits = options.limits;
+		if (options.time) {
+			limits.time = clocks[side];
+			limits.increment = options.increment;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		PackedMove move = engines[side]->select(board, moves, limits);
+		int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start).count();
+
+		if (options.time) {
+			clocks[side] -= elapsed;
+			if (clocks[side] < 0) {
+				timeout = true;
+				return loss;
+			}
+			clocks[side] += options.increment;
+		}
+
+		if (std::find(moves.begin(), moves.end(), move) == moves.end())
+			return loss;
+		board.make(move);
+	}
+}
+
+Board Tournament::setup(const std::string& opening) {
+	if (opening.find('/') != std::string::npos)
+		return Board(opening);
+
+	Board board;
+	std::istringstream in(opening);
+	std::string text;
+	while (in >> text) {
+		PackedMove move = board.parse(text);
+		if (!move)
+			throw std::invalid_argument("illegal opening move " + text);
+		board.make(move);
+	}
+	return board;
+}
+
+} // namespace chess
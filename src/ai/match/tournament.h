@@ -0,0 +1,144 @@
+#ifndef AI_TOURNAMENT_H
+#define AI_TOURNAMENT_H
+
+#include "elo.h"
+#include "factory.h"
+#include "ai/engine.h"
+#include "ai/search/time_manager.h"
+#include "ai/struct/board.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * Parameters of a match between two engines.
+ */
+struct MatchOptions {
+	uint64_t games;
+	int threads;
+	int64_t time;
+	int64_t increment;
+	Limits limits;
+	int max_plies;
+	std::vector<std::string> openings;
+	bool sprt;
+	double elo0;
+	double elo1;
+	double alpha;
+	double beta;
+
+	/*!
+	 * Constructs the default options: up to 1000 games on every core from the
+	 * built-in openings, with each move limited only by the engines' own
+	 * defaults, games adjudicated drawn after 400 plies, and no SPRT.
+	 */
+	MatchOptions();
+};
+
+/*!
+ * This class plays a match between two engines. Games are played concurrently
+ * by a pool of threads, each with its own pair of engines. Every opening is
+ * played twice, with each engine playing white once, so that neither engine
+ * benefits from an unbalanced opening. Games are either played under a clock
+ * (a base time per game plus an increment per move), in which case an engine
+ * that overruns its clock loses, or with fixed limits per move. Games end at
+ * mate, stalemate, the fifty move rule, the first repetition, insufficient
+ * material or the ply limit. An engine that returns an illegal move loses.
+ * The match ends after the specified number of games or, if enabled, as soon
+ * as the sequential probability ratio test is conclusive.
+ */
+class Tournament {
+public:
+	/*!
+	 * Callback invoked, under a lock, after every game with the score so far.
+	 */
+	typedef std::function<void(const Score&)> Listener;
+
+private:
+	EngineFactory _first;
+	EngineFactory _second;
+	MatchOptions _options;
+	Sprt _sprt;
+	Listener _listener;
+
+	std::mutex _mutex;
+	Score _score;
+	uint64_t _time_losses;
+	int _decision;
+	std::atomic<uint64_t> _next;
+	std::atomic<bool> _done;
+
+	/*!
+	 * Plays games until the match is over. Run by every thread of the pool.
+	 */
+	void work();
+
+public:
+	/*!
+	 * Constructs a match between engines created by the two factories.
+	 * @param[in] first Creates the engine whose score is reported.
+	 * @param[in] second Creates its opponent.
+	 * @param[in] options Match options.
+	 */
+	Tournament(const EngineFactory& first, const EngineFactory& second,
+		const MatchOptions& options = MatchOptions());
+
+	/*!
+	 * Plays the match and returns its final score.
+	 * @return Score of the first engine.
+	 */
+	const Score& run();
+
+	/*!
+	 * Registers a callback to report progress.
+	 * @param[in] listener Progress callback.
+	 */
+	inline void listen(const Listener& listener) {
+		_listener = listener;
+	}
+
+	/*!
+	 * Plays a single game.
+	 * @param[in] white Engine playing white.
+	 * @param[in] black Engine playing black.
+	 * @param[in] opening Opening position, as FEN or as moves from the start.
+	 * @param[in] options Time control and ply limit.
+	 * @param[out] timeout Set to true if the game was lost on time.
+	 * @return 1 if white won, -1 if black won, 0 if drawn.
+	 */
+	static int play(Engine& white, Engine& black, const std::string& opening,
+		const MatchOptions& options, bool& timeout);
+
+	/*!
+	 * Returns the position described by an opening: a FEN string, or moves in
+	 * coordinate notation played from the starting position.
+	 * @param[in] opening Opening description.
+	 * @return Opening position.
+	 * @throws std::invalid_argument if the opening is malformed.
+	 */
+	static Board setup(const std::string& opening);
+
+	/*!
+	 * Returns the result of the SPRT: 1 if the first engine was shown to be
+	 * stronger by elo1, -1 if not, and 0 if undecided or disabled.
+	 * @return SPRT decision.
+	 */
+	inline int decision() const { return _decision; }
+
+	/*! Returns the number of games lost on time by either engine. */
+	inline uint64_t time_losses() const { return _time_losses; }
+
+	/*! Returns the sequential probability ratio test of the match. */
+	inline const Sprt& sprt() const { return _sprt; }
+};
+
+} // namespace chess
+
+#endif // AI_TOURNAMENT_H
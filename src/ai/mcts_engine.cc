@@ -0,0 +1,287 @@
+#include "mcts_engine.h"
+#include "eval/evaluation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+namespace chess {
+
+namespace {
+
+/*! Prior weight of a move by the type of piece it captures, under PUCT. */
+const float kCaptureWeights[] = {1.0f, 2.0f, 4.0f, 4.0f, 6.0f, 10.0f, 1.0f};
+
+/*! Additional prior weight of a promotion to a queen, under PUCT. */
+const float kPromotionWeight = 8.0f;
+
+/*!
+ * Converts a centipawn score into the expected result for the side it favors,
+ * using the logistic curve of the Elo rating system.
+ */
+inline double expectation(int score) {
+	return 1.0 / (1.0 + std::pow(10.0, -score / 400.0));
+}
+
+/*!
+ * Converts an expected result back into a centipawn score, the inverse of
+ * expectation(). Certain results are clamped to a finite score.
+ */
+inline int centipawns(double expected) {
+	expected = std::min(0.999, std::max(0.001, expected));
+	return static_cast<int>(std::lround(-400.0 * std::log10(1.0 / expected - 1.0)));
+}
+
+} // namespace
+
+MctsEngine::MctsEngine(const MctsOptions& options)
+	: _game(nullptr), _tree(options.tree_size), _options(options),
+	_prng(options.seed ? options.seed : std::random_device()()), _root(0),
+	_tablebase(nullptr) {}
+
+MctsEngine::MctsEngine(Game& game, const MctsOptions& options)
+	: _game(&game), _tree(options.tree_size), _options(options),
+	_prng(options.seed ? options.seed : std::random_device()()), _root(0),
+	_tablebase(nullptr) {}
+
+Move MctsEngine::select(const std::set<Move>& moves) {
+	Board board(_game->history());
+	MoveList list;
+	for (auto move : moves)
+		list.push(pack(move));
+
+	PackedMove best = select(board, list);
+	for (auto move : moves)
+		if (pack(move) == best)
+			return move;
+	return *moves.begin();
+}
+
+PackedMove MctsEngine::select(Board& board, const MoveList& moves,
+		const Limits& limits) {
+	if (!moves.size)
+		return 0;
+
+	// Limits::nodes counts playouts, which are checked here rather than by the
+	// clock, because the clock counts nodes between polls.
+	Limits timing = limits;
+	timing.nodes = 0;
+	_stats = MctsStats();
+	_clock.start(timing);
+
+	prepare(board, moves);
+	_stats.reused = _tree[0].visits;
+	if (!_tree[0].expanded())
+		expand(0, board, moves);
+
+	uint64_t playouts = limits.nodes ? limits.nodes :
+		limits.open_ended() ? UINT64_MAX : _options.playouts;
+	_started.store(0);
+
+	// Every helper thread searches its own copy of the board; the calling
+	// thread searches the board it was given.
+	std::vector<Worker> workers;
+	for (int i = 0; i < std::max(1, _options.threads); i++)
+		workers.push_back(Worker(_prng()));
+
+	std::vector<std::thread> helpers;
+	for (size_t i = 1; i < workers.size(); i++) {
+		Worker& worker = workers[i];
+		helpers.push_back(std::thread([this, board, &worker, playouts]() mutable {
+			work(board, worker, playouts);
+		}));
+	}
+	work(board, workers[0], playouts);
+	for (auto& helper : helpers)
+		helper.join();
+
+	for (auto& worker : workers) {
+		_stats.playouts += worker.playouts;
+		_stats.plies += worker.plies;
+	}
+	_stats.time = _clock.elapsed();
+
+	// The most visited move is more reliable than the one with the best
+	// average, which may owe its average to a handful of lucky playouts.
+	const TreeNode& root = _tree[0];
+	uint32_t first = root.first.load(std::memory_order_relaxed);
+	uint32_t best = first;
+	for (uint32_t i = first; i < first + root.size; i++)
+		if (_tree[i].visits.load() > _tree[best].visits.load())
+			best = i;
+
+	if (!root.size)
+		return moves.moves[0];
+	uint32_t visits = _tree[best].visits.load();
+	if (visits)
+		_stats.score = centipawns(_tree[best].value.load() / visits);
+	return _tree[best].move;
+}
+
+void MctsEngine::prepare(Board& board, const MoveList& moves) {
+	// Look for the previous root among the last two plies: the position after
+	// our own move (when searching for the opponent, as in self-play) and the
+	// position after the opponent's reply.
+	PackedMove line[2];
+	int plies = 0;
+	while (board.key() != _root && plies < 2 && board.last()) {
+		line[plies++] = board.last();
+		board.undo();
+	}
+
+	bool found = _root && board.key() == _root;
+	for (int i = plies - 1; i >= 0; i--)
+		board.make(line[i]);
+
+	uint32_t node = 0;
+	for (int i = plies - 1; found && i >= 0; i--) {
+		node = _tree[node].expanded() ? _tree.child(node, line[i]) : 0;
+		found = (node != 0);
+	}
+
+	// Candidate moves that differ from the legal moves (as when the search is
+	// restricted to a few moves) invalidate the children of the root.
+	if (found) {
+		_tree.reroot(node);
+		found = !_tree[0].expanded() || _tree[0].size == moves.size;
+	}
+	if (!found)
+		_tree.clear();
+	_root = board.key();
+}
+
+void MctsEngine::work(Board& board, Worker& worker, uint64_t playouts) {
+	while (_clock.deepen() &&
+			_started.fetch_add(1, std::memory_order_relaxed) < playouts) {
+		iterate(board, worker);
+		worker.playouts++;
+	}
+}
+
+void MctsEngine::iterate(Board& board, Worker& worker) {
+	std::vector<uint32_t>& path = worker.path;
+	path.clear();
+	path.push_back(0);
+	_tree[0].visits.fetch_add(1, std::memory_order_relaxed);
+
+	// Selection: descend through expanded nodes to a leaf. Visits are counted
+	// on the way down, which imposes the virtual loss.
+	uint32_t node = 0;
+	bool draw = false;
+	while (!draw && _tree[node].expanded() && _tree[node].size) {
+		node = descend(node);
+		_tree[node].visits.fetch_add(1, std::memory_order_relaxed);
+		board.make(_tree[node].move);
+		path.push_back(node);
+		draw = board.is_draw();
+	}
+
+	// Expansion and simulation. Once the arena is full, or while another
+	// thread is expanding the leaf, it is played out without being expanded.
+	// Endgames in the tablebase need no playout.
+	double result = 0.5;
+	int wdl, dtm;
+	if (!draw) {
+		if (!_tree[node].expanded()) {
+			MoveList moves;
+			board.legal(moves);
+			expand(node, board, moves);
+		}
+
+		if (_tree[node].expanded() && !_tree[node].size)
+			result = board.in_check() ? 0.0 : 0.5;
+		else if (_tablebase && _tablebase->probe(board, wdl, dtm))
+			result = 0.5 + 0.5 * wdl;
+		else
+			result = playout(board, worker);
+	}
+
+	// Backpropagation: each node is scored from the perspective of the side
+	// that moved into it, which alternates along the path. Adding the result
+	// lifts the virtual loss.
+	for (size_t i = path.size(); i-- > 0;) {
+		result = 1.0 - result;
+		_tree[path[i]].add(static_cast<float>(result));
+	}
+
+	for (size_t i = 1; i < path.size(); i++)
+		board.undo();
+}
+
+uint32_t MctsEngine::descend(uint32_t node) const {
+	const TreeNode& parent = _tree[node];
+	uint32_t first = parent.first.load(std::memory_order_relaxed);
+	uint32_t total = parent.visits.load(std::memory_order_relaxed);
+	double log_visits = std::log(static_cast<double>(total + 1));
+	double sqrt_visits = std::sqrt(static_cast<double>(total + 1));
+
+	uint32_t best = first;
+	double best_score = -1.0;
+	for (uint32_t i = first; i < first + parent.size; i++) {
+		const TreeNode& child = _tree[i];
+		uint32_t visits = child.visits.load(std::memory_order_relaxed);
+		float value = child.value.load(std::memory_order_relaxed);
+		double score;
+		if (_options.puct) {
+			double mean = visits ? value / visits : 0.5;
+			score = mean + _options.exploration * child.prior * sqrt_visits /
+				(1 + visits);
+		} else {
+			// UCT tries every move once before exploiting any of them
+			if (!visits)
+				return i;
+			score = value / visits +
+				_options.exploration * std::sqrt(log_visits / visits);
+		}
+
+		if (score > best_score) {
+			best_score = score;
+			best = i;
+		}
+	}
+	return best;
+}
+
+void MctsEngine::expand(uint32_t node, const Board& board,
+		const MoveList& moves) {
+	if (!_options.puct) {
+		_tree.expand(node, moves, nullptr);
+		return;
+	}
+
+	float priors[256];
+	float total = 0.0f;
+	for (int i = 0; i < moves.size; i++) {
+		PackedMove move = moves.moves[i];
+		priors[i] = kCaptureWeights[kind(board.at(to(move)))];
+		if (type(move) == MoveType::kPromoteQueen)
+			priors[i] += kPromotionWeight;
+		total += priors[i];
+	}
+	for (int i = 0; i < moves.size; i++)
+		priors[i] /= total;
+	_tree.expand(node, moves, priors);
+}
+
+double MctsEngine::playout(Board& board, Worker& worker) {
+	int side = board.turn();
+	int outcome = worker.playout.play(board, _options.playout_depth);
+
+	double result;
+	if (outcome == Playout::kUnfinished) {
+		result = expectation(evaluate(board));
+		if (board.turn() != side)
+			result = 1.0 - result;
+	} else if (outcome == 0) {
+		result = 0.5;
+	} else {
+		result = ((outcome > 0) == (side == kWhite)) ? 1.0 : 0.0;
+	}
+
+	worker.plies += worker.playout.plies();
+	worker.playout.rewind(board);
+	return result;
+}
+
+} // namespace chess
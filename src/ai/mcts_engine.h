@@ -0,0 +1,259 @@
+#ifndef AI_MCTS_ENGINE_H
+#define AI_MCTS_ENGINE_H
+
+#include "engine.h"
+#include "core/game.h"
+#include "core/move.h"
+#include "struct/board.h"
+#include "struct/search_tree.h"
+#include "search/playout.h"
+#include "search/time_manager.h"
+#include "tablebase/tablebase.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * Parameters of the Monte Carlo tree search.
+ */
+struct MctsOptions {
+	uint64_t playouts;
+	size_t tree_size;
+	double exploration;
+	bool puct;
+	int playout_depth;
+	int threads;
+	uint32_t seed;
+
+	/*!
+	 * Constructs the default options: 10000 playouts per move in a 64 MB tree
+	 * on a single thread, selected by UCT, with playouts cut off and scored by
+	 * the static evaluation after 40 plies. A seed of zero seeds the engine
+	 * randomly.
+	 */
+	MctsOptions() : playouts(10000), tree_size(64), exploration(1.4),
+		puct(false), playout_depth(40), threads(1), seed(0) {}
+};
+
+/*!
+ * Counters collected over a single call to select().
+ */
+struct MctsStats {
+	uint64_t playouts;
+	uint64_t plies;
+	uint64_t reused;
+	int64_t time;
+	int score;
+
+	MctsStats() : playouts(0), plies(0), reused(0), time(0), score(0) {}
+};
+
+/*!
+ * This engine selects moves by Monte Carlo tree search. Rather than proving
+ * the value of a position, it grows a tree of moves from the current position
+ * one playout at a time: it descends the tree choosing moves that have either
+ * scored well or been tried rarely, adds the children of the position it
+ * arrives at and finishes the game with random moves. Every position along the
+ * way is scored by the outcome, so the tree comes to favor the moves that lead
+ * to favorable outcomes, as proposed in deep-orange.md.
+ *
+ * Children are chosen either by UCT, which adds an exploration bonus that
+ * shrinks with the number of visits, or by PUCT, which weighs that bonus by a
+ * prior probability of each move. The tree lives in an arena (see SearchTree),
+ * and the subtree of the position that arises after the engine's move and the
+ * opponent's reply is kept for the next search.
+ *
+ * Several threads may grow the same tree at once. Each thread counts its visit
+ * to a node as soon as it descends into it, but only adds the result once its
+ * playout completes. Until then the visit counts as a loss (a "virtual loss"),
+ * which steers the other threads towards different lines.
+ */
+class MctsEngine : public Engine {
+private:
+	Game* _game;
+	SearchTree _tree;
+	MctsOptions _options;
+	MctsStats _stats;
+	TimeManager _clock;
+	std::mt19937 _prng;
+	uint64_t _root;
+	std::atomic<uint64_t> _started;
+	const Tablebase* _tablebase;
+
+	/*!
+	 * The state each searching thread keeps to itself.
+	 */
+	struct Worker {
+		Playout playout;
+		std::vector<uint32_t> path;
+		uint64_t playouts;
+		uint64_t plies;
+
+		explicit Worker(uint32_t seed) : playout(seed), playouts(0), plies(0) {}
+	};
+
+	/*!
+	 * Prepares the tree for a search of the position on the board. The tree
+	 * of the previous search is kept if the position is the same, or one or
+	 * two plies further along a line the tree already contains; otherwise
+	 * the tree is discarded.
+	 * @param[in, out] board Position to search; restored on return.
+	 * @param[in] moves Candidate moves.
+	 */
+	void prepare(Board& board, const MoveList& moves);
+
+	/*!
+	 * Runs playouts until the search is stopped or the playouts are used up.
+	 * @param[in, out] board Root position, owned by this thread.
+	 * @param[in, out] worker State of this thread.
+	 * @param[in] playouts Number of playouts shared by every thread.
+	 */
+	void work(Board& board, Worker& worker, uint64_t playouts);
+
+	/*!
+	 * Runs one playout: descends the tree from the root, expands the node it
+	 * arrives at, plays the game out and propagates the result back to the
+	 * root.
+	 * @param[in, out] board Root position; restored on return.
+	 * @param[in, out] worker State of this thread.
+	 */
+	void iterate(Board& board, Worker& worker);
+
+	/*!
+	 * Chooses the child of the node to descend into.
+	 * @param[in] node Offset of an expanded node with children.
+	 * @return Offset of the chosen child.
+	 */
+	uint32_t descend(uint32_t node) const;
+
+	/*!
+	 * Creates the children of the node for the specified moves. Under PUCT,
+	 * captures and promotions receive larger priors than quiet moves.
+	 * @param[in] node Offset of the node.
+	 * @param[in] board Position the node stands for.
+	 * @param[in] moves Legal moves in the position.
+	 */
+	void expand(uint32_t node, const Board& board, const MoveList& moves);
+
+	/*!
+	 * Plays random moves until the game ends or the playout depth is reached,
+	 * in which case the position is scored by the static evaluation.
+	 * @param[in, out] board Position to play out; restored on return.
+	 * @param[in, out] worker State of this thread.
+	 * @return Expected result for the side to move: 1 for a win, 0 for a loss.
+	 */
+	double playout(Board& board, Worker& worker);
+
+public:
+	/*!
+	 * Constructs an engine that is not attached to a game. Such an engine may
+	 * only search boards passed to it explicitly.
+	 * @param[in] options Search options.
+	 */
+	explicit MctsEngine(const MctsOptions& options = MctsOptions());
+
+	/*!
+	 * Constructs an engine that plays the specified game.
+	 * @param[in] game Game to play.
+	 * @param[in] options Search options.
+	 */
+	MctsEngine(Game& game, const MctsOptions& options = MctsOptions());
+
+	/*!
+	 * Searches the current position of the game and selects the best of the
+	 * candidate moves. The engine must have been constructed with a game.
+	 * @param[in] moves Candidate moves.
+	 * @return Optimal move.
+	 */
+	Move select(const std::set<Move>& moves) override;
+
+	/*!
+	 * Searches the position on the board and selects the best of the candidate
+	 * moves. The board is restored to its original position on return.
+	 * @param[in, out] board Position to search.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @return Optimal move, or zero if there were no candidates.
+	 */
+	inline PackedMove select(Board& board, const MoveList& moves) {
+		return select(board, moves, Limits());
+	}
+
+	/*!
+	 * Searches the position on the board within the specified limits and
+	 * selects the most visited of the candidate moves. Limits::nodes bounds
+	 * the number of playouts; without any limit, the number of playouts in
+	 * the search options is run.
+	 * @param[in, out] board Position to search.
+	 * @param[in] moves Candidate moves, which must be legal.
+	 * @param[in] limits Search constraints.
+	 * @return Optimal move, or zero if there were no candidates.
+	 */
+	PackedMove select(Board& board, const MoveList& moves,
+		const Limits& limits) override;
+
+	/*!
+	 * Stops the current search as soon as possible. Thread-safe; see
+	 * TimeManager::stop().
+	 */
+	inline void stop() {
+		_clock.stop();
+	}
+
+	/*!
+	 * Withdraws a pending stop request. Thread-safe; see TimeManager::reset().
+	 */
+	inline void reset() {
+		_clock.reset();
+	}
+
+	/*!
+	 * Lets the search score endgames in the tablebase exactly instead of
+	 * playing them out. The tablebase must outlive the engine.
+	 * @param[in] tablebase Tablebase, or nullptr to play out every position.
+	 */
+	inline void tablebase(const Tablebase* tablebase) {
+		_tablebase = tablebase;
+	}
+
+	/*!
+	 * Discards the search tree.
+	 */
+	inline void clear() override {
+		_tree.clear();
+		_root = 0;
+	}
+
+	/*!
+	 * Returns the mean result of the most visited move of the last search,
+	 * converted to centipawns by the logistic curve of the Elo rating system.
+	 * @return Score in centipawns, from the perspective of the side to move.
+	 */
+	inline int score() const override {
+		return _stats.score;
+	}
+
+	/*!
+	 * Returns the counters collected by the last call to select().
+	 * @return Search statistics.
+	 */
+	inline const MctsStats& stats() const {
+		return _stats;
+	}
+
+	/*!
+	 * Returns the search tree, whose root is the position of the last search.
+	 * @return Search tree.
+	 */
+	inline const SearchTree& tree() const {
+		return _tree;
+	}
+};
+
+} // namespace chess
+
+#endif // AI_MCTS_ENGINE_H
@@ -1,7 +1,9 @@
 #ifndef AI_BLOCKING_QUEUE_H
 #define AI_BLOCKING_QUEUE_H
 
+#include <cstddef>
 #include <deque>
+#include <utility>
 #include <mutex>
 #include <condition_variable>
 
@@ -12,23 +14,37 @@ namespace chess {
  * consumer problem by only forcing consumers to wait until the queue is
  * non-empty before attempting to retrieve elements from it. It also includes
  * a mutex lock to prevent multiple threads from accessing the queue at the
- * same time. This class is thread-safe.
+ * same time. A queue may also be bounded, in which case producers wait until
+ * the queue is no longer full, so that a fast producer cannot buffer an
+ * entire input in memory ahead of its consumers. This class is thread-safe.
  */
 template <typename T>
 class BlockingQueue {
 private:
 	std::deque<T> _queue;
-	std::mutex _mutex;
+	size_t _capacity;
+	mutable std::mutex _mutex;
 	std::condition_variable _not_empty;
+	std::condition_variable _not_full;
 
 public:
+	/*!
+	 * Constructs an empty queue.
+	 * @param[in] capacity Largest number of elements, or zero if unbounded.
+	 */
+	explicit BlockingQueue(size_t capacity = 0) : _capacity(capacity) {}
+
 	/*!
 	 * Pushes an element onto the front of the queue and notifies any waiting
-	 * threads that there are elements in queue.
+	 * threads that there are elements in queue. Blocks while a bounded queue
+	 * is full.
 	 * @param[in] obj Object to push
 	 */
 	inline void push(const T& obj) {
 		std::unique_lock<std::mutex> lock(_mutex);
+		_not_full.wait(lock, [this] {
+			return !_capacity || _queue.size() < _capacity;
+		});
 		_queue.push_front(obj);
 		_not_empty.notify_one();
 	}
@@ -41,8 +57,9 @@ public:
 	inline T pop() {
 		std::unique_lock<std::mutex> lock(_mutex);
 		_not_empty.wait(lock, [this] { return !_queue.empty(); });
-		T val = _queue.back();
+		T val = std::move(_queue.back());
 		_queue.pop_back();
+		_not_full.notify_one();
 		return val;
 	}
 
@@ -0,0 +1,97 @@
+#include "bzip2_stream.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace chess {
+
+Bzip2Buffer::Bzip2Buffer(std::istream& source, size_t size) : _source(source),
+		_in(size), _out(size), _open(false), _done(false) {
+	std::memset(&_stream, 0, sizeof(_stream));
+	setg(_out.data(), _out.data(), _out.data());
+}
+
+Bzip2Buffer::~Bzip2Buffer() {
+	end();
+}
+
+void Bzip2Buffer::begin() {
+	int status = BZ2_bzDecompressInit(&_stream, 0, 0);
+	if (status != BZ_OK)
+		throw std::runtime_error("bzip2 init failed: " + std::to_string(status));
+	_open = true;
+}
+
+void Bzip2Buffer::end() {
+	if (_open)
+		BZ2_bzDecompressEnd(&_stream);
+	_open = false;
+}
+
+Bzip2Buffer::int_type Bzip2Buffer::underflow() {
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+
+	while (!_done) {
+		if (!_stream.avail_in && _source) {
+			_source.read(_in.data(), _in.size());
+			_stream.next_in = _in.data();
+			_stream.avail_in = static_cast<unsigned int>(_source.gcount());
+		}
+
+		// Input after the end of a stream begins the next one
+		if (!_open) {
+			if (!_stream.avail_in) {
+				_done = true;
+				break;
+			}
+			char* next = _stream.next_in;
+			unsigned int avail = _stream.avail_in;
+			begin();
+			_stream.next_in = next;
+			_stream.avail_in = avail;
+		}
+
+		_stream.next_out = _out.data();
+		_stream.avail_out = static_cast<unsigned int>(_out.size());
+		int status = BZ2_bzDecompress(&_stream);
+		if (status != BZ_OK && status != BZ_STREAM_END)
+			throw std::runtime_error("corrupt bzip2 data: " + std::to_string(status));
+
+		size_t produced = _out.size() - _stream.avail_out;
+		if (status == BZ_STREAM_END) {
+			char* next = _stream.next_in;
+			unsigned int avail = _stream.avail_in;
+			end();
+			_stream.next_in = next;
+			_stream.avail_in = avail;
+		} else if (!produced && !_stream.avail_in && !_source) {
+			throw std::runtime_error("truncated bzip2 data");
+		}
+
+		if (produced) {
+			setg(_out.data(), _out.data(), _out.data() + produced);
+			return traits_type::to_int_type(*gptr());
+		}
+	}
+	return traits_type::eof();
+}
+
+bool Bzip2Buffer::compressed(std::istream& in) {
+	// Files are rewound; pipes only need to put back what was read
+	std::istream::pos_type start = in.tellg();
+	char magic[3];
+	in.read(magic, sizeof(magic));
+	std::streamsize count = in.gcount();
+	in.clear();
+	if (start != std::istream::pos_type(-1)) {
+		in.seekg(start);
+	} else {
+		for (std::streamsize i = count - 1; i >= 0; i--)
+			in.putback(magic[i]);
+	}
+	return count == 3 && std::memcmp(magic, "BZh", 3) == 0;
+}
+
+} // namespace chess
@@ -0,0 +1,88 @@
+#ifndef AI_BZIP2_STREAM_H
+#define AI_BZIP2_STREAM_H
+
+#include <bzlib.h>
+
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * This class is a stream buffer that decompresses bzip2 data as it is read
+ * from another stream, so that a compressed corpus such as all-games.pgn.bz2
+ * can be parsed without ever writing the decompressed text to disk. Only one
+ * buffer of compressed and one of decompressed data are held at a time.
+ * Concatenated bzip2 streams, as written by parallel compressors, are read
+ * one after the other. Corrupt input throws std::runtime_error from the read
+ * that finds it, which an istream reports by setting its badbit.
+ */
+class Bzip2Buffer : public std::streambuf {
+private:
+	std::istream& _source;
+	std::vector<char> _in;
+	std::vector<char> _out;
+	bz_stream _stream;
+	bool _open;
+	bool _done;
+
+	/*! Starts decompressing a new bzip2 stream. */
+	void begin();
+
+	/*! Stops decompressing the current bzip2 stream, if any. */
+	void end();
+
+protected:
+	/*!
+	 * Decompresses the next buffer of data.
+	 * @return Next character, or EOF once the source is exhausted.
+	 */
+	int_type underflow() override;
+
+public:
+	/*!
+	 * Constructs a buffer that decompresses the source.
+	 * @param[in] source Stream of bzip2 data, which must outlive the buffer.
+	 * @param[in] size Size of the compressed and decompressed buffers.
+	 */
+	explicit Bzip2Buffer(std::istream& source, size_t size = 1 << 20);
+
+	/*!
+	 * Releases the decompressor.
+	 */
+	~Bzip2Buffer();
+
+	Bzip2Buffer(const Bzip2Buffer&) = delete;
+	Bzip2Buffer& operator=(const Bzip2Buffer&) = delete;
+
+	/*!
+	 * Returns true if the stream starts with the bzip2 signature, without
+	 * consuming any of it.
+	 * @param[in] in Stream to test.
+	 * @return True if the stream is compressed with bzip2.
+	 */
+	static bool compressed(std::istream& in);
+};
+
+/*!
+ * An input stream that decompresses bzip2 data read from another stream.
+ */
+class Bzip2Stream : public std::istream {
+private:
+	Bzip2Buffer _buffer;
+
+public:
+	/*!
+	 * Constructs a stream that decompresses the source.
+	 * @param[in] source Stream of bzip2 data, which must outlive this stream.
+	 */
+	explicit Bzip2Stream(std::istream& source)
+		: std::istream(nullptr), _buffer(source) {
+		rdbuf(&_buffer);
+	}
+};
+
+} // namespace chess
+
+#endif // AI_BZIP2_STREAM_H
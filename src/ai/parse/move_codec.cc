@@ -0,0 +1,346 @@
+#include "move_codec.h"
+
+#include "ai/eval/evaluation.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace chess {
+
+namespace {
+
+/*! Precision of the probabilities of the range coder. */
+const int kProbabilityBits = 11;
+
+/*! Rate at which the probabilities adapt; higher is slower. */
+const int kAdaptation = 5;
+
+/*! The range is renormalized whenever it falls below this value. */
+const uint32_t kTop = 1u << 24;
+
+/*! Ranks are below 256, so they fall in one of eight buckets of powers of 2. */
+const int kBuckets = 8;
+
+/*!
+ * The adaptive probabilities that the next bit is zero. The rank r of a move
+ * is coded as the bucket k of r + 1, the position of its highest bit, in
+ * unary, followed by the k bits of r + 1 below the highest bit, each coded in
+ * a binary tree of its bucket.
+ */
+struct Model {
+	uint16_t unary[kBuckets];
+	uint16_t tree[kBuckets][256];
+
+	Model() {
+		std::fill(unary, unary + kBuckets, 1 << (kProbabilityBits - 1));
+		std::fill(&tree[0][0], &tree[0][0] + kBuckets * 256,
+			1 << (kProbabilityBits - 1));
+	}
+};
+
+/*!
+ * A binary range coder in the style of LZMA: carries are propagated through
+ * a cached byte and a count of pending 0xFF bytes.
+ */
+class RangeEncoder {
+private:
+	std::string& _out;
+	uint64_t _low;
+	uint32_t _range;
+	uint8_t _cache;
+	uint64_t _pending;
+
+	void shift() {
+		if (static_cast<uint32_t>(_low) < 0xFF000000u || (_low >> 32)) {
+			uint8_t carry = static_cast<uint8_t>(_low >> 32);
+			uint8_t byte = _cache;
+			do {
+				_out += static_cast<char>(byte + carry);
+				byte = 0xFF;
+			} while (--_pending);
+			_cache = static_cast<uint8_t>(_low >> 24);
+		}
+		_pending++;
+		_low = (_low & 0x00FFFFFF) << 8;
+	}
+
+public:
+	explicit RangeEncoder(std::string& out) : _out(out), _low(0),
+		_range(0xFFFFFFFF), _cache(0), _pending(1) {}
+
+	inline void encode(uint16_t& probability, int bit) {
+		uint32_t bound = (_range >> kProbabilityBits) * probability;
+		if (!bit) {
+			_range = bound;
+			probability += ((1 << kProbabilityBits) - probability) >> kAdaptation;
+		} else {
+			_low += bound;
+			_range -= bound;
+			probability -= probability >> kAdaptation;
+		}
+		while (_range < kTop) {
+			_range <<= 8;
+			shift();
+		}
+	}
+
+	/*!
+	 * Writes the final value of the coder. The value is the one within the
+	 * range with the most trailing zero bytes, and trailing zero bytes are
+	 * dropped, since the decoder reads zeros past the end of the data. The
+	 * first byte is always zero, so it is dropped too.
+	 */
+	void flush(size_t start) {
+		for (int bits = 32; bits >= 8; bits -= 8) {
+			uint64_t mask = (1ull << bits) - 1;
+			uint64_t value = (_low + mask) & ~mask;
+			if (value < _low + _range) {
+				_low = value;
+				break;
+			}
+		}
+		for (int i = 0; i < 5; i++)
+			shift();
+		size_t end = _out.size();
+		while (end > start + 1 && !_out[end - 1])
+			end--;
+		_out.resize(end);
+		_out.erase(start, 1);
+	}
+};
+
+class RangeDecoder {
+private:
+	const uint8_t* _data;
+	size_t _size;
+	size_t _position;
+	uint32_t _range;
+	uint32_t _code;
+
+	/*! Reads the next byte; the coder may read a little past the end. */
+	inline uint32_t next() {
+		return (_position < _size) ? _data[_position++] : (_position++, 0);
+	}
+
+public:
+	RangeDecoder(const char* data, size_t size)
+			: _data(reinterpret_cast<const uint8_t*>(data)), _size(size),
+			_position(0), _range(0xFFFFFFFF), _code(0) {
+		// The first byte of the encoder, always zero, is not stored
+		for (int i = 0; i < 4; i++)
+			_code = (_code << 8) | next();
+	}
+
+	inline int decode(uint16_t& probability) {
+		uint32_t bound = (_range >> kProbabilityBits) * probability;
+		int bit;
+		if (_code < bound) {
+			_range = bound;
+			probability += ((1 << kProbabilityBits) - probability) >> kAdaptation;
+			bit = 0;
+		} else {
+			_code -= bound;
+			_range -= bound;
+			probability -= probability >> kAdaptation;
+			bit = 1;
+		}
+		while (_range < kTop) {
+			_range <<= 8;
+			_code = (_code << 8) | next();
+		}
+		return bit;
+	}
+};
+
+/*! Returns the position of the highest bit of a positive value. */
+inline int bucket(uint32_t value) {
+	int k = 0;
+	while (value >>= 1)
+		k++;
+	return k;
+}
+
+/*! Returns the number of bits needed to write any rank below the count. */
+inline int width(int count) {
+	return (count > 1) ? bucket(count - 1) + 1 : 0;
+}
+
+void encode_rank(RangeEncoder& encoder, Model& model, int rank, int count) {
+	uint32_t value = rank + 1;
+	int k = bucket(value), last = bucket(count);
+	for (int i = 0; i < k; i++)
+		encoder.encode(model.unary[i], 1);
+	if (k < last)
+		encoder.encode(model.unary[k], 0);
+	for (int i = k - 1, node = 1; i >= 0; i--) {
+		int bit = (value >> i) & 1;
+		encoder.encode(model.tree[k][node], bit);
+		node = node * 2 + bit;
+	}
+}
+
+int decode_rank(RangeDecoder& decoder, Model& model, int count) {
+	int k = 0, last = bucket(count);
+	while (k < last && decoder.decode(model.unary[k]))
+		k++;
+	uint32_t value = 1;
+	for (int i = 0, node = 1; i < k; i++) {
+		int bit = decoder.decode(model.tree[k][node]);
+		node = node * 2 + bit;
+		value = value * 2 + bit;
+	}
+	return static_cast<int>(value) - 1;
+}
+
+void put_varint(std::string& out, uint64_t value) {
+	while (value >= 0x80) {
+		out += static_cast<char>((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+uint64_t get_varint(const char* data, size_t size, size_t& position) {
+	uint64_t value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (position >= size)
+			throw std::runtime_error("truncated move data");
+		uint8_t byte = static_cast<uint8_t>(data[position++]);
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return value;
+	}
+	throw std::runtime_error("corrupt move data");
+}
+
+/*! Returns the index of the move among the ranked moves, or -1. */
+inline int find(MoveList& list, PackedMove move) {
+	for (int i = 0; i < list.size; i++)
+		if (list[i] == move)
+			return i;
+	return -1;
+}
+
+} // namespace
+
+MoveCodec::MoveCodec(Coding coding) : _coding(coding) {}
+
+void MoveCodec::rank(Board& board, MoveList& list) {
+	static const int kPromotions[] = {0, 0, 0, 0, kQueen, kKnight, kBishop,
+		kRook};
+	std::pair<int, PackedMove> ranked[256];
+	MoveList legal;
+	board.legal(legal);
+
+	// The gain of a move is the change in the midgame value of the position,
+	// from the perspective of the side to move
+	int side = (board.turn() == kWhite) ? 1 : -1;
+	for (int i = 0; i < legal.size; i++) {
+		PackedMove move = legal[i];
+		int piece = board.at(from(move));
+		int promotion = kPromotions[static_cast<int>(type(move))];
+		int moved = promotion ? (piece & 8) | promotion : piece;
+		int gain = midgame(moved, to(move)) - midgame(piece, from(move));
+		if (board.at(to(move)))
+			gain -= midgame(board.at(to(move)), to(move));
+		ranked[i] = std::make_pair(-side * gain, move);
+	}
+	std::sort(ranked, ranked + legal.size);
+
+	list.size = 0;
+	for (int i = 0; i < legal.size; i++)
+		list.push(ranked[i].second);
+}
+
+void MoveCodec::encode(const std::vector<Move>& moves, std::string& out) const {
+	put_varint(out, moves.size());
+	Board board;
+	MoveList list;
+	if (_coding == kFixed) {
+		uint32_t bits = 0;
+		int count = 0;
+		for (const auto& move : moves) {
+			rank(board, list);
+			int index = find(list, pack(move));
+			if (index < 0)
+				throw std::invalid_argument("illegal move " +
+					notation(pack(move)));
+			for (int i = width(list.size) - 1; i >= 0; i--) {
+				bits = (bits << 1) | ((index >> i) & 1);
+				if (++count == 8) {
+					out += static_cast<char>(bits);
+					bits = count = 0;
+				}
+			}
+			board.make(list[index]);
+		}
+		if (count)
+			out += static_cast<char>(bits << (8 - count));
+		return;
+	}
+
+	// The length of the range coded moves lets games follow one another
+	std::string coded;
+	RangeEncoder encoder(coded);
+	Model model;
+	for (const auto& move : moves) {
+		rank(board, list);
+		int index = find(list, pack(move));
+		if (index < 0)
+			throw std::invalid_argument("illegal move " + notation(pack(move)));
+		encode_rank(encoder, model, index, list.size);
+		board.make(list[index]);
+	}
+	encoder.flush(0);
+	put_varint(out, coded.size());
+	out += coded;
+}
+
+size_t MoveCodec::decode(const char* data, size_t size,
+		std::vector<Move>& moves) const {
+	size_t position = 0;
+	uint64_t count = get_varint(data, size, position);
+	if (count >= static_cast<uint64_t>(Board::kMaxPly))
+		throw std::runtime_error("corrupt move data");
+	moves.clear();
+	Board board;
+	MoveList list;
+
+	if (_coding == kFixed) {
+		uint64_t bit = position * 8;
+		for (uint64_t i = 0; i < count; i++) {
+			rank(board, list);
+			int bits = width(list.size), index = 0;
+			if ((bit + bits + 7) / 8 > size)
+				throw std::runtime_error("truncated move data");
+			for (int j = 0; j < bits; j++, bit++)
+				index = (index << 1) | ((data[bit >> 3] >> (7 - (bit & 7))) & 1);
+			if (index >= list.size)
+				throw std::runtime_error("corrupt move data");
+			board.make(list[index]);
+			moves.push_back(unpack(list[index]));
+		}
+		return (bit + 7) / 8;
+	}
+
+	uint64_t length = get_varint(data, size, position);
+	if (length > size - position)
+		throw std::runtime_error("truncated move data");
+	RangeDecoder decoder(data + position, length);
+	Model model;
+	for (uint64_t i = 0; i < count; i++) {
+		rank(board, list);
+		if (!list.size)
+			throw std::runtime_error("corrupt move data");
+		int index = decode_rank(decoder, model, list.size);
+		if (index >= list.size)
+			throw std::runtime_error("corrupt move data");
+		board.make(list[index]);
+		moves.push_back(unpack(list[index]));
+	}
+	return position + length;
+}
+
+} // namespace chess
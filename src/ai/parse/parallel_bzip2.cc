@@ -0,0 +1,292 @@
+#include "parallel_bzip2.h"
+
+#include <bzlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace chess {
+
+namespace {
+
+/*! Marks the beginning of every block: the digits of pi. */
+const uint64_t kBlockMagic = 0x314159265359ull;
+
+/*! Marks the end of every stream: the digits of the square root of pi. */
+const uint64_t kEndMagic = 0x177245385090ull;
+
+const uint64_t kMagicMask = (1ull << 48) - 1;
+
+/*! Blocks decoded per thread in every batch. */
+const size_t kBlocksPerThread = 2;
+
+/*!
+ * Appends bits to a string, most significant bit first, as bzip2 does.
+ */
+class BitWriter {
+private:
+	std::string& _out;
+	uint32_t _bits;
+	int _count;
+
+public:
+	explicit BitWriter(std::string& out) : _out(out), _bits(0), _count(0) {}
+
+	/*! Appends the lowest bits of the value. */
+	inline void write(uint64_t value, int bits) {
+		while (bits--) {
+			_bits = (_bits << 1) | ((value >> bits) & 1);
+			if (++_count == 8) {
+				_out += static_cast<char>(_bits);
+				_bits = 0;
+				_count = 0;
+			}
+		}
+	}
+
+	/*!
+	 * Appends the bits [begin, end) of the data. Whole bytes are copied at
+	 * once when the writer is aligned to a byte.
+	 */
+	inline void copy(const std::vector<uint8_t>& data, uint64_t begin,
+			uint64_t end) {
+		if (!_count) {
+			size_t base = begin >> 3;
+			int shift = begin & 7;
+			uint64_t bytes = (end - begin) >> 3;
+			for (uint64_t i = 0; i < bytes; i++)
+				_out += static_cast<char>(shift ? (data[base + i] << shift) |
+					(data[base + i + 1] >> (8 - shift)) : data[base + i]);
+			begin += bytes * 8;
+		}
+		for (; begin < end; begin++)
+			write((data[begin >> 3] >> (7 - (begin & 7))) & 1, 1);
+	}
+
+	/*! Pads the last byte with zeros. */
+	inline void flush() {
+		if (_count)
+			write(0, 8 - _count);
+	}
+};
+
+/*! Reads bits [begin, begin + bits) of the data. */
+inline uint64_t read(const std::vector<uint8_t>& data, uint64_t begin,
+		int bits) {
+	uint64_t value = 0;
+	for (uint64_t i = begin; i < begin + bits; i++)
+		value = (value << 1) | ((data[i >> 3] >> (7 - (i & 7))) & 1);
+	return value;
+}
+
+} // namespace
+
+ParallelBzip2Buffer::ParallelBzip2Buffer(std::istream& source, int threads,
+		size_t chunk) : _source(source), _threads(threads > 0 ? threads :
+		std::max<int>(std::thread::hardware_concurrency(), 1)), _chunk(chunk),
+		_scan(0), _register(0), _filled(0), _open(-1), _header(0), _level(9),
+		_started(false) {
+	setg(nullptr, nullptr, nullptr);
+}
+
+ParallelBzip2Buffer::~ParallelBzip2Buffer() {
+	if (_pending.valid())
+		_pending.wait();
+}
+
+void ParallelBzip2Buffer::scan() {
+	while (true) {
+		// Every stream begins with BZh and its block size in 100 kB
+		if (_header >= 0) {
+			if (_data.size() < static_cast<uint64_t>(_header) + 4)
+				return;
+			const uint8_t* header = &_data[_header];
+			if (std::memcmp(header, "BZh", 3) != 0 || header[3] < '1' ||
+					header[3] > '9')
+				throw std::runtime_error("not bzip2 data");
+			_level = header[3] - '0';
+			_scan = _header + 4;
+			_register = 0;
+			_filled = 0;
+			_header = -1;
+		}
+		if (_scan >= _data.size())
+			return;
+
+		// Test the window of 48 bits that ends at every bit of the next byte
+		_register = (_register << 8) | _data[_scan];
+		_filled = std::min(_filled + 1, 8);
+		for (int shift = std::min(7, _filled * 8 - 48); shift >= 0; shift--) {
+			uint64_t magic = (_register >> shift) & kMagicMask;
+			if (magic != kBlockMagic && magic != kEndMagic)
+				continue;
+
+			int64_t at = static_cast<int64_t>(_scan * 8 + 8 - shift) - 48;
+			if (at < 0)
+				throw std::runtime_error("corrupt bzip2 data");
+			if (_open >= 0)
+				_blocks.push_back(Block{static_cast<uint64_t>(_open),
+					static_cast<uint64_t>(at), _level});
+			_open = (magic == kBlockMagic) ? at : -1;
+
+			// The stream ends with a 32 bit CRC, padded to a byte
+			if (magic == kEndMagic) {
+				_header = (at + 48 + 32 + 7) / 8;
+				break;
+			}
+		}
+		_scan++;
+	}
+}
+
+std::string ParallelBzip2Buffer::decode(const Block& block) const {
+	// A stream of the single block, whose CRC is then that of the block
+	std::string stream = "BZh";
+	stream += static_cast<char>('0' + block.level);
+	BitWriter writer(stream);
+	writer.copy(_data, block.begin, block.end);
+	writer.write(kEndMagic, 48);
+	writer.write(read(_data, block.begin + 48, 32), 32);
+	writer.flush();
+
+	bz_stream bz;
+	std::memset(&bz, 0, sizeof(bz));
+	if (BZ2_bzDecompressInit(&bz, 0, 0) != BZ_OK)
+		throw std::runtime_error("bzip2 init failed");
+	bz.next_in = &stream[0];
+	bz.avail_in = static_cast<unsigned int>(stream.size());
+
+	std::string output(block.level * 100000 + 1024, '\0');
+	size_t produced = 0;
+	int status;
+	do {
+		if (produced == output.size())
+			output.resize(output.size() * 2);
+		bz.next_out = &output[produced];
+		bz.avail_out = static_cast<unsigned int>(output.size() - produced);
+		status = BZ2_bzDecompress(&bz);
+		produced = output.size() - bz.avail_out;
+	} while (status == BZ_OK && (bz.avail_in || !bz.avail_out));
+	BZ2_bzDecompressEnd(&bz);
+
+	if (status != BZ_STREAM_END)
+		throw std::runtime_error("corrupt bzip2 block at bit " +
+			std::to_string(block.begin));
+	output.resize(produced);
+	return output;
+}
+
+bool ParallelBzip2Buffer::fill() {
+	size_t size = _data.size();
+	_data.resize(size + _chunk);
+	_source.read(reinterpret_cast<char*>(&_data[size]), _chunk);
+	_data.resize(size + _source.gcount());
+	scan();
+	return !_source;
+}
+
+ParallelBzip2Buffer::Batch ParallelBzip2Buffer::batch() {
+	Batch batch;
+	batch.last = false;
+	while (_blocks.size() < _threads * kBlocksPerThread && !batch.last)
+		batch.last = fill();
+
+	std::vector<std::string> outputs(_blocks.size());
+	std::vector<std::exception_ptr> errors(_blocks.size());
+	std::vector<std::thread> workers;
+	for (int t = 0; t < _threads && static_cast<size_t>(t) < _blocks.size(); t++) {
+		workers.emplace_back([this, t, &outputs, &errors]() {
+			for (size_t i = t; i < _blocks.size(); i += _threads) {
+				try {
+					outputs[i] = decode(_blocks[i]);
+				} catch (...) {
+					errors[i] = std::current_exception();
+				}
+			}
+		});
+	}
+	for (auto& worker : workers)
+		worker.join();
+
+	// A false magic number splits a block in two, neither of which decodes, so
+	// a block that fails is merged with the next block of its stream, read on
+	// if need be, and decoded again before the data is called corrupt
+	for (size_t i = 0; i < _blocks.size(); i++) {
+		if (i == outputs.size()) {
+			outputs.emplace_back();
+			errors.emplace_back();
+			try {
+				outputs[i] = decode(_blocks[i]);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		}
+		if (!errors[i])
+			continue;
+		while (i + 1 == _blocks.size() && _open >= 0 &&
+				static_cast<uint64_t>(_open) == _blocks[i].end && !batch.last)
+			batch.last = fill();
+		if (i + 1 == _blocks.size() || _blocks[i + 1].begin != _blocks[i].end)
+			std::rethrow_exception(errors[i]);
+
+		_blocks[i].end = _blocks[i + 1].end;
+		outputs[i] = decode(_blocks[i]);
+		_blocks.erase(_blocks.begin() + i + 1);
+		if (i + 1 < outputs.size()) {
+			outputs.erase(outputs.begin() + i + 1);
+			errors.erase(errors.begin() + i + 1);
+		}
+	}
+	if (batch.last && (_open >= 0 ||
+			(_header >= 0 && _data.size() > static_cast<uint64_t>(_header))))
+		throw std::runtime_error("truncated bzip2 data");
+
+	size_t total = 0;
+	for (const auto& output : outputs)
+		total += output.size();
+	batch.output.reserve(total);
+	for (const auto& output : outputs)
+		batch.output += output;
+	_blocks.clear();
+
+	// Drop the data before the first block that is not yet complete, but keep
+	// the bytes of the 48 bit window, in which a magic number may have begun
+	uint64_t keep = (_open >= 0) ? _open / 8 : (_header >= 0) ? _header :
+		_scan - std::min<uint64_t>(_scan, 6);
+	_data.erase(_data.begin(), _data.begin() + keep);
+	_scan -= keep;
+	if (_open >= 0)
+		_open -= keep * 8;
+	if (_header >= 0)
+		_header -= keep;
+	return batch;
+}
+
+ParallelBzip2Buffer::int_type ParallelBzip2Buffer::underflow() {
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+
+	if (!_started) {
+		_started = true;
+		_pending = std::async(std::launch::async, &ParallelBzip2Buffer::batch, this);
+	}
+
+	// Decode the next batch while this one is read
+	while (_pending.valid()) {
+		Batch next = _pending.get();
+		if (!next.last)
+			_pending = std::async(std::launch::async, &ParallelBzip2Buffer::batch,
+				this);
+		_output.swap(next.output);
+		if (!_output.empty()) {
+			setg(&_output[0], &_output[0], &_output[0] + _output.size());
+			return traits_type::to_int_type(*gptr());
+		}
+	}
+	return traits_type::eof();
+}
+
+} // namespace chess
@@ -0,0 +1,138 @@
+#ifndef AI_PARALLEL_BZIP2_H
+#define AI_PARALLEL_BZIP2_H
+
+#include <cstdint>
+#include <future>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * This class is a stream buffer that decompresses bzip2 data on every core.
+ * A bzip2 stream is a sequence of independently compressed blocks of up to
+ * 900 kB, each of which begins with a 48 bit magic number; blocks are not
+ * aligned to bytes, so the compressed data is scanned bit by bit for the
+ * magic numbers of blocks and of stream ends. Every block found is copied
+ * into a stream of its own, with a stream header in front and a stream end
+ * behind it, which libbz2 decodes like any other stream and checks against
+ * the CRC of the block. Blocks are read and decoded in batches of a few per
+ * thread, and the output of each batch is kept in the order of its blocks.
+ * The next batch is decoded in the background while the current one is read.
+ *
+ * A 48 bit pattern inside compressed data can mimic the magic number of a
+ * block, though only about once in 30 TB of random data. Neither half of the
+ * block it splits decodes, so a block that fails its CRC is merged with the
+ * next block of its stream and decoded again; only if the merged block fails
+ * as well is the input corrupt. Corrupt input is reported as a
+ * std::runtime_error from the read that finds it, which an istream reports
+ * by setting its badbit. A pattern that mimics the end of a stream is not
+ * recovered from.
+ */
+class ParallelBzip2Buffer : public std::streambuf {
+private:
+	/*! A complete block, as bit offsets into the compressed data. */
+	struct Block {
+		uint64_t begin;
+		uint64_t end;
+		int level;
+	};
+
+	/*! The output of a batch of blocks. */
+	struct Batch {
+		std::string output;
+		bool last;
+	};
+
+	std::istream& _source;
+	int _threads;
+	size_t _chunk;
+
+	std::vector<uint8_t> _data;
+	uint64_t _scan;
+	uint64_t _register;
+	int _filled;
+	int64_t _open;
+	int64_t _header;
+	int _level;
+	std::vector<Block> _blocks;
+
+	std::future<Batch> _pending;
+	std::string _output;
+	bool _started;
+
+	/*!
+	 * Scans the compressed data read so far for the boundaries of blocks,
+	 * adding every complete block to the list.
+	 */
+	void scan();
+
+	/*!
+	 * Reads the next chunk of the source and scans it.
+	 * @return True once the source is exhausted.
+	 */
+	bool fill();
+
+	/*!
+	 * Reads and decodes the next batch of blocks.
+	 * @return Output of the batch.
+	 */
+	Batch batch();
+
+	/*!
+	 * Decodes a single block of the compressed data.
+	 * @param[in] block Block to decode.
+	 * @return Decompressed data.
+	 */
+	std::string decode(const Block& block) const;
+
+protected:
+	/*!
+	 * Waits for the next batch of data.
+	 * @return Next character, or EOF once the source is exhausted.
+	 */
+	int_type underflow() override;
+
+public:
+	/*!
+	 * Constructs a buffer that decompresses the source.
+	 * @param[in] source Stream of bzip2 data, which must outlive the buffer.
+	 * @param[in] threads Number of decoding threads; zero uses every core.
+	 * @param[in] chunk Size of each read from the source.
+	 */
+	explicit ParallelBzip2Buffer(std::istream& source, int threads = 0,
+		size_t chunk = 1 << 20);
+
+	/*!
+	 * Waits for the batch being decoded, if any.
+	 */
+	~ParallelBzip2Buffer();
+
+	ParallelBzip2Buffer(const ParallelBzip2Buffer&) = delete;
+	ParallelBzip2Buffer& operator=(const ParallelBzip2Buffer&) = delete;
+};
+
+/*!
+ * An input stream that decompresses bzip2 data on every core.
+ */
+class ParallelBzip2Stream : public std::istream {
+private:
+	ParallelBzip2Buffer _buffer;
+
+public:
+	/*!
+	 * Constructs a stream that decompresses the source.
+	 * @param[in] source Stream of bzip2 data, which must outlive this stream.
+	 * @param[in] threads Number of decoding threads; zero uses every core.
+	 */
+	explicit ParallelBzip2Stream(std::istream& source, int threads = 0)
+		: std::istream(nullptr), _buffer(source, threads) {
+		rdbuf(&_buffer);
+	}
+};
+
+} // namespace chess
+
+#endif // AI_PARALLEL_BZIP2_H
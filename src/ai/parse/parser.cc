@@ -1,73 +1,340 @@
 #include "parser.h"
-#include "sample.h"
+#include "pgn_lexer.h"
 
-#include "core/game.h"
+#include "ai/struct/board.h"
 
 #include <thread>
-#include <regex>
 #include <ctime>
 #include <chrono>
 #include <iomanip>
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace chess {
 
-void Parser::parse_game() {
-	// Define the regex patterns outside the while loop to save time; these regex
-	// patterns will not change in the body of the loop and therefore do not need
-	// to be recreated every iteration. Aggregated over thousands of iterations
-	// this should save considerable cycles at runtime.
-	std::regex rslt_regex("\\[Result \"(.*?)\"\\]");
-	std::regex welo_regex("\\[WhiteElo \"([0-9]+)\"\\]");
-	std::regex belo_regex("\\[BlackElo \"([0-9]+)\"\\]");	
-	std::regex move_regex("(\\[.*?\\]|{.*}|\\d+\\.)");
-	std::regex turn_regex("\\s+");
+namespace {
+
+/*! Batches buffered per worker between the reader and the workers. */
+const size_t kBatchesPerThread = 4;
+
+/*! Returns the number of workers to run: nthreads, or one per core. */
+inline int workers(int nthreads) {
+	return nthreads > 0 ? nthreads :
+		std::max<int>(std::thread::hardware_concurrency(), 1);
+}
+
+/*! Returns the microseconds elapsed since the start. */
+inline int64_t elapsed(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+/*! Returns the rating in a tag, or zero unless it is a number. */
+inline int rating(const PgnToken& tag) {
+	if (tag.value_length > 9)
+		return 0;
+	int elo = 0;
+	for (size_t i = 0; i < tag.value_length; i++) {
+		if (tag.value[i] < '0' || tag.value[i] > '9')
+			return 0;
+		elo = elo * 10 + (tag.value[i] - '0');
+	}
+	return elo;
+}
+
+/*! Returns the result in a tag from white's perspective. */
+inline int outcome(const PgnToken& tag) {
+	if (tag.value_length != 3)
+		return 0;
+	return std::strncmp(tag.value, "1-0", 3) == 0 ? 1 :
+		std::strncmp(tag.value, "0-1", 3) == 0 ? -1 : 0;
+}
+
+} // namespace
+
+Parser::Parser(std::ostream& out, std::ostream& log, int nthreads,
+		size_t batch) : _batches(kBatchesPerThread * workers(nthreads)),
+		_input(nullptr), _log(log), _nthreads(workers(nthreads)),
+		_batch(batch), _parsed(0), _errors(0), _parse_time(0), _write_time(0) {
+	_writers.emplace_back(new SampleWriter(out));
+}
+
+Parser::Parser(const std::string& prefix, std::ostream& log, int nthreads,
+		size_t batch) : _batches(kBatchesPerThread * workers(nthreads)),
+		_input(nullptr), _log(log), _nthreads(workers(nthreads)),
+		_batch(batch), _prefix(prefix), _parsed(0), _errors(0), _parse_time(0),
+		_write_time(0) {
+	for (int i = 0; i < _nthreads; i++) {
+		std::string path = prefix + "." + std::to_string(i) + ".samples";
+		_files.emplace_back(new std::ofstream(path, std::ios::binary));
+		if (!*_files.back())
+			throw std::runtime_error("cannot create shard " + path);
+		_writers.emplace_back(new SampleWriter(*_files.back()));
+	}
+}
 
+void Parser::parse_batches(int worker) {
 	// Typically, you want to define variables in the smallest possible scope;
 	// however, the constructor and destructor will get called after every loop
 	// iteration. Therefore, we can squeeze out a few cycles by pulling out the
-	// declaration of loop variables.
-	std::smatch match;
-	Sample samp;
+	// declaration of loop variables. The samples of a batch are kept, with
+	// their moves, from one batch to the next.
+	std::vector<Sample> samples;
+	Batch batch;
 
 	// One of the challenges with the producer-consumer problem is informing
 	// consumers that the producer has completed production. To solve this
-	// problem, the empty string is a "poison" pill that indicates to consumers
-	// that the producer has finished and that it is permissible to terminate.
-	while (!_games.peek().empty()) {
-		std::string pgn = _games.pop();
-
-		// Extract white and black ratings
-		std::regex_search(pgn, match, welo_regex);
-		samp.white_elo = std::stoi(match[1]);
-		std::regex_search(pgn, match, belo_regex);
-		samp.black_elo = std::stoi(match[1]);
-
-		// Extract game result
-		std::regex_search(pgn, match, rslt_regex);
-		samp.result = (match[1] == "1-0") ? 1 : (match[1] == "0-1") ? -1 : 0;
-
-		// Extract moves
-		std::string moves = std::regex_replace(pgn, move_regex, "");
-		std::sregex_token_iterator it(moves.begin(), moves.end(), turn_regex, -1);
-		std::sregex_token_iterator end;
-		
-		Game game;
-		for (; it != end; ++it)
-			game.make(*it);
-		samp.moves = game.history();
-
-		// Serialize sample
-		_out << samp;
+	// problem, the batch without games is a "poison" pill that indicates to
+	// consumers that the producer has finished and that it is permissible to
+	// terminate. The producer pushes one pill per consumer, and every consumer
+	// stops at the first pill it pops, so that each pill stops exactly one
+	// consumer.
+	while (!(batch = _batches.pop()).ends.empty()) {
+		auto start = std::chrono::steady_clock::now();
+		const char* pgn = batch.text.empty() ? _input + batch.offset :
+			batch.text.data();
+		size_t parsed = 0, begin = 0;
+		for (size_t end : batch.ends) {
+			if (parsed == samples.size())
+				samples.emplace_back();
+			if (parse_game(pgn + begin, end - begin, samples[parsed]))
+				parsed++;
+			else
+				_errors++;
+			begin = end;
+		}
+		auto written = std::chrono::steady_clock::now();
+		_parse_time += std::chrono::duration_cast<std::chrono::microseconds>(
+			written - start).count();
+
+		// Serialize the batch at once; a single output is shared by every worker
+		{
+			std::unique_lock<std::mutex> lock(_write, std::defer_lock);
+			if (_files.empty())
+				lock.lock();
+			SampleWriter& writer = *_writers[_files.empty() ? 0 : worker];
+			for (size_t i = 0; i < parsed; i++)
+				writer.write(samples[i]);
+		}
+		_write_time += elapsed(written);
+		_parsed += parsed;
+	}
+}
+
+bool Parser::parse_game(const char* pgn, size_t length, Sample& samp) {
+	// The game is lexed in a single pass: its tags give the ratings, which are
+	// zero for unrated players, and the result, and its moves are resolved
+	// against the legal moves of a Board, which is far faster than the Game of
+	// the core API
+	PgnLexer lexer(pgn, length);
+	PgnToken token;
+	Board board;
+	samp.white_elo = samp.black_elo = samp.result = 0;
+	samp.moves.clear();
+	while (lexer.next(token)) {
+		if (token.type == PgnToken::kResult)
+			break;
+		if (token.type == PgnToken::kTag) {
+			if (token.is("WhiteElo"))
+				samp.white_elo = rating(token);
+			else if (token.is("BlackElo"))
+				samp.black_elo = rating(token);
+			else if (token.is("Result"))
+				samp.result = outcome(token);
+			continue;
+		}
+
+		PackedMove move = board.parse_san(token.text, token.length);
+		if (samp.moves.size() + 1 >= static_cast<size_t>(Board::kMaxPly)) {
+			log("game too long\n" + std::string(pgn, length));
+			return false;
+		} else if (!move) {
+			log("cannot parse move " + std::string(token.text, token.length) +
+				" of game\n" + std::string(pgn, length));
+			return false;
+		}
+		board.make(move);
+		samp.moves.push_back(unpack(move));
 	}
+	return true;
 }
 
 void Parser::log(std::string msg) {
 	auto now  = std::chrono::system_clock::now();
 	auto nowt = std::chrono::system_clock::to_time_t(now); 	
+	std::lock_guard<std::mutex> lock(_logging);
 	_log << std::put_time(std::localtime(&nowt), "%d/%m/%Y %X: ") << msg << "\n";
 }
 
-void Parser::parse(std::istream& in) {
+ParseStats Parser::run(const std::function<void(ParseStats&)>& read) {
+	auto start = std::chrono::steady_clock::now();
+	_parsed = _errors = 0;
+	_parse_time = _write_time = 0;
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < _nthreads; i++)
+		workers.emplace_back(&Parser::parse_batches, this, i);
+
+	ParseStats stats;
+	read(stats);
+	stats.read_time = elapsed(start) / 1000;
+
+	for (int i = 0; i < _nthreads; i++)
+		_batches.push(Batch());
+	for (auto& worker : workers)
+		worker.join();
+
+	// The manifest lists every sample written so far
+	if (!_files.empty()) {
+		std::vector<Shard> shards;
+		size_t slash = _prefix.rfind('/');
+		std::string name = (slash == std::string::npos) ? _prefix :
+			_prefix.substr(slash + 1);
+		for (int i = 0; i < _nthreads; i++) {
+			_files[i]->flush();
+			if (!*_files[i])
+				log("cannot write shard " + std::to_string(i));
+			shards.push_back(Shard{name + "." + std::to_string(i) + ".samples",
+				_writers[i]->count()});
+		}
+		SampleDataset::save(_prefix + ".manifest", shards);
+	}
+
+	stats.games = _parsed;
+	stats.errors = _errors;
+	stats.parse_time = _parse_time / 1000;
+	stats.write_time = _write_time / 1000;
+	stats.time = elapsed(start) / 1000;
+
+	double seconds = std::max<int64_t>(stats.time, 1) / 1000.0;
+	std::ostringstream summary;
+	summary << std::fixed << std::setprecision(2) << "parsed " << stats.games
+		<< " games (" << stats.errors << " errors) in " << seconds << "s, "
+		<< stats.games / seconds << " games/s; read " << stats.read_time / 1000.0
+		<< "s, parse " << stats.parse_time / 1000.0 << "s, write "
+		<< stats.write_time / 1000.0 << "s";
+	log(summary.str());
+	return stats;
+}
+
+ParseStats Parser::parse(std::istream& in) {
+	// A game is its tag pairs followed by its move text; the next tag pair
+	// after any move text begins the next game, and the next batch once the
+	// batch is full
+	ParseStats stats = run([this, &in](ParseStats& stats) {
+		std::string line;
+		Batch batch = Batch();
+		bool moves = false;
+		while (std::getline(in, line)) {
+			stats.bytes += line.size() + 1;
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (!line.empty() && line[0] == '[' && moves) {
+				batch.ends.push_back(batch.text.size());
+				moves = false;
+				if (batch.text.size() >= _batch) {
+					_batches.push(std::move(batch));
+					batch = Batch();
+				}
+			}
+			moves |= !line.empty() && line[0] != '[';
+			batch.text += line;
+			batch.text += '\n';
+		}
+		// The last game of input that failed may be cut short
+		if (moves && !in.bad())
+			batch.ends.push_back(batch.text.size());
+		if (!batch.ends.empty())
+			_batches.push(std::move(batch));
+		if (in.bad())
+			log("input failed after " + std::to_string(stats.bytes) + " bytes");
+	});
+
+	// The workers are stopped and the output is complete up to the failure
+	if (in.bad())
+		throw std::runtime_error("input failed after " +
+			std::to_string(stats.bytes) + " bytes");
+	return stats;
+}
+
+ParseStats Parser::parse(const char* data, size_t size) {
+	// Games are split as in a stream, but pushed as slices of the input
+	_input = data;
+	ParseStats stats = run([this, data, size](ParseStats& stats) {
+		const char* end = data + size;
+		Batch batch = Batch();
+		bool moves = false;
+		for (const char* line = data; line < end;) {
+			const char* stop = static_cast<const char*>(
+				std::memchr(line, '\n', end - line));
+			const char* next = stop ? stop + 1 : end;
+			if (!stop)
+				stop = end;
+			if (stop > line && stop[-1] == '\r')
+				stop--;
+			if (*line == '[' && moves) {
+				size_t offset = line - data;
+				batch.ends.push_back(offset - batch.offset);
+				moves = false;
+				if (offset - batch.offset >= _batch) {
+					_batches.push(std::move(batch));
+					batch = Batch();
+					batch.offset = offset;
+				}
+			}
+			moves |= stop > line && *line != '[';
+			line = next;
+		}
+		if (moves)
+			batch.ends.push_back(size - batch.offset);
+		if (!batch.ends.empty())
+			_batches.push(std::move(batch));
+		stats.bytes = size;
+	});
+	_input = nullptr;
+	return stats;
+}
+
+ParseStats Parser::parse_file(const std::string& path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("cannot open " + path);
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		throw std::runtime_error("cannot open " + path);
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	size_t size = static_cast<size_t>(info.st_size);
+	void* mapping = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) :
+		nullptr;
+	close(fd);
+	if (mapping == MAP_FAILED)
+		throw std::runtime_error("cannot map " + path);
+	if (size)
+		madvise(mapping, size, MADV_SEQUENTIAL);
+
+	ParseStats stats;
+	try {
+		stats = parse(static_cast<const char*>(mapping), size);
+	} catch (...) {
+		if (size)
+			munmap(mapping, size);
+		throw;
+	}
+	if (size)
+		munmap(mapping, size);
+	return stats;
 }
 
 } // namespace chess
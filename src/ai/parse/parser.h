@@ -1,31 +1,115 @@
 #ifndef AI_PARSER_H
 #define AI_PARSER_H
 
-#include "blocking_queue.h"
+#include "ring_buffer.h"
+#include "sample_dataset.h"
+#include "sample_file.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <iostream>
-#include <boost/archive/text_oarchive.hpp>
+#include <vector>
 
 namespace chess {
 
+/*!
+ * Counters and timings of a parse. Times are in milliseconds; the parse and
+ * write times are summed over every worker, so they may exceed the total.
+ */
+struct ParseStats {
+	uint64_t games;
+	uint64_t errors;
+	uint64_t bytes;
+	int64_t read_time;
+	int64_t parse_time;
+	int64_t write_time;
+	int64_t time;
+
+	ParseStats() : games(0), errors(0), bytes(0), read_time(0), parse_time(0),
+		write_time(0), time(0) {}
+};
+
 /*!
  * This class parses PGN games from an input stream and writes their contents
  * to an output stream. This class is used to translate the massive PGN file
- * all-games.pgn into a format that the core chess API can comprehend.
+ * all-games.pgn into a format that the core chess API can comprehend: a file
+ * of samples in the binary sample format (see SampleWriter).
+ *
+ * Parsing is a pipeline: the calling thread splits the input into batches
+ * of whole games, each about batch bytes of contiguous input, and moves them
+ * onto a bounded lock-free queue (see RingBuffer), from which nthreads workers
+ * pop, parse and serialize them. A game takes microseconds to parse, so
+ * batches spread the cost of the queue, and of the shared output, over
+ * hundreds of games. Samples are written in the order they are parsed, which
+ * is not necessarily the order of the input.
+ *
+ * Input that is already in memory, such as a decompressed file mapped with
+ * parse_file(), is never copied: the queue then carries the offset of each
+ * batch within the input, and workers lex the games where they lie.
+ *
+ * Workers either share a single output, which they take turns to write, or
+ * each write a shard of their own, so that they never contend; a manifest
+ * then lists the shards and their number of samples (see SampleDataset).
  */
 class Parser {
 private:
-	BlockingQueue<std::string> _games;
+	/*!
+	 * Consecutive games to parse: either text of their own, read from a
+	 * stream, or a slice of the input in memory that begins at the offset.
+	 * Each game ends where the next begins; the batch without games stops a
+	 * worker.
+	 */
+	struct Batch {
+		std::string text;
+		size_t offset;
+		std::vector<size_t> ends;
+	};
+
+	RingBuffer<Batch> _batches;
+	const char* _input;
 	std::ostream& _log;
-	boost::archive::text_oarchive& _out;
 	int _nthreads;
+	size_t _batch;
+	std::string _prefix;
+	std::vector<std::unique_ptr<std::ofstream>> _files;
+	std::vector<std::unique_ptr<SampleWriter>> _writers;
+	std::mutex _write;
+	std::mutex _logging;
+	std::atomic<uint64_t> _parsed;
+	std::atomic<uint64_t> _errors;
+	std::atomic<int64_t> _parse_time;
+	std::atomic<int64_t> _write_time;
 
 	/*!
-	 * This function parses games in PGN and outputs the result to the
-	 * out stream and any debug information (parse errors, etc.) to the log.
+	 * This function parses batches of games in PGN and outputs the result to
+	 * the out stream and any debug information (parse errors, etc.) to the
+	 * log. Runs until it pops a batch without games.
+	 * @param[in] worker Index of the worker, which selects its shard.
 	 */ 
-	void parse_game();
+	void parse_batches(int worker);
+
+	/*!
+	 * Parses a single game in PGN; logs it if it cannot be parsed.
+	 * @param[in] pgn Text of the game.
+	 * @param[in] length Length of the text.
+	 * @param[out] samp Sample of the game.
+	 * @return True if the game was parsed.
+	 */
+	bool parse_game(const char* pgn, size_t length, Sample& samp);
+
+	/*!
+	 * Runs the workers while the reader pushes every game of the input, then
+	 * stops them and logs a summary.
+	 * @param[in] read Reader, which counts the bytes it reads.
+	 * @return Counters and timings of the parse.
+	 */
+	ParseStats run(const std::function<void(ParseStats&)>& read);
 
 	/*!
 	 * Prints the specified debug message to the logging stream. Also appends
@@ -35,22 +119,64 @@ private:
 	void log(std::string msg);
 
 public:
+	/*! Default size of a batch of games, in bytes of input. */
+	static const size_t kBatchBytes = 256 << 10;
+
 	/*!
 	 * Constructs a parser that writes parsed data to the out stream, debug 
 	 * and error information to the log stream, and uses nthreads.
 	 * @param[in] out Output data stream.
 	 * @param[in] log Logging stream.
-	 * @param[in] nthreads Number of threads to use.
+	 * @param[in] nthreads Number of threads to use; zero uses every core.
+	 * @param[in] batch Bytes of input after which a batch of games is handed
+	 * to a worker; zero hands out games one at a time.
+	 */
+	Parser(std::ostream& out, std::ostream& log, int nthreads,
+		size_t batch = kBatchBytes);
+
+	/*!
+	 * Constructs a parser whose workers each write a shard of their own,
+	 * named <prefix>.<worker>.samples, listed in the manifest
+	 * <prefix>.manifest, which is rewritten after every parse.
+	 * @param[in] prefix Path of the shards and manifest, without extension.
+	 * @param[in] log Logging stream.
+	 * @param[in] nthreads Number of threads to use; zero uses every core.
+	 * @param[in] batch Bytes of input after which a batch of games is handed
+	 * to a worker; zero hands out games one at a time.
+	 * @throws std::runtime_error if a shard cannot be created.
 	 */
-	Parser(std::ostream& out, std::ostream& log, int nthreads);
+	Parser(const std::string& prefix, std::ostream& log, int nthreads,
+		size_t batch = kBatchBytes);
 
 	/*!
 	 * Parses the contents of the specified stream. Assumes that the stream is a
 	 * list of PGN games. Parallelizes the translation from PGN games to the
-	 * format understood by the core chess API.
+	 * format understood by the core chess API. Games that cannot be parsed
+	 * are logged and skipped.
 	 * @param[in] in Input file stream.
+	 * @return Counters and timings of the parse.
+	 * @throws std::runtime_error if the stream fails before its end, such as
+	 * on corrupt compressed input; the games before the failure are written.
+	 */
+	ParseStats parse(std::istream& in);
+
+	/*!
+	 * Parses PGN games held in memory, without copying them.
+	 * @param[in] data Beginning of the games, which must not change while
+	 * they are parsed.
+	 * @param[in] size Size of the games in bytes.
+	 * @return Counters and timings of the parse.
+	 */
+	ParseStats parse(const char* data, size_t size);
+
+	/*!
+	 * Maps a file of PGN games into memory and parses it without copying it;
+	 * the file must not be compressed.
+	 * @param[in] path Path of the file.
+	 * @return Counters and timings of the parse.
+	 * @throws std::runtime_error if the file cannot be mapped.
 	 */
-	void parse(std::istream& in);
+	ParseStats parse_file(const std::string& path);
 };
 
 } // namespace chess
@@ -0,0 +1,166 @@
+#include "pgn_lexer.h"
+
+namespace chess {
+
+namespace {
+
+/*! Returns true if the character separates tokens. */
+inline bool space(char c) {
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' ||
+		c == '\v';
+}
+
+/*! Returns true if the character ends a symbol, i.e. a move or a number. */
+inline bool delimiter(char c) {
+	return space(c) || c == '{' || c == '}' || c == '(' || c == ')' ||
+		c == '[' || c == ']' || c == ';' || c == '$';
+}
+
+inline bool digit(char c) { return c >= '0' && c <= '9'; }
+
+/*! Returns true if the symbol is one of the four results. */
+inline bool result(const char* text, size_t length) {
+	switch (length) {
+	case 1:
+		return text[0] == '*';
+	case 3:
+		return std::strncmp(text, "1-0", 3) == 0 ||
+			std::strncmp(text, "0-1", 3) == 0;
+	case 7:
+		return std::strncmp(text, "1/2-1/2", 7) == 0;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+PgnLexer::PgnLexer(const char* text, size_t length) : _begin(text),
+	_cursor(text), _end(text + length) {}
+
+PgnLexer::PgnLexer(const std::string& text) : PgnLexer(text.data(),
+	text.size()) {}
+
+void PgnLexer::skip_line() {
+	while (_cursor < _end && *_cursor != '\n')
+		_cursor++;
+}
+
+void PgnLexer::skip_comment() {
+	while (_cursor < _end && *_cursor++ != '}') {}
+}
+
+void PgnLexer::skip_variation() {
+	// Comments may hold parentheses that do not nest
+	int depth = 0;
+	while (_cursor < _end) {
+		char c = *_cursor++;
+		if (c == '(')
+			depth++;
+		else if (c == ')' && --depth == 0)
+			return;
+		else if (c == '{')
+			skip_comment();
+		else if (c == ';')
+			skip_line();
+	}
+}
+
+bool PgnLexer::tag(PgnToken& token) {
+	// [Name "value"], where the value may escape quotes with a backslash
+	_cursor++;
+	while (_cursor < _end && (*_cursor == ' ' || *_cursor == '\t'))
+		_cursor++;
+	token.type = PgnToken::kTag;
+	token.text = _cursor;
+	while (_cursor < _end && !delimiter(*_cursor) && *_cursor != '"')
+		_cursor++;
+	token.length = _cursor - token.text;
+	while (_cursor < _end && (*_cursor == ' ' || *_cursor == '\t'))
+		_cursor++;
+	if (_cursor == _end || *_cursor != '"' || !token.length) {
+		skip_line();
+		return false;
+	}
+
+	token.value = ++_cursor;
+	while (_cursor < _end && *_cursor != '"' && *_cursor != '\n')
+		_cursor += (*_cursor == '\\' && _cursor + 1 < _end) ? 2 : 1;
+	if (_cursor >= _end || *_cursor != '"') {
+		skip_line();
+		return false;
+	}
+	token.value_length = _cursor - token.value;
+
+	// Anything after the value up to the bracket is ignored
+	while (_cursor < _end && *_cursor != ']' && *_cursor != '\n')
+		_cursor++;
+	if (_cursor < _end && *_cursor == ']')
+		_cursor++;
+	return true;
+}
+
+bool PgnLexer::next(PgnToken& token) {
+	while (_cursor < _end) {
+		char c = *_cursor;
+		if (space(c)) {
+			_cursor++;
+		} else if (c == '%' && (_cursor == _begin || _cursor[-1] == '\n')) {
+			skip_line();
+		} else if (c == ';') {
+			skip_line();
+		} else if (c == '{') {
+			_cursor++;
+			skip_comment();
+		} else if (c == '(') {
+			skip_variation();
+		} else if (c == ')' || c == '}' || c == ']') {
+			_cursor++;
+		} else if (c == '$') {
+			for (_cursor++; _cursor < _end && digit(*_cursor); _cursor++) {}
+		} else if (c == '[') {
+			if (tag(token))
+				return true;
+		} else {
+			const char* start = _cursor;
+			while (_cursor < _end && !delimiter(*_cursor))
+				_cursor++;
+			size_t length = _cursor - start;
+			token.text = start;
+			token.length = length;
+			token.value = nullptr;
+			token.value_length = 0;
+			if (result(start, length)) {
+				token.type = PgnToken::kResult;
+				return true;
+			}
+
+			// Move numbers (12. or 12...) may be written against the move
+			// that follows them; castling may be written with zeros
+			const char* move = start;
+			if (digit(*move) && (length < 3 || std::strncmp(move, "0-0", 3))) {
+				while (move < _cursor && digit(*move))
+					move++;
+				while (move < _cursor && *move == '.')
+					move++;
+			}
+			while (move < _cursor && *move == '.')
+				move++;
+
+			// Annotation marks written apart from their move are ignored
+			const char* mark = move;
+			while (mark < _cursor && (*mark == '!' || *mark == '?'))
+				mark++;
+			if (mark == _cursor)
+				continue;
+
+			token.type = PgnToken::kMove;
+			token.text = move;
+			token.length = _cursor - move;
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace chess
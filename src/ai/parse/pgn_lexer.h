@@ -0,0 +1,99 @@
+#ifndef AI_PGN_LEXER_H
+#define AI_PGN_LEXER_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace chess {
+
+/*!
+ * A token of PGN. Tokens point into the text being lexed and are only valid
+ * while it is; they are neither copied nor terminated.
+ */
+struct PgnToken {
+	enum Type {
+		kTag,		//!< A tag pair, e.g. [WhiteElo "1850"]
+		kMove,		//!< A move in standard algebraic notation, e.g. Nxe5+
+		kResult,	//!< The result that ends the move text, e.g. 1-0
+	};
+
+	Type type;
+	const char* text;
+	size_t length;
+	const char* value;
+	size_t value_length;
+
+	/*!
+	 * Returns true if the text of the token (the name of a tag) is the string.
+	 * @param[in] other Terminated string.
+	 * @return True if the token text equals the string.
+	 */
+	inline bool is(const char* other) const {
+		return std::strncmp(text, other, length) == 0 && !other[length];
+	}
+};
+
+/*!
+ * This class splits PGN text into tokens in a single pass, without regular
+ * expressions and without allocating memory. The lexer yields tag pairs,
+ * moves and results; it skips move numbers, comments (both {} and ; to the
+ * end of the line), numeric annotation glyphs such as $1, recursive
+ * annotation variations in parentheses, however deeply nested, annotation
+ * marks written apart from their move, and lines escaped with %.
+ *
+ * Tag values are returned as written, without undoing escaped quotes and
+ * backslashes. Text that belongs to no token is skipped.
+ */
+class PgnLexer {
+private:
+	const char* _begin;
+	const char* _cursor;
+	const char* _end;
+
+	/*! Skips to the end of the line, leaving the cursor on the newline. */
+	void skip_line();
+
+	/*! Skips a comment in braces, leaving the cursor after it. */
+	void skip_comment();
+
+	/*! Skips a variation, with its comments and nested variations. */
+	void skip_variation();
+
+	/*!
+	 * Reads a tag pair, leaving the cursor after it.
+	 * @param[out] token Tag pair.
+	 * @return True if the tag pair is well formed.
+	 */
+	bool tag(PgnToken& token);
+
+public:
+	/*!
+	 * Constructs a lexer over the text, which must outlive the lexer and the
+	 * tokens it yields.
+	 * @param[in] text Beginning of the text.
+	 * @param[in] length Length of the text.
+	 */
+	PgnLexer(const char* text, size_t length);
+
+	/*!
+	 * Constructs a lexer over the string, which must outlive the lexer and the
+	 * tokens it yields.
+	 * @param[in] text PGN text.
+	 */
+	explicit PgnLexer(const std::string& text);
+
+	/*!
+	 * Reads the next token.
+	 * @param[out] token Next token.
+	 * @return False once the text is exhausted.
+	 */
+	bool next(PgnToken& token);
+
+	/*! Returns the offset of the next character to be read. */
+	inline size_t offset() const { return _cursor - _begin; }
+};
+
+} // namespace chess
+
+#endif // AI_PGN_LEXER_H
@@ -0,0 +1,253 @@
+#ifndef AI_RING_BUFFER_H
+#define AI_RING_BUFFER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * This class is a bounded multi-producer, multi-consumer queue on a ring of
+ * slots (after Dmitry Vyukov's bounded MPMC queue). Every slot carries a
+ * sequence number that tells producers and consumers whose turn it is to use
+ * it, so that pushing and popping each take a single compare-and-swap on the
+ * head or tail of the ring and never a lock; producers and consumers only
+ * contend when they race for the same end. Elements are moved in and out,
+ * never copied, so move-only types are supported.
+ *
+ * The try_ variants never block. The blocking variants spin briefly, then
+ * sleep on a condition variable until the queue changes; the mutex is only
+ * taken when some thread is asleep, which in a busy pipeline is rare. A full
+ * queue blocks its producers, so a fast producer cannot buffer an entire
+ * input in memory ahead of its consumers. This class is thread-safe.
+ */
+template <typename T>
+class RingBuffer {
+private:
+	/*! Threads are put to sleep after this many failed attempts. */
+	static const int kSpins = 64;
+
+	/*! Size of a cache line, in bytes. */
+	static const size_t kCacheLine = 64;
+
+	struct Slot {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Slot[]> _slots;
+	size_t _mask;
+
+	// The ends of the ring are padded onto cache lines of their own, so that
+	// producers and consumers do not invalidate each other's lines. Padding
+	// rather than alignas keeps the queue, and any class that holds one,
+	// allocatable with new before C++17.
+	char _before_head[kCacheLine];
+	std::atomic<size_t> _head;
+	char _before_tail[kCacheLine - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> _tail;
+	char _before_sleepers[kCacheLine - sizeof(std::atomic<size_t>)];
+	std::atomic<int> _sleepers;
+	std::mutex _mutex;
+	std::condition_variable _changed;
+
+	/*! Wakes any sleeping threads after the queue has changed. */
+	inline void wake() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_sleepers.load(std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_changed.notify_all();
+		}
+	}
+
+	/*!
+	 * Retries an operation until it succeeds, sleeping between attempts once
+	 * spinning has failed.
+	 */
+	template <typename Attempt>
+	inline void retry(Attempt attempt) {
+		for (int i = 0; i < kSpins; i++) {
+			if (attempt())
+				return;
+			std::this_thread::yield();
+		}
+		_sleepers.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (!attempt())
+			_changed.wait(lock);
+		_sleepers.fetch_sub(1);
+	}
+
+	/*! Pushes the element unless the queue is full; moves it only on success. */
+	bool enqueue(T& value) {
+		size_t position = _head.load(std::memory_order_relaxed);
+		Slot* slot;
+		while (true) {
+			slot = &_slots[position & _mask];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) -
+				static_cast<intptr_t>(position);
+			if (difference == 0) {
+				if (_head.compare_exchange_weak(position, position + 1,
+						std::memory_order_relaxed))
+					break;
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = _head.load(std::memory_order_relaxed);
+			}
+		}
+		slot->value = std::move(value);
+		slot->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*! Pops an element unless the queue is empty. */
+	bool dequeue(T& value) {
+		size_t position = _tail.load(std::memory_order_relaxed);
+		Slot* slot;
+		while (true) {
+			slot = &_slots[position & _mask];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) -
+				static_cast<intptr_t>(position + 1);
+			if (difference == 0) {
+				if (_tail.compare_exchange_weak(position, position + 1,
+						std::memory_order_relaxed))
+					break;
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = _tail.load(std::memory_order_relaxed);
+			}
+		}
+		value = std::move(slot->value);
+		slot->sequence.store(position + _mask + 1, std::memory_order_release);
+		return true;
+	}
+
+public:
+	/*!
+	 * Constructs an empty queue.
+	 * @param[in] capacity Largest number of elements, rounded up to a power of
+	 * two.
+	 */
+	explicit RingBuffer(size_t capacity) : _head(0), _tail(0), _sleepers(0) {
+		size_t size = 2;
+		while (size < capacity)
+			size *= 2;
+		_slots.reset(new Slot[size]);
+		_mask = size - 1;
+		for (size_t i = 0; i < size; i++)
+			_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	/*!
+	 * Pushes an element unless the queue is full.
+	 * @param[in] value Element, which is moved from only if it is pushed.
+	 * @return True if the element was pushed.
+	 */
+	inline bool try_push(T&& value) {
+		if (!enqueue(value))
+			return false;
+		wake();
+		return true;
+	}
+
+	/*!
+	 * Pops the oldest element unless the queue is empty.
+	 * @param[out] value Element.
+	 * @return True if an element was popped.
+	 */
+	inline bool try_pop(T& value) {
+		if (!dequeue(value))
+			return false;
+		wake();
+		return true;
+	}
+
+	/*!
+	 * Pushes an element, blocking while the queue is full.
+	 * @param[in] value Element.
+	 */
+	inline void push(T&& value) {
+		retry([this, &value]() { return enqueue(value); });
+		wake();
+	}
+
+	/*!
+	 * Pops the oldest element, blocking while the queue is empty.
+	 * @return Element.
+	 */
+	inline T pop() {
+		T value;
+		retry([this, &value]() { return dequeue(value); });
+		wake();
+		return value;
+	}
+
+	/*!
+	 * Pushes every element of a batch in order, blocking while the queue is
+	 * full, and clears the batch.
+	 * @param[in, out] batch Elements.
+	 */
+	void push(std::vector<T>& batch) {
+		for (auto& value : batch) {
+			if (!enqueue(value)) {
+				wake();
+				retry([this, &value]() { return enqueue(value); });
+			}
+		}
+		wake();
+		batch.clear();
+	}
+
+	/*!
+	 * Pops at least one and at most the specified number of elements,
+	 * blocking only while the queue is empty.
+	 * @param[out] batch Vector the elements are appended to.
+	 * @param[in] count Largest number of elements.
+	 * @return Number of elements popped.
+	 */
+	size_t pop(std::vector<T>& batch, size_t count) {
+		T value;
+		retry([this, &value]() { return dequeue(value); });
+		batch.push_back(std::move(value));
+		size_t popped = 1;
+		while (popped < count && dequeue(value)) {
+			batch.push_back(std::move(value));
+			popped++;
+		}
+		wake();
+		return popped;
+	}
+
+	/*!
+	 * Returns the number of elements, which other threads may change at any
+	 * time.
+	 * @return Approximate number of elements.
+	 */
+	inline size_t size() const {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		size_t head = _head.load(std::memory_order_relaxed);
+		return (head > tail) ? head - tail : 0;
+	}
+
+	/*! Returns the largest number of elements. */
+	inline size_t capacity() const { return _mask + 1; }
+};
+
+} // namespace chess
+
+#endif // AI_RING_BUFFER_H
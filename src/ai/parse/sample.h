@@ -4,6 +4,7 @@
 #include "core/move.h"
 #include <vector>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
 namespace chess {
 
@@ -12,10 +13,17 @@ namespace chess {
  * be saved and recovered from disk, while preserving all game information.
  * Samples are immutable; this prevents malicious code from tampering with the
  * training samples. Once a sample has been created, it can never be modified.
- * Samples can be saved to and from disk using boost serialization.
+ * Samples are saved to and loaded from disk in the binary sample format (see
+ * SampleWriter and SampleReader); boost serialization remains only to compare
+ * the two formats.
+ *
+ * Samples generated by self-play also record the score the engine gave to the
+ * position before each move, in centipawns from white's perspective. Samples
+ * parsed from PGN carry no scores.
  */
 struct Sample {
 	std::vector<Move> moves; 	
+	std::vector<int> scores;
 	int result; 				
 	int white_elo; 			
 	int black_elo; 			
@@ -37,9 +45,14 @@ namespace serialization {
 template <typename Archive>
 inline void serialize(Archive& ar, chess::Sample& samp, const unsigned int ver) {
 	ar & samp.moves & samp.result & samp.white_elo & samp.black_elo;
+	if (ver > 0)
+		ar & samp.scores;
 }
 
 } // namespace serialization
 } // namespace boost	
 
+// Version 1 added scores; archives of version 0 load with no scores.
+BOOST_CLASS_VERSION(chess::Sample, 1)
+
 #endif // AI_SAMPLE_H
@@ -0,0 +1,91 @@
+#include "sample_dataset.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace chess {
+
+namespace {
+
+/*! First line of every manifest. */
+const char kHeader[] = "CHSM 1";
+
+} // namespace
+
+SampleDataset::SampleDataset(const std::string& manifest) : _size(0),
+		_next(0), _read(0) {
+	std::ifstream in(manifest);
+	std::string line;
+	if (!in || !std::getline(in, line) || line != kHeader)
+		throw std::runtime_error("cannot read manifest " + manifest);
+
+	size_t slash = manifest.rfind('/');
+	_directory = (slash == std::string::npos) ? "" :
+		manifest.substr(0, slash + 1);
+	while (std::getline(in, line)) {
+		if (line.empty())
+			continue;
+		std::istringstream fields(line);
+		Shard shard;
+		if (!(fields >> shard.count) || !(fields >> std::ws) ||
+				!std::getline(fields, shard.path) || shard.path.empty())
+			throw std::runtime_error("malformed manifest " + manifest);
+		_size += shard.count;
+		_shards.push_back(shard);
+	}
+}
+
+bool SampleDataset::open() {
+	if (_reader && _read != _shards[_next - 1].count)
+		throw std::runtime_error("shard " + _shards[_next - 1].path + " holds " +
+			std::to_string(_read) + " samples, not " +
+			std::to_string(_shards[_next - 1].count));
+	_reader.reset();
+	_file.close();
+	if (_next == _shards.size())
+		return false;
+
+	std::string path = _directory + _shards[_next++].path;
+	_file.clear();
+	_file.open(path, std::ios::binary);
+	if (!_file)
+		throw std::runtime_error("cannot open shard " + path);
+	_reader.reset(new SampleReader(_file));
+	_read = 0;
+	return true;
+}
+
+bool SampleDataset::read(Sample& sample) {
+	while (!_reader || !_reader->read(sample))
+		if (!open())
+			return false;
+	_read++;
+	return true;
+}
+
+void SampleDataset::rewind() {
+	_reader.reset();
+	_file.close();
+	_next = 0;
+	_read = 0;
+}
+
+uint64_t SampleDataset::merge(std::ostream& out) {
+	SampleWriter writer(out);
+	Sample sample;
+	while (read(sample))
+		writer.write(sample);
+	return writer.count();
+}
+
+void SampleDataset::save(const std::string& manifest,
+		const std::vector<Shard>& shards) {
+	std::ofstream out(manifest);
+	out << kHeader << "\n";
+	for (const auto& shard : shards)
+		out << shard.count << " " << shard.path << "\n";
+	if (!out)
+		throw std::runtime_error("cannot write manifest " + manifest);
+}
+
+} // namespace chess
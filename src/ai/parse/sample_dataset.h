@@ -0,0 +1,96 @@
+#ifndef AI_SAMPLE_DATASET_H
+#define AI_SAMPLE_DATASET_H
+
+#include "sample_file.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * A sample file that is one part of a dataset.
+ */
+struct Shard {
+	std::string path;
+	uint64_t count;
+};
+
+/*!
+ * This class reads a set of sample files, or shards, as a single dataset.
+ * The parser writes one shard per worker so that its workers never contend
+ * for an output, and lists the shards in a manifest: a text file whose first
+ * line is "CHSM 1" and whose every other line is the number of samples of a
+ * shard followed by its path, relative to the manifest. Samples are read one
+ * shard after another, in the order of the manifest; the order of samples
+ * across shards carries no meaning. This class is not thread-safe.
+ */
+class SampleDataset {
+private:
+	std::string _directory;
+	std::vector<Shard> _shards;
+	uint64_t _size;
+	size_t _next;
+	uint64_t _read;
+	std::ifstream _file;
+	std::unique_ptr<SampleReader> _reader;
+
+	/*!
+	 * Opens the next shard.
+	 * @return False if every shard has been read.
+	 */
+	bool open();
+
+public:
+	/*!
+	 * Reads the manifest of a dataset; the shards are opened as they are read.
+	 * @param[in] manifest Path of the manifest.
+	 * @throws std::runtime_error if the manifest cannot be read or is
+	 * malformed.
+	 */
+	explicit SampleDataset(const std::string& manifest);
+
+	/*!
+	 * Reads the next sample of the dataset.
+	 * @param[out] sample Next sample.
+	 * @return False once every shard has been read.
+	 * @throws std::runtime_error if a shard cannot be read, or holds a
+	 * different number of samples than the manifest lists.
+	 */
+	bool read(Sample& sample);
+
+	/*!
+	 * Starts reading again from the first shard.
+	 */
+	void rewind();
+
+	/*!
+	 * Writes every remaining sample of the dataset into a single sample file.
+	 * @param[in] out Output stream, opened in binary mode.
+	 * @return Number of samples written.
+	 */
+	uint64_t merge(std::ostream& out);
+
+	/*! Returns the shards of the dataset. */
+	inline const std::vector<Shard>& shards() const { return _shards; }
+
+	/*! Returns the number of samples in the dataset. */
+	inline uint64_t size() const { return _size; }
+
+	/*!
+	 * Writes a manifest.
+	 * @param[in] manifest Path of the manifest.
+	 * @param[in] shards Shards, whose paths are relative to the manifest.
+	 * @throws std::runtime_error if the manifest cannot be written.
+	 */
+	static void save(const std::string& manifest,
+		const std::vector<Shard>& shards);
+};
+
+} // namespace chess
+
+#endif // AI_SAMPLE_DATASET_H
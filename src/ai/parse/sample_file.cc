@@ -0,0 +1,132 @@
+#include "sample_file.h"
+
+#include "ai/struct/board.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace chess {
+
+namespace {
+
+/*! Size of the fixed part of a record, before its moves. */
+const size_t kRecordHeader = 8;
+
+/*! Size of the largest record: every move and every score it can count. */
+const size_t kMaxRecord = kRecordHeader + 2 * 0xFFFF + 2 + 2 * 0xFFFF;
+
+inline void put16(std::string& out, uint32_t value) {
+	out += static_cast<char>(value & 0xFF);
+	out += static_cast<char>((value >> 8) & 0xFF);
+}
+
+inline void put32(std::string& out, uint32_t value) {
+	put16(out, value & 0xFFFF);
+	put16(out, value >> 16);
+}
+
+inline uint32_t get16(const char* in) {
+	return static_cast<uint8_t>(in[0]) | (static_cast<uint8_t>(in[1]) << 8);
+}
+
+inline uint32_t get32(const char* in) {
+	return get16(in) | (get16(in + 2) << 16);
+}
+
+} // namespace
+
+const char SampleWriter::kMagic[4] = {'C', 'H', 'S', 'P'};
+const uint32_t SampleWriter::kVersion;
+
+SampleWriter::SampleWriter(std::ostream& out) : _out(out), _count(0) {
+	std::string header(kMagic, sizeof(kMagic));
+	put32(header, kVersion);
+	_out.write(header.data(), header.size());
+}
+
+void SampleWriter::write(const Sample& sample) {
+	if (sample.moves.size() > 0xFFFF || sample.scores.size() > 0xFFFF)
+		throw std::invalid_argument("sample too long");
+
+	// The length is filled in once the record is complete
+	_record.assign(4, '\0');
+	_record += static_cast<char>(sample.result);
+	_record += static_cast<char>(sample.scores.empty() ? 0 : 1);
+	put16(_record, std::min(std::max(sample.white_elo, 0), 0xFFFF));
+	put16(_record, std::min(std::max(sample.black_elo, 0), 0xFFFF));
+	put16(_record, sample.moves.size());
+	for (const auto& move : sample.moves)
+		put16(_record, pack(move));
+	if (!sample.scores.empty()) {
+		put16(_record, sample.scores.size());
+		for (int score : sample.scores)
+			put16(_record, static_cast<uint16_t>(static_cast<int16_t>(
+				std::min(std::max(score, -32768), 32767))));
+	}
+
+	uint32_t length = static_cast<uint32_t>(_record.size() - 4);
+	for (int i = 0; i < 4; i++)
+		_record[i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+	_out.write(_record.data(), _record.size());
+	_count++;
+}
+
+SampleReader::SampleReader(std::istream& in) : _in(in), _count(0) {
+	char header[8];
+	if (!_in.read(header, sizeof(header)) ||
+			std::memcmp(header, SampleWriter::kMagic, 4) != 0)
+		throw std::runtime_error("not a sample file");
+	if (get32(header + 4) != SampleWriter::kVersion)
+		throw std::runtime_error("unsupported sample file version " +
+			std::to_string(get32(header + 4)));
+}
+
+bool SampleReader::read(Sample& sample) {
+	char prefix[4];
+	if (!_in.read(prefix, sizeof(prefix))) {
+		if (_in.gcount())
+			throw std::runtime_error("truncated sample file");
+		return false;
+	}
+
+	// The length is checked before the record is allocated, so that a corrupt
+	// prefix cannot claim gigabytes
+	uint32_t length = get32(prefix);
+	if (length < kRecordHeader || length > kMaxRecord)
+		throw std::runtime_error("malformed sample record");
+	_record.resize(length);
+	if (!_in.read(&_record[0], length))
+		throw std::runtime_error("truncated sample file");
+
+	const char* record = _record.data();
+	size_t moves = get16(record + 6);
+	bool scores = record[1] & 1;
+	size_t expected = kRecordHeader + 2 * moves;
+	if (expected + (scores ? 2 : 0) > length)
+		throw std::runtime_error("malformed sample record");
+	size_t count = scores ? get16(record + expected) : 0;
+	if (length != expected + (scores ? 2 + 2 * count : 0))
+		throw std::runtime_error("malformed sample record");
+
+	sample.result = static_cast<int8_t>(record[0]);
+	sample.white_elo = static_cast<int>(get16(record + 2));
+	sample.black_elo = static_cast<int>(get16(record + 4));
+	sample.moves.clear();
+	sample.moves.reserve(moves);
+	for (size_t i = 0; i < moves; i++)
+		sample.moves.push_back(unpack(static_cast<PackedMove>(
+			get16(record + kRecordHeader + 2 * i))));
+	sample.scores.clear();
+	for (size_t i = 0; i < count; i++)
+		sample.scores.push_back(static_cast<int16_t>(
+			get16(record + expected + 2 + 2 * i)));
+	_count++;
+	return true;
+}
+
+bool SampleReader::matches(std::istream& in) {
+	return in.peek() == SampleWriter::kMagic[0];
+}
+
+} // namespace chess
@@ -0,0 +1,99 @@
+#ifndef AI_SAMPLE_FILE_H
+#define AI_SAMPLE_FILE_H
+
+#include "sample.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace chess {
+
+/*!
+ * This class writes samples in the compact binary sample format, which takes
+ * a fraction of the space of a boost text archive and reads back many times
+ * faster. A file begins with a header of the magic "CHSP" and a 32 bit
+ * version, followed by one record per sample. Every number is little-endian,
+ * whatever the machine, so files can be moved between machines.
+ *
+ * A record is prefixed by its length in bytes (32 bits), so that a reader can
+ * skip it or detect that it is truncated, and holds, in order: the result
+ * (8 bits, signed), flags (8 bits; bit 0 marks scores), the ratings of white
+ * and black (16 bits each), the number of moves (16 bits), the moves packed
+ * as PackedMove (16 bits each), and if flagged the number of scores (16 bits)
+ * and the scores (16 bits each, signed). This class is not thread-safe.
+ */
+class SampleWriter {
+public:
+	/*! Identifies sample files. */
+	static const char kMagic[4];
+
+	/*! Version of the sample format. */
+	static const uint32_t kVersion = 1;
+
+private:
+	std::ostream& _out;
+	std::string _record;
+	uint64_t _count;
+
+public:
+	/*!
+	 * Constructs a writer and writes the header of the file.
+	 * @param[in] out Output stream, opened in binary mode.
+	 */
+	explicit SampleWriter(std::ostream& out);
+
+	/*!
+	 * Writes a sample. Ratings are clamped to 16 bits and scores to the
+	 * range of a signed 16 bit integer.
+	 * @param[in] sample Sample to write.
+	 * @throws std::invalid_argument if the sample has 65536 or more moves.
+	 */
+	void write(const Sample& sample);
+
+	/*! Returns the number of samples written. */
+	inline uint64_t count() const { return _count; }
+};
+
+/*!
+ * This class reads samples written by SampleWriter.
+ */
+class SampleReader {
+private:
+	std::istream& _in;
+	std::string _record;
+	uint64_t _count;
+
+public:
+	/*!
+	 * Constructs a reader and reads the header of the file.
+	 * @param[in] in Input stream, opened in binary mode.
+	 * @throws std::runtime_error if the stream is not a sample file of a
+	 * supported version.
+	 */
+	explicit SampleReader(std::istream& in);
+
+	/*!
+	 * Reads the next sample.
+	 * @param[out] sample Next sample.
+	 * @return False once the file is exhausted.
+	 * @throws std::runtime_error if the record is truncated or malformed.
+	 */
+	bool read(Sample& sample);
+
+	/*! Returns the number of samples read. */
+	inline uint64_t count() const { return _count; }
+
+	/*!
+	 * Returns true if the stream appears to hold a sample file, rather than a
+	 * boost archive, without consuming any of it.
+	 * @param[in] in Input stream.
+	 * @return True if the stream begins like a sample file.
+	 */
+	static bool matches(std::istream& in);
+};
+
+} // namespace chess
+
+#endif // AI_SAMPLE_FILE_H
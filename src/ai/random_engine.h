@@ -3,6 +3,8 @@
 
 #include "engine.h"
 #include "core/move.h"
+#include "struct/board.h"
+#include "search/time_manager.h"
 
 #include <set>
 #include <random>
@@ -28,15 +30,49 @@ public:
 	RandomEngine() : _prng(std::random_device()()) {}
 
 	/*!
-	 * Selects a move from the set of moves uniformly at random.
+	 * Constructs a random engine with a fixed seed, so that its choices can be
+	 * reproduced.
+	 * @param[in] seed Seed of the pseudo-random number generator.
+	 */
+	explicit RandomEngine(uint32_t seed) : _prng(seed) {}
+
+	/*!
+	 * Selects a move from the set of moves uniformly at random. Sets cannot be
+	 * indexed, so this takes time linear in the number of moves.
 	 * @return Randomly selected move.
 	 */
-	inline Move select(std::set<Move> moves) const override {
-		std::uniform_int_distribution<> dis(0, moves.size() - 1);
-		std::set<int>::const_iterator it(moves.begin());
-  		std::advance(it, dis(_prng));	
+	inline Move select(const std::set<Move>& moves) override {
+		std::uniform_int_distribution<size_t> dis(0, moves.size() - 1);
+		std::set<Move>::const_iterator it(moves.begin());
+		std::advance(it, dis(_prng));
 		return *it;
 	}
+
+	/*!
+	 * Selects a move from the list of moves uniformly at random, in constant
+	 * time.
+	 * @param[in] moves Candidate moves.
+	 * @return Randomly selected move, or zero if there were no candidates.
+	 */
+	inline PackedMove select(const MoveList& moves) {
+		if (!moves.size)
+			return 0;
+		std::uniform_int_distribution<int> dis(0, moves.size - 1);
+		return moves.moves[dis(_prng)];
+	}
+
+	/*!
+	 * Selects a move from the list of moves uniformly at random, regardless of
+	 * the position and limits.
+	 * @param[in] board Position, which is ignored.
+	 * @param[in] moves Candidate moves.
+	 * @param[in] limits Search constraints, which are ignored.
+	 * @return Randomly selected move, or zero if there were no candidates.
+	 */
+	inline PackedMove select(Board& board, const MoveList& moves,
+			const Limits& limits) override {
+		return select(moves);
+	}
 };
 
 } // namespace chess
@@ -0,0 +1,38 @@
+#include "playout.h"
+
+#include <algorithm>
+
+namespace chess {
+
+const int Playout::kUnfinished;
+
+int Playout::play(Board& board, int limit) {
+	_plies = 0;
+	limit = std::min(limit, Board::kMaxPly - board.ply() - 1);
+
+	while (_plies < limit) {
+		if (board.is_draw() || board.is_insufficient())
+			return 0;
+
+		// Draw moves until one is legal, removing each illegal one so that it
+		// is not drawn again
+		MoveList moves;
+		board.moves(moves);
+		bool moved = false;
+		while (moves.size && !moved) {
+			int i = next() % moves.size;
+			moved = board.make(moves[i]);
+			moves[i] = moves[--moves.size];
+		}
+
+		if (!moved) {
+			if (!board.in_check())
+				return 0;
+			return (board.turn() == kWhite) ? -1 : 1;
+		}
+		_plies++;
+	}
+	return kUnfinished;
+}
+
+} // namespace chess
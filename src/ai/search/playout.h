@@ -0,0 +1,79 @@
+#ifndef AI_PLAYOUT_H
+#define AI_PLAYOUT_H
+
+#include "ai/struct/board.h"
+
+#include <cstdint>
+
+namespace chess {
+
+/*!
+ * This class plays random games. Playouts are the inner loop of Monte Carlo
+ * tree search and the fastest way to measure raw move generation throughput,
+ * so the loop is specialized for speed: it never allocates, and instead of
+ * generating every legal move each ply (which requires making and unmaking
+ * each of them), it draws pseudo-legal moves at random until one turns out to
+ * be legal. Discarding illegal draws keeps the choice uniform over the legal
+ * moves, and since most pseudo-legal moves are legal, a ply usually costs a
+ * single make(). Random numbers come from a xorshift generator, whose entire
+ * state is a single word.
+ */
+class Playout {
+public:
+	/*! Result of a playout that reached its ply limit before the game ended. */
+	static const int kUnfinished = 2;
+
+private:
+	uint64_t _state;
+	int _plies;
+
+	/*!
+	 * Returns the next pseudo-random number (xorshift64*).
+	 * @return Pseudo-random number.
+	 */
+	inline uint32_t next() {
+		_state ^= _state >> 12;
+		_state ^= _state << 25;
+		_state ^= _state >> 27;
+		return static_cast<uint32_t>((_state * 2685821657736338717ULL) >> 32);
+	}
+
+public:
+	/*!
+	 * Constructs a playout generator with the specified seed.
+	 * @param[in] seed Seed of the pseudo-random number generator.
+	 */
+	explicit Playout(uint64_t seed) : _state(seed ? seed : 1), _plies(0) {}
+
+	/*!
+	 * Plays uniformly random legal moves until the game ends or the limit is
+	 * reached. The game ends at checkmate, stalemate, the fifty move rule, the
+	 * first repetition of a position or when neither side has enough material
+	 * to mate. The board is left at the final position; see rewind().
+	 * @param[in, out] board Position to play out.
+	 * @param[in] limit Maximum number of plies to play.
+	 * @return 1 if white won, -1 if black won, 0 if drawn, or kUnfinished.
+	 */
+	int play(Board& board, int limit = Board::kMaxPly);
+
+	/*!
+	 * Undoes the moves of the last playout.
+	 * @param[in, out] board Board the playout was played on.
+	 */
+	inline void rewind(Board& board) {
+		for (; _plies > 0; _plies--)
+			board.undo();
+	}
+
+	/*!
+	 * Returns the number of plies played by the last playout.
+	 * @return Number of plies.
+	 */
+	inline int plies() const {
+		return _plies;
+	}
+};
+
+} // namespace chess
+
+#endif // AI_PLAYOUT_H
@@ -0,0 +1,64 @@
+#include "time_manager.h"
+
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+/*! Moves assumed to remain in sudden death time controls. */
+const int kMovesToGo = 30;
+
+/*! Smallest amount of time ever allotted to a move. */
+const int64_t kMinimum = 10;
+
+} // namespace
+
+void TimeManager::start(const Limits& limits) {
+	_start = Clock::now();
+	_nodes = limits.nodes;
+	_aborted = false;
+	_ponder = limits.ponder;
+
+	if (limits.move_time) {
+		_soft = _hard = std::max(kMinimum, limits.move_time - kOverhead);
+	} else if (limits.time && !limits.infinite) {
+		int64_t left = std::max(kMinimum, limits.time - kOverhead);
+		int moves = limits.moves_to_go ? limits.moves_to_go : kMovesToGo;
+		_soft = left / moves + limits.increment * 3 / 4;
+		_hard = std::min(left / 3 + limits.increment, _soft * 5);
+		_soft = std::max(kMinimum, std::min(_soft, _hard));
+		_hard = std::max(_soft, std::min(_hard, left));
+	} else {
+		_soft = _hard = -1;
+	}
+
+	_next = _nodes ? std::min(kCheckInterval, _nodes) : kCheckInterval;
+}
+
+void TimeManager::poll(uint64_t nodes) {
+	_next = nodes + kCheckInterval;
+	if (_nodes)
+		_next = std::min(_next, _nodes);
+
+	// The expected reply was played. Time spent pondering counts towards the
+	// allotment, so a search that has already used it returns immediately.
+	if (_ponder && _hit.load(std::memory_order_relaxed)) {
+		_ponder = false;
+		if (_soft >= 0 && elapsed() >= _soft)
+			_aborted = true;
+	}
+
+	if (_stop.load(std::memory_order_relaxed) ||
+			(_nodes && nodes >= _nodes) ||
+			(!_ponder && _hard >= 0 && elapsed() >= _hard))
+		_aborted = true;
+}
+
+bool TimeManager::deepen() const {
+	if (_aborted || _stop.load(std::memory_order_relaxed))
+		return false;
+	return pondering() || _soft < 0 || elapsed() < _soft;
+}
+
+} // namespace chess
@@ -0,0 +1,178 @@
+#ifndef AI_TIME_MANAGER_H
+#define AI_TIME_MANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace chess {
+
+/*!
+ * Describes the constraints placed on a single search. A value of zero means
+ * that the corresponding constraint does not apply. Times are in milliseconds
+ * and refer to the clock of the side to move.
+ */
+struct Limits {
+	int64_t time;
+	int64_t increment;
+	int moves_to_go;
+	int64_t move_time;
+	uint64_t nodes;
+	int depth;
+	bool infinite;
+	bool ponder;
+
+	Limits() : time(0), increment(0), moves_to_go(0), move_time(0), nodes(0),
+		depth(0), infinite(false), ponder(false) {}
+
+	/*!
+	 * Returns true if the search is bounded by something other than depth, in
+	 * which case it should deepen until the bound is reached.
+	 * @return True if limited by time, nodes or an external stop.
+	 */
+	inline bool open_ended() const {
+		return time || move_time || nodes || infinite || ponder;
+	}
+};
+
+/*!
+ * This class decides how long a search may run and tells it when to stop. Each
+ * search is allotted a soft limit, after which no new iteration is started, and
+ * a hard limit, after which the search is aborted mid-iteration. Reading the
+ * clock is comparatively expensive, so the search only polls it every
+ * kCheckInterval nodes. Searches may also be stopped by a node limit or by any
+ * other thread calling stop().
+ *
+ * A search may also ponder: search the position after the opponent's expected
+ * reply on the opponent's time. Its limits are ignored until ponderhit()
+ * reports that the reply was played, after which they apply as if the search
+ * had started when pondering did. stop(), ponderhit() and reset() are the
+ * only thread-safe methods.
+ */
+class TimeManager {
+public:
+	/*! Number of nodes searched between polls of the clock. */
+	static const uint64_t kCheckInterval = 2048;
+
+	/*! Time reserved per move for communication and bookkeeping. */
+	static const int64_t kOverhead = 30;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point _start;
+	int64_t _soft;
+	int64_t _hard;
+	uint64_t _nodes;
+	uint64_t _next;
+	bool _aborted;
+	bool _ponder;
+	std::atomic<bool> _stop;
+	std::atomic<bool> _hit;
+
+	/*!
+	 * Reads the clock and the stop flag and decides whether to abort.
+	 * @param[in] nodes Nodes searched so far.
+	 */
+	void poll(uint64_t nodes);
+
+public:
+	/*!
+	 * Constructs a time manager that imposes no limits.
+	 */
+	TimeManager() : _soft(-1), _hard(-1), _nodes(0), _next(kCheckInterval),
+		_aborted(false), _ponder(false), _stop(false), _hit(false) {}
+
+	/*!
+	 * Starts the clock for a new search and allocates its time. A fixed move
+	 * time is used as is. Otherwise the remaining clock is divided evenly over
+	 * the moves left until the next time control (or an estimate of them) and
+	 * most of the increment is added. The hard limit allows a search to
+	 * overrun its allotment several times over to finish an iteration, but
+	 * never to spend more than a fraction of the remaining clock.
+	 * @param[in] limits Search constraints.
+	 */
+	void start(const Limits& limits);
+
+	/*!
+	 * Returns true if the search must stop immediately. This is called at
+	 * every node, and only polls the clock every kCheckInterval nodes.
+	 * @param[in] nodes Nodes searched so far.
+	 * @return True if the search should abort.
+	 */
+	inline bool check(uint64_t nodes) {
+		if (nodes >= _next)
+			poll(nodes);
+		return _aborted;
+	}
+
+	/*!
+	 * Returns true if there is enough time left to start another iteration.
+	 * @return True if the search should deepen.
+	 */
+	bool deepen() const;
+
+	/*!
+	 * Requests that the current search stop as soon as possible. This may be
+	 * called from any thread; the request is honored at the next poll. If no
+	 * search is running, the next search stops immediately, so that a stop
+	 * issued just before a search starts is never lost.
+	 */
+	inline void stop() {
+		_stop.store(true, std::memory_order_relaxed);
+	}
+
+	/*!
+	 * Reports that the opponent played the expected reply, so that a
+	 * pondering search becomes subject to its limits. May be called from any
+	 * thread; like stop(), it is never lost if issued before the search
+	 * starts.
+	 */
+	inline void ponderhit() {
+		_hit.store(true, std::memory_order_relaxed);
+	}
+
+	/*!
+	 * Withdraws any pending stop request or ponder hit. Callers that control
+	 * searches from another thread should reset before starting each search.
+	 */
+	inline void reset() {
+		_stop.store(false, std::memory_order_relaxed);
+		_hit.store(false, std::memory_order_relaxed);
+	}
+
+	/*!
+	 * Returns true if the search is pondering and its limits do not apply yet.
+	 * @return True if pondering.
+	 */
+	inline bool pondering() const {
+		return _ponder && !_hit.load(std::memory_order_relaxed);
+	}
+
+	/*!
+	 * Returns true if the current search has been aborted.
+	 * @return True if aborted.
+	 */
+	inline bool aborted() const {
+		return _aborted;
+	}
+
+	/*!
+	 * Returns the number of milliseconds since the search started.
+	 * @return Elapsed time.
+	 */
+	inline int64_t elapsed() const {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			Clock::now() - _start).count();
+	}
+
+	/*! Returns the soft limit in milliseconds, or -1 if unlimited. */
+	inline int64_t soft() const { return _soft; }
+
+	/*! Returns the hard limit in milliseconds, or -1 if unlimited. */
+	inline int64_t hard() const { return _hard; }
+};
+
+} // namespace chess
+
+#endif // AI_TIME_MANAGER_H
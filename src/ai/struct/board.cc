@@ -0,0 +1,634 @@
+#include "board.h"
+#include "ai/eval/evaluation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <random>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace chess {
+
+namespace {
+
+/*!
+ * Precomputed attack and hashing tables shared by all boards. The tables are
+ * built once during static initialization; the Zobrist keys use a fixed seed so
+ * that hashes are reproducible across runs and machines (opening books and
+ * tablebases are keyed by them).
+ */
+struct Tables {
+	int knight[64][9];
+	int king[64][9];
+	int rays[64][8][8];
+	uint8_t castle_mask[64];
+
+	uint64_t piece_keys[16][64];
+	uint64_t castle_keys[16];
+	uint64_t enpassant_keys[8];
+	uint64_t turn_key;
+
+	Tables() {
+		static const int kKnightDx[] = {-2, -2, -1, -1, 1, 1, 2, 2};
+		static const int kKnightDy[] = {-1, 1, -2, 2, -2, 2, -1, 1};
+		static const int kRayDx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+		static const int kRayDy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+
+		for (int sq = 0; sq < 64; sq++) {
+			int x = sq / 8, y = sq % 8, n = 0;
+
+			// Knight targets, terminated by -1
+			for (int i = 0; i < 8; i++)
+				if (valid(x + kKnightDx[i], y + kKnightDy[i]))
+					knight[sq][n++] = (x + kKnightDx[i]) * 8 + y + kKnightDy[i];
+			knight[sq][n] = -1;
+
+			// King targets and sliding rays, both terminated by -1. Rays 0-3
+			// are orthogonal (rook) and rays 4-7 are diagonal (bishop).
+			n = 0;
+			for (int d = 0; d < 8; d++) {
+				if (valid(x + kRayDx[d], y + kRayDy[d]))
+					king[sq][n++] = (x + kRayDx[d]) * 8 + y + kRayDy[d];
+
+				int len = 0;
+				for (int k = 1; valid(x + k * kRayDx[d], y + k * kRayDy[d]); k++)
+					rays[sq][d][len++] = (x + k * kRayDx[d]) * 8 + y + k * kRayDy[d];
+				rays[sq][d][len] = -1;
+			}
+			king[sq][n] = -1;
+
+			castle_mask[sq] = 15;
+		}
+
+		// Moving to or from a king or rook home square forfeits rights
+		castle_mask[60] = 15 & ~3;
+		castle_mask[63] = 15 & ~1;
+		castle_mask[56] = 15 & ~2;
+		castle_mask[4]  = 15 & ~12;
+		castle_mask[7]  = 15 & ~4;
+		castle_mask[0]  = 15 & ~8;
+
+		std::mt19937_64 prng(0x5eed);
+		for (int p = 0; p < 16; p++)
+			for (int sq = 0; sq < 64; sq++)
+				piece_keys[p][sq] = (p & 7) ? prng() : 0;
+		castle_keys[0] = 0;
+		for (int i = 1; i < 16; i++)
+			castle_keys[i] = prng();
+		for (int i = 0; i < 8; i++)
+			enpassant_keys[i] = prng();
+		turn_key = prng();
+	}
+
+	static bool valid(int x, int y) {
+		return x >= 0 && x < 8 && y >= 0 && y < 8;
+	}
+};
+
+const Tables tables;
+
+const MoveType kPromotions[] = {
+	MoveType::kPromoteQueen, MoveType::kPromoteKnight,
+	MoveType::kPromoteRook, MoveType::kPromoteBishop
+};
+
+} // namespace
+
+std::string notation(PackedMove move) {
+	if (!move)
+		return "0000";
+
+	Move full = unpack(move);
+	std::string text;
+	text += full.cur.file();
+	text += static_cast<char>('0' + full.cur.rank());
+	text += full.nxt.file();
+	text += static_cast<char>('0' + full.nxt.rank());
+
+	if (full.type == MoveType::kPromoteQueen) text += 'q';
+	else if (full.type == MoveType::kPromoteKnight) text += 'n';
+	else if (full.type == MoveType::kPromoteBishop) text += 'b';
+	else if (full.type == MoveType::kPromoteRook) text += 'r';
+	return text;
+}
+
+const int Board::kMaxPly;
+
+Board::Board() : _turn(kWhite), _castling(15), _enpassant(-1), _halfmove(0),
+		_key(0), _pawn_key(0), _midgame(0), _endgame(0), _phase(0), _ply(0) {
+	static const int kBackRank[] = {
+		kRook, kKnight, kBishop, kQueen, kKing, kBishop, kKnight, kRook};
+
+	std::memset(_squares, 0, sizeof(_squares));
+	std::memset(_count, 0, sizeof(_count));
+	for (int y = 0; y < 8; y++) {
+		put(y, (kBlack << 3) | kBackRank[y]);
+		put(8 + y, (kBlack << 3) | kPawn);
+		put(48 + y, kPawn);
+		put(56 + y, kBackRank[y]);
+	}
+
+	_key ^= tables.castle_keys[_castling];
+}
+
+Board::Board(const std::vector<Move>& history) : Board() {
+	for (auto move : history)
+		make(pack(move));
+}
+
+Board::Board(const std::string& fen) : _turn(kWhite), _castling(0),
+		_enpassant(-1), _halfmove(0), _key(0), _pawn_key(0), _midgame(0), _endgame(0),
+		_phase(0), _ply(0) {
+	static const std::string kPieces = " PNBRQK  pnbrqk";
+
+	std::memset(_squares, 0, sizeof(_squares));
+	std::memset(_count, 0, sizeof(_count));
+	_kings[kWhite] = _kings[kBlack] = -1;
+
+	std::istringstream in(fen);
+	std::string placement, turn, castling = "-", enpassant = "-";
+	in >> placement >> turn >> castling >> enpassant >> _halfmove;
+
+	// Piece placement is listed rank by rank starting from a8, which is the
+	// same order in which squares are numbered.
+	int sq = 0;
+	for (char c : placement) {
+		if (c == '/')
+			continue;
+		if (c >= '1' && c <= '8') {
+			sq += c - '0';
+		} else if (kPieces.find(c) != std::string::npos && c != ' ' && sq < 64) {
+			put(sq++, kPieces.find(c));
+		} else {
+			throw std::invalid_argument("invalid fen placement: " + fen);
+		}
+	}
+
+	if (sq != 64 || _kings[kWhite] < 0 || _kings[kBlack] < 0 ||
+			(turn != "w" && turn != "b"))
+		throw std::invalid_argument("invalid fen: " + fen);
+
+	_turn = (turn == "w") ? kWhite : kBlack;
+	for (char c : castling) {
+		if (c == 'K') _castling |= 1;
+		else if (c == 'Q') _castling |= 2;
+		else if (c == 'k') _castling |= 4;
+		else if (c == 'q') _castling |= 8;
+	}
+	if (enpassant.size() == 2)
+		_enpassant = Position(enpassant).x * 8 + Position(enpassant).y;
+
+	_key ^= tables.castle_keys[_castling];
+	if (_enpassant >= 0)
+		_key ^= tables.enpassant_keys[_enpassant & 7];
+	if (_turn == kBlack)
+		_key ^= tables.turn_key;
+}
+
+void Board::put(int sq, int piece) {
+	_squares[sq] = piece;
+	_count[piece]++;
+	_key ^= tables.piece_keys[piece][sq];
+	_midgame += chess::midgame(piece, sq);
+	_endgame += chess::endgame(piece, sq);
+	_phase += kPhaseWeights[kind(piece)];
+	if (kind(piece) == kPawn)
+		_pawn_key ^= tables.piece_keys[piece][sq];
+	else if (kind(piece) == kKing)
+		_kings[color(piece)] = sq;
+}
+
+int Board::remove(int sq) {
+	int piece = _squares[sq];
+	if (piece) {
+		_squares[sq] = kEmpty;
+		_count[piece]--;
+		_key ^= tables.piece_keys[piece][sq];
+		_midgame -= chess::midgame(piece, sq);
+		_endgame -= chess::endgame(piece, sq);
+		_phase -= kPhaseWeights[kind(piece)];
+		if (kind(piece) == kPawn)
+			_pawn_key ^= tables.piece_keys[piece][sq];
+	}
+	return piece;
+}
+
+bool Board::make(PackedMove move) {
+	if (full())
+		return false;
+	State& state = _states[_ply++];
+	state.key = _key;
+	state.move = move;
+	state.castling = _castling;
+	state.enpassant = _enpassant;
+	state.halfmove = _halfmove;
+
+	int src = from(move), dst = to(move);
+	MoveType flag = type(move);
+	int piece = remove(src);
+	int us = _turn, them = _turn ^ 1;
+
+	// Captured pieces are remembered so that undo can restore them
+	if (flag == MoveType::kEnpassant)
+		state.captured = remove((src & ~7) | (dst & 7));
+	else
+		state.captured = remove(dst);
+
+	// Handle compound moves
+	if (flag == MoveType::kCastleKingside)
+		put(dst - 1, remove(dst + 1));
+	else if (flag == MoveType::kCastleQueenside)
+		put(dst + 1, remove(dst - 2));
+	else if (flag == MoveType::kPromoteQueen)
+		piece = (us << 3) | kQueen;
+	else if (flag == MoveType::kPromoteKnight)
+		piece = (us << 3) | kKnight;
+	else if (flag == MoveType::kPromoteBishop)
+		piece = (us << 3) | kBishop;
+	else if (flag == MoveType::kPromoteRook)
+		piece = (us << 3) | kRook;
+	put(dst, piece);
+
+	// Update irreversible state
+	_key ^= tables.castle_keys[_castling];
+	_castling &= tables.castle_mask[src] & tables.castle_mask[dst];
+	_key ^= tables.castle_keys[_castling];
+
+	if (_enpassant >= 0)
+		_key ^= tables.enpassant_keys[_enpassant & 7];
+	_enpassant = -1;
+
+	// Only remember en passant squares that an enemy pawn could capture on;
+	// otherwise transpositions would hash differently for no reason.
+	if (kind(piece) == kPawn && (src - dst == 16 || dst - src == 16)) {
+		int enemy = (them << 3) | kPawn;
+		if (((dst & 7) > 0 && _squares[dst - 1] == enemy) ||
+				((dst & 7) < 7 && _squares[dst + 1] == enemy)) {
+			_enpassant = (src + dst) / 2;
+			_key ^= tables.enpassant_keys[_enpassant & 7];
+		}
+	}
+
+	_halfmove = (kind(piece) == kPawn || state.captured) ? 0 : _halfmove + 1;
+	_turn = them;
+	_key ^= tables.turn_key;
+
+	if (attacked(_kings[us], them)) {
+		undo();
+		return false;
+	}
+	return true;
+}
+
+void Board::undo() {
+	State& state = _states[--_ply];
+	PackedMove move = state.move;
+	int src = from(move), dst = to(move);
+	MoveType flag = type(move);
+	int us = _turn ^ 1;
+
+	int piece = remove(dst);
+	if (flag == MoveType::kPromoteQueen || flag == MoveType::kPromoteKnight ||
+			flag == MoveType::kPromoteBishop || flag == MoveType::kPromoteRook)
+		piece = (us << 3) | kPawn;
+	put(src, piece);
+
+	// Handle compound moves
+	if (flag == MoveType::kCastleKingside)
+		put(dst + 1, remove(dst - 1));
+	else if (flag == MoveType::kCastleQueenside)
+		put(dst - 2, remove(dst + 1));
+
+	if (state.captured) {
+		if (flag == MoveType::kEnpassant)
+			put((src & ~7) | (dst & 7), state.captured);
+		else
+			put(dst, state.captured);
+	}
+
+	_turn = us;
+	_castling = state.castling;
+	_enpassant = state.enpassant;
+	_halfmove = state.halfmove;
+	_key = state.key;
+}
+
+void Board::make_null() {
+	assert(!full());
+	State& state = _states[_ply++];
+	state.key = _key;
+	state.move = 0;
+	state.captured = kEmpty;
+	state.castling = _castling;
+	state.enpassant = _enpassant;
+	state.halfmove = _halfmove;
+
+	if (_enpassant >= 0)
+		_key ^= tables.enpassant_keys[_enpassant & 7];
+	_enpassant = -1;
+	_halfmove++;
+	_turn ^= 1;
+	_key ^= tables.turn_key;
+}
+
+void Board::undo_null() {
+	State& state = _states[--_ply];
+	_turn ^= 1;
+	_enpassant = state.enpassant;
+	_halfmove = state.halfmove;
+	_key = state.key;
+}
+
+bool Board::attacked(int sq, int by) const {
+	int base = by << 3;
+	int x = sq / 8, y = sq % 8;
+
+	// Pawns attack toward the opposing side of the board, so a white pawn
+	// attacking sq sits one row below (higher x) it.
+	int px = (by == kWhite) ? x + 1 : x - 1;
+	if (px >= 0 && px < 8) {
+		if (y > 0 && _squares[px * 8 + y - 1] == (base | kPawn))
+			return true;
+		if (y < 7 && _squares[px * 8 + y + 1] == (base | kPawn))
+			return true;
+	}
+
+	for (const int* t = tables.knight[sq]; *t >= 0; t++)
+		if (_squares[*t] == (base | kKnight))
+			return true;
+
+	for (const int* t = tables.king[sq]; *t >= 0; t++)
+		if (_squares[*t] == (base | kKing))
+			return true;
+
+	for (int d = 0; d < 8; d++) {
+		int slider = (d < 4) ? (base | kRook) : (base | kBishop);
+		for (const int* t = tables.rays[sq][d]; *t >= 0; t++) {
+			int piece = _squares[*t];
+			if (piece) {
+				if (piece == slider || piece == (base | kQueen))
+					return true;
+				break;
+			}
+		}
+	}
+
+	return false;
+}
+
+void Board::generate(MoveList& list, bool captures) const {
+	int us = _turn, them = _turn ^ 1;
+	int forward = (us == kWhite) ? -8 : 8;
+	int home = (us == kWhite) ? 6 : 1;
+
+	for (int sq = 0; sq < 64; sq++) {
+		int piece = _squares[sq];
+		if (!piece || color(piece) != us)
+			continue;
+
+		switch (kind(piece)) {
+		case kPawn: {
+			int x = sq / 8, y = sq % 8;
+			int dst = sq + forward;
+			bool promotes = (dst / 8 == 0 || dst / 8 == 7);
+
+			// Forward movement (and promotions, which are tactical)
+			if (!_squares[dst]) {
+				if (promotes) {
+					for (int i = 0; i < (captures ? 1 : 4); i++)
+						list.push(pack(sq, dst, kPromotions[i]));
+				} else if (!captures) {
+					list.push(pack(sq, dst, MoveType::kDefault));
+					if (x == home && !_squares[dst + forward])
+						list.push(pack(sq, dst + forward, MoveType::kDefault));
+				}
+			}
+
+			// Diagonal capture and enpassant
+			for (int i = -1; i <= 1; i += 2) {
+				if (y + i < 0 || y + i > 7)
+					continue;
+				int cap = dst + i;
+				if (_squares[cap] && color(_squares[cap]) == them) {
+					if (promotes) {
+						for (int j = 0; j < (captures ? 1 : 4); j++)
+							list.push(pack(sq, cap, kPromotions[j]));
+					} else {
+						list.push(pack(sq, cap, MoveType::kDefault));
+					}
+				} else if (cap == _enpassant) {
+					list.push(pack(sq, cap, MoveType::kEnpassant));
+				}
+			}
+			break;
+		}
+
+		case kKnight:
+		case kKing: {
+			const int* t = (kind(piece) == kKnight) ?
+				tables.knight[sq] : tables.king[sq];
+			for (; *t >= 0; t++) {
+				int target = _squares[*t];
+				if (target ? color(target) == them : !captures)
+					list.push(pack(sq, *t, MoveType::kDefault));
+			}
+			break;
+		}
+
+		default: {
+			// Bishops use the diagonal rays, rooks the orthogonal rays and
+			// queens use both.
+			int lo = (kind(piece) == kBishop) ? 4 : 0;
+			int hi = (kind(piece) == kRook) ? 4 : 8;
+			for (int d = lo; d < hi; d++) {
+				for (const int* t = tables.rays[sq][d]; *t >= 0; t++) {
+					int target = _squares[*t];
+					if (!target) {
+						if (!captures)
+							list.push(pack(sq, *t, MoveType::kDefault));
+						continue;
+					}
+					if (color(target) == them)
+						list.push(pack(sq, *t, MoveType::kDefault));
+					break;
+				}
+			}
+			break;
+		}
+		}
+	}
+
+	// Castling may not move out of, through or into check. Moving into check
+	// is caught by make(), so only the first two squares are tested here.
+	if (captures || !(_castling & (us == kWhite ? 3 : 12)))
+		return;
+
+	int king = _kings[us];
+	int kingside  = (us == kWhite) ? 1 : 4;
+	int queenside = (us == kWhite) ? 2 : 8;
+	if ((_castling & kingside) && !_squares[king + 1] && !_squares[king + 2] &&
+			!attacked(king, them) && !attacked(king + 1, them))
+		list.push(pack(king, king + 2, MoveType::kCastleKingside));
+	if ((_castling & queenside) && !_squares[king - 1] && !_squares[king - 2] &&
+			!_squares[king - 3] && !attacked(king, them) &&
+			!attacked(king - 1, them))
+		list.push(pack(king, king - 2, MoveType::kCastleQueenside));
+}
+
+PackedMove Board::parse(const std::string& text) {
+	MoveList list;
+	legal(list);
+	for (auto move : list)
+		if (notation(move) == text)
+			return move;
+	return 0;
+}
+
+PackedMove Board::parse_san(const char* text, size_t length) {
+	static const char kPieces[] = " PNBRQK";
+	while (length && text[length - 1] && std::strchr("+#!?", text[length - 1]))
+		length--;
+
+	MoveList list;
+	if ((length == 3 || length == 5) &&
+			(std::strncmp(text, "O-O-O", length) == 0 ||
+			std::strncmp(text, "0-0-0", length) == 0)) {
+		legal(list);
+		MoveType castle = (length == 3) ?
+			MoveType::kCastleKingside : MoveType::kCastleQueenside;
+		for (auto move : list)
+			if (type(move) == castle)
+				return move;
+		return 0;
+	}
+
+	int piece = kPawn;
+	if (length && std::isupper(static_cast<unsigned char>(text[0]))) {
+		const char* found = std::strchr(kPieces + kKnight, text[0]);
+		if (!found)
+			return 0;
+		piece = static_cast<int>(found - kPieces);
+		text++;
+		length--;
+	}
+
+	// Captures are marked with x and promotions are written e8=Q, or
+	// sometimes e8Q; neither mark tells moves apart
+	char san[5];
+	size_t size = 0;
+	for (size_t i = 0; i < length; i++) {
+		if (text[i] == 'x' || text[i] == '=')
+			continue;
+		if (size == sizeof(san))
+			return 0;
+		san[size++] = text[i];
+	}
+
+	MoveType promotion = MoveType::kDefault;
+	if (piece == kPawn && size && san[size - 1] &&
+			std::strchr("NBRQ", san[size - 1])) {
+		const char letter = san[--size];
+		promotion = (letter == 'N') ? MoveType::kPromoteKnight :
+			(letter == 'B') ? MoveType::kPromoteBishop :
+			(letter == 'R') ? MoveType::kPromoteRook : MoveType::kPromoteQueen;
+	}
+
+	if (size < 2 || size > 4)
+		return 0;
+	size_t last = size - 2;
+	int file = san[last] - 'a', rank = san[last + 1] - '1';
+	if (file < 0 || file > 7 || rank < 0 || rank > 7)
+		return 0;
+	int destination = (7 - rank) * 8 + file;
+
+	// Whatever precedes the destination tells apart pieces of the same kind
+	int from_file = -1, from_rank = -1;
+	for (size_t i = 0; i < last; i++) {
+		if (san[i] >= 'a' && san[i] <= 'h')
+			from_file = san[i] - 'a';
+		else if (san[i] >= '1' && san[i] <= '8')
+			from_rank = san[i] - '1';
+		else
+			return 0;
+	}
+
+	legal(list);
+	PackedMove found = 0;
+	for (auto move : list) {
+		int origin = from(move);
+		MoveType move_type = type(move);
+		bool promotes = move_type >= MoveType::kPromoteQueen;
+		if (kind(_squares[origin]) != piece || to(move) != destination ||
+				(from_file >= 0 && origin % 8 != from_file) ||
+				(from_rank >= 0 && 7 - origin / 8 != from_rank) ||
+				move_type == MoveType::kCastleKingside ||
+				move_type == MoveType::kCastleQueenside)
+			continue;
+		if (promotes && move_type != (promotion == MoveType::kDefault ?
+				MoveType::kPromoteQueen : promotion))
+			continue;
+		if (!promotes && promotion != MoveType::kDefault)
+			continue;
+		if (found)
+			return 0;
+		found = move;
+	}
+	return found;
+}
+
+void Board::legal(MoveList& list) {
+	MoveList pseudo;
+	moves(pseudo);
+	for (auto move : pseudo) {
+		if (make(move)) {
+			undo();
+			list.push(move);
+		}
+	}
+}
+
+bool Board::is_draw() const {
+	if (_halfmove >= 100)
+		return true;
+
+	// Only positions since the last irreversible move can repeat, and only
+	// positions with the same side to move need to be compared.
+	int stop = _ply - _halfmove;
+	for (int i = _ply - 2; i >= 0 && i >= stop; i -= 2)
+		if (_states[i].key == _key)
+			return true;
+	return false;
+}
+
+bool Board::is_insufficient() const {
+	for (int color = kWhite; color <= kBlack; color++) {
+		int base = color << 3;
+		if (_count[base | kPawn] || _count[base | kRook] || _count[base | kQueen])
+			return false;
+	}
+
+	int minors = _count[kKnight] + _count[kBishop] +
+		_count[(kBlack << 3) | kKnight] + _count[(kBlack << 3) | kBishop];
+	return minors <= 1;
+}
+
+uint64_t Board::perft(int depth) {
+	if (depth == 0)
+		return 1;
+
+	MoveList list;
+	moves(list);
+
+	uint64_t nodes = 0;
+	for (auto move : list) {
+		if (make(move)) {
+			nodes += perft(depth - 1);
+			undo();
+		}
+	}
+	return nodes;
+}
+
+} // namespace chess
@@ -0,0 +1,375 @@
+#ifndef AI_BOARD_H
+#define AI_BOARD_H
+
+#include "core/move.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * Piece colors. Colors double as indices into per-side arrays, so white must
+ * remain zero and black must remain one.
+ */
+enum Color : int {
+	kWhite = 0,
+	kBlack = 1
+};
+
+/*!
+ * Piece types. A piece code is its type combined with its color in the fourth
+ * bit (white pawn = 1, black pawn = 9); a code of zero is an empty square.
+ */
+enum PieceType : int {
+	kEmpty  = 0,
+	kPawn   = 1,
+	kKnight = 2,
+	kBishop = 3,
+	kRook   = 4,
+	kQueen  = 5,
+	kKing   = 6
+};
+
+/*!
+ * A move packed into 16 bits: the origin square in bits 0-5, the destination
+ * square in bits 6-11 and the MoveType in bits 12-14. Squares are numbered
+ * x * 8 + y using the same coordinates as Position, so a8 is 0 and h1 is 63.
+ * The zero value is never a legal move and is used to represent "no move".
+ */
+typedef uint16_t PackedMove;
+
+inline int from(PackedMove move) { return move & 63; }
+inline int to(PackedMove move) { return (move >> 6) & 63; }
+inline MoveType type(PackedMove move) { return MoveType(move >> 12); }
+inline int color(int piece) { return piece >> 3; }
+inline int kind(int piece) { return piece & 7; }
+
+inline PackedMove pack(int from, int to, MoveType type) {
+	return PackedMove(from | (to << 6) | (static_cast<int>(type) << 12));
+}
+
+inline PackedMove pack(const Move& move) {
+	return pack(move.cur.x * 8 + move.cur.y, move.nxt.x * 8 + move.nxt.y,
+		move.type);
+}
+
+inline Move unpack(PackedMove move) {
+	return Move(type(move), Position(from(move) / 8, from(move) % 8),
+		Position(to(move) / 8, to(move) % 8));
+}
+
+/*!
+ * Returns the move in long algebraic coordinate notation (e.g. e2e4, e7e8q),
+ * which is the notation used by the Universal Chess Interface.
+ * @param[in] move Move to convert.
+ * @return Coordinate notation, or "0000" for no move.
+ */
+std::string notation(PackedMove move);
+
+/*!
+ * A fixed capacity list of packed moves. No chess position has more than 218
+ * legal moves, so move lists may live on the stack and never allocate.
+ */
+struct MoveList {
+	PackedMove moves[256];
+	int size;
+
+	MoveList() : size(0) {}
+
+	inline void push(PackedMove move) { moves[size++] = move; }
+	inline PackedMove* begin() { return moves; }
+	inline PackedMove* end() { return moves + size; }
+	inline PackedMove& operator[](int i) { return moves[i]; }
+};
+
+/*!
+ * This class is a compact, copyable representation of a chess position that is
+ * designed for search rather than for presentation. Where Game tracks heap
+ * allocated Piece objects and regenerates std::sets of moves every turn, the
+ * board stores a 64 square mailbox, updates a Zobrist hash incrementally and
+ * generates moves into stack allocated MoveLists. Moves are made and undone
+ * in place, so an entire search can run on a single Board without allocating.
+ * Boards are not thread-safe; each searching thread should own its own copy.
+ */
+class Board {
+public:
+	/*! Deepest supported game plus search line, in plies. */
+	static const int kMaxPly = 2048;
+
+private:
+	/*!
+	 * Everything make() destroys and undo() must restore. One state is pushed
+	 * for every move (including null moves) made on the board.
+	 */
+	struct State {
+		uint64_t key;
+		PackedMove move;
+		uint8_t captured;
+		uint8_t castling;
+		int8_t enpassant;
+		uint8_t halfmove;
+	};
+
+	uint8_t _squares[64];
+	uint8_t _count[16];
+	int _kings[2];
+	int _turn;
+	int _castling;
+	int _enpassant;
+	int _halfmove;
+	uint64_t _key;
+	uint64_t _pawn_key;
+	int _midgame;
+	int _endgame;
+	int _phase;
+
+	State _states[kMaxPly];
+	int _ply;
+
+	/*!
+	 * Places the piece on the empty square and updates the hashes, counts and
+	 * incremental evaluation terms.
+	 * @param[in] sq Square to place the piece on.
+	 * @param[in] piece Piece code.
+	 */
+	void put(int sq, int piece);
+
+	/*!
+	 * Removes whichever piece occupies the square and updates the hashes,
+	 * counts and incremental evaluation terms. Removing an empty square is a
+	 * no-op.
+	 * @param[in] sq Square to clear.
+	 * @return Piece code of the removed piece.
+	 */
+	int remove(int sq);
+
+	/*!
+	 * Pushes every pseudo-legal move for the side to move onto the list. When
+	 * captures is true, only captures and queen promotions are generated.
+	 * @param[out] list Move list.
+	 * @param[in] captures True to generate only tactical moves.
+	 */
+	void generate(MoveList& list, bool captures) const;
+
+public:
+	/*!
+	 * Constructs a board with the pieces in the standard chess formation and
+	 * white to move.
+	 */
+	Board();
+
+	/*!
+	 * Constructs a board by replaying the specified move history from the
+	 * standard formation. This mirrors the Game constructor of the same shape
+	 * and is how engines convert the game they are playing into a Board.
+	 * @param[in] history Move history.
+	 */
+	explicit Board(const std::vector<Move>& history);
+
+	/*!
+	 * Constructs a board from a position in Forsyth-Edwards Notation. Throws
+	 * std::invalid_argument if the piece placement or side to move cannot be
+	 * parsed; missing trailing fields take their default values.
+	 * @param[in] fen FEN string.
+	 */
+	explicit Board(const std::string& fen);
+
+	/*!
+	 * Attempts to make the specified pseudo-legal move. If the move would leave
+	 * the mover's king in check, the board is restored and false is returned.
+	 * The move must have been generated for this position. A full board (see
+	 * full()) makes no move and returns false.
+	 * @param[in] move Move to make.
+	 * @return True if the move was legal and made, false otherwise.
+	 */
+	bool make(PackedMove move);
+
+	/*!
+	 * Undoes the last move made by make(). Undoing more moves than have been
+	 * made results in undefined behavior.
+	 */
+	void undo();
+
+	/*!
+	 * Passes the turn to the opponent without moving a piece. Null moves are
+	 * illegal in chess and are only used by search heuristics. Must not be
+	 * called while in check, nor on a full board (see full()).
+	 */
+	void make_null();
+
+	/*!
+	 * Undoes the last null move made by make_null().
+	 */
+	void undo_null();
+
+	/*!
+	 * Finds the legal move described in coordinate notation (e.g. e2e4, e1g1
+	 * for castling, e7e8q for promotion).
+	 * @param[in] text Coordinate notation.
+	 * @return Matching legal move, or zero if there is none.
+	 */
+	PackedMove parse(const std::string& text);
+
+	/*!
+	 * Finds the legal move described in standard algebraic notation (e.g. e4,
+	 * Nbd7, exd5, O-O, e8=Q), as written in PGN. Check and annotation marks
+	 * are ignored, and a pawn that reaches the last rank without a promotion
+	 * piece promotes to a queen.
+	 * @param[in] text Standard algebraic notation, which need not be
+	 * terminated; it is never copied to the heap.
+	 * @param[in] length Length of the notation.
+	 * @return Matching legal move, or zero if there is none or the notation
+	 * is ambiguous.
+	 */
+	PackedMove parse_san(const char* text, size_t length);
+
+	/*!
+	 * Finds the legal move described in standard algebraic notation.
+	 * @param[in] text Standard algebraic notation.
+	 * @return Matching legal move, or zero if there is none or the notation
+	 * is ambiguous.
+	 */
+	inline PackedMove parse_san(const std::string& text) {
+		return parse_san(text.data(), text.size());
+	}
+
+	/*!
+	 * Pushes every pseudo-legal move for the side to move onto the list.
+	 * Moves that leave the king in check are rejected by make().
+	 * @param[out] list Move list.
+	 */
+	inline void moves(MoveList& list) const {
+		generate(list, false);
+	}
+
+	/*!
+	 * Pushes every pseudo-legal capture and queen promotion for the side to
+	 * move onto the list. Used by quiescence search.
+	 * @param[out] list Move list.
+	 */
+	inline void captures(MoveList& list) const {
+		generate(list, true);
+	}
+
+	/*!
+	 * Pushes every legal move for the side to move onto the list. This is
+	 * slower than moves() because each move is made and undone to test it.
+	 * @param[out] list Move list.
+	 */
+	void legal(MoveList& list);
+
+	/*!
+	 * Returns true if the square is attacked by any piece of the given color.
+	 * @param[in] sq Square to test.
+	 * @param[in] by Attacking color.
+	 * @return True if attacked, false otherwise.
+	 */
+	bool attacked(int sq, int by) const;
+
+	/*!
+	 * Returns true if the side to move is in check.
+	 * @return True if in check, false otherwise.
+	 */
+	inline bool in_check() const {
+		return attacked(_kings[_turn], _turn ^ 1);
+	}
+
+	/*!
+	 * Returns true if the position is drawn by the fifty move rule or by
+	 * repetition of a position since the last irreversible move.
+	 * @return True if drawn, false otherwise.
+	 */
+	bool is_draw() const;
+
+	/*!
+	 * Returns true if neither side has enough material to deliver mate: there
+	 * are no pawns, rooks or queens, and at most one knight or bishop.
+	 * @return True if drawn by insufficient material, false otherwise.
+	 */
+	bool is_insufficient() const;
+
+	/*!
+	 * Counts the leaf nodes of the legal move tree of the specified depth.
+	 * Used to validate move generation and to benchmark make/undo.
+	 * @param[in] depth Depth of the tree.
+	 * @return Number of leaf nodes.
+	 */
+	uint64_t perft(int depth);
+
+	/*! Returns the piece code on the square (kEmpty if vacant). */
+	inline int at(int sq) const { return _squares[sq]; }
+
+	/*! Returns the number of pieces with the specified code on the board. */
+	inline int count(int piece) const { return _count[piece]; }
+
+	/*! Returns the color whose turn it is to move. */
+	inline int turn() const { return _turn; }
+
+	/*! Returns the square of the king of the specified color. */
+	inline int king(int color) const { return _kings[color]; }
+
+	/*! Returns the castling rights (1 = K, 2 = Q, 4 = k, 8 = q). */
+	inline int castling() const { return _castling; }
+
+	/*! Returns the en passant target square or -1 if there is none. */
+	inline int enpassant() const { return _enpassant; }
+
+	/*! Returns the number of plies since the last capture or pawn move. */
+	inline int halfmove() const { return _halfmove; }
+
+	/*! Returns the Zobrist hash of the position. */
+	inline uint64_t key() const { return _key; }
+
+	/*! Returns the Zobrist hash of the pawns alone. */
+	inline uint64_t pawn_key() const { return _pawn_key; }
+
+	/*! Returns the midgame material and placement score, white relative. */
+	inline int midgame() const { return _midgame; }
+
+	/*! Returns the endgame material and placement score, white relative. */
+	inline int endgame() const { return _endgame; }
+
+	/*! Returns the game phase (24 at the start, 0 with only kings and pawns). */
+	inline int phase() const { return _phase; }
+
+	/*! Returns the number of moves made on this board. */
+	inline int ply() const { return _ply; }
+
+	/*!
+	 * Returns true if kMaxPly moves have been made, after which no more can be
+	 * made until some are undone.
+	 */
+	inline bool full() const { return _ply >= kMaxPly; }
+
+	/*! Returns the last move made or zero for none (or a null move). */
+	inline PackedMove last() const {
+		return _ply ? _states[_ply - 1].move : 0;
+	}
+
+	/*!
+	 * Returns true if the specified color has any piece besides pawns and its
+	 * king. Positions without such material are prone to zugzwang.
+	 * @param[in] color Color to test.
+	 * @return True if the side has a minor or major piece.
+	 */
+	inline bool has_pieces(int color) const {
+		int base = color << 3;
+		return _count[base | kKnight] || _count[base | kBishop] ||
+			_count[base | kRook] || _count[base | kQueen];
+	}
+
+	/*!
+	 * Returns true if the move captures a piece (including en passant).
+	 * @param[in] move Move to test.
+	 * @return True if capture, false otherwise.
+	 */
+	inline bool is_capture(PackedMove move) const {
+		return _squares[to(move)] || type(move) == MoveType::kEnpassant;
+	}
+};
+
+} // namespace chess
+
+#endif // AI_BOARD_H
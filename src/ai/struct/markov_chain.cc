@@ -0,0 +1,162 @@
+#include "markov_chain.h"
+
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+/*! Spreads the moves of a position over the table. */
+const uint64_t kGolden = 0x9E3779B97F4A7C15ull;
+
+/*! Transitions stop being added once this fraction of slots is used. */
+const double kMaxLoad = 0.75;
+
+inline uint64_t slot(uint64_t key, PackedMove move) {
+	return key ^ (move * kGolden);
+}
+
+} // namespace
+
+MarkovChain::MarkovChain(size_t megabytes) : _size(0), _dropped(0),
+		_state_mask(0), _state_count(0) {
+	size_t size = 1;
+	while (2 * size * sizeof(Transition) <= (megabytes << 20))
+		size *= 2;
+	_transitions.assign(size, Transition());
+	_mask = size - 1;
+	_capacity = static_cast<size_t>(size * kMaxLoad);
+}
+
+bool MarkovChain::add(uint64_t key, PackedMove move, float weight) {
+	// Linear probing; the load limit guarantees an empty slot is found
+	for (uint64_t i = slot(key, move) & _mask; ; i = (i + 1) & _mask) {
+		Transition& transition = _transitions[i];
+		if (transition.key == key && transition.move == move) {
+			transition.weight += weight;
+			return true;
+		}
+		if (!transition.move) {
+			if (_size >= _capacity) {
+				_dropped++;
+				return false;
+			}
+			transition.key = key;
+			transition.move = move;
+			transition.weight = weight;
+			_size++;
+			return true;
+		}
+	}
+}
+
+void MarkovChain::compile() {
+	std::vector<const Transition*> sorted;
+	sorted.reserve(_size);
+	for (const auto& transition : _transitions)
+		if (transition.move && transition.weight > 0)
+			sorted.push_back(&transition);
+	std::sort(sorted.begin(), sorted.end(),
+		[](const Transition* a, const Transition* b) {
+			return a->key < b->key || (a->key == b->key && a->move < b->move);
+		});
+
+	_state_count = 0;
+	for (size_t i = 0; i < sorted.size(); i++)
+		_state_count += i == 0 || sorted[i]->key != sorted[i - 1]->key;
+
+	// Keep the table of states at most half full
+	size_t size = 1;
+	while (size < 2 * _state_count)
+		size *= 2;
+	_states.assign(size, State());
+	_state_mask = size - 1;
+	_outcomes.assign(sorted.size(), Outcome());
+
+	std::vector<double> scaled;
+	std::vector<uint32_t> small, large;
+	for (size_t begin = 0, end; begin < sorted.size(); begin = end) {
+		uint64_t key = sorted[begin]->key;
+		double total = 0;
+		for (end = begin; end < sorted.size() && sorted[end]->key == key; end++)
+			total += sorted[end]->weight;
+
+		// Vose's alias method: scale the probabilities so that they average
+		// one, then pair every column below one with a column above it
+		uint32_t count = static_cast<uint32_t>(end - begin);
+		scaled.resize(count);
+		small.clear();
+		large.clear();
+		for (uint32_t i = 0; i < count; i++) {
+			scaled[i] = sorted[begin + i]->weight * count / total;
+			(scaled[i] < 1 ? small : large).push_back(i);
+			_outcomes[begin + i].move = sorted[begin + i]->move;
+			_outcomes[begin + i].alias = static_cast<uint16_t>(i);
+		}
+		while (!small.empty() && !large.empty()) {
+			uint32_t less = small.back(), more = large.back();
+			small.pop_back();
+			_outcomes[begin + less].probability = static_cast<float>(scaled[less]);
+			_outcomes[begin + less].alias = static_cast<uint16_t>(more);
+			scaled[more] -= 1 - scaled[less];
+			if (scaled[more] < 1) {
+				large.pop_back();
+				small.push_back(more);
+			}
+		}
+
+		// Whatever is left is one, up to rounding
+		for (uint32_t i : small)
+			_outcomes[begin + i].probability = 1;
+		for (uint32_t i : large)
+			_outcomes[begin + i].probability = 1;
+
+		uint64_t i = key & _state_mask;
+		while (_states[i].count)
+			i = (i + 1) & _state_mask;
+		_states[i].key = key;
+		_states[i].offset = static_cast<uint32_t>(begin);
+		_states[i].count = count;
+	}
+}
+
+const MarkovChain::State* MarkovChain::find(uint64_t key) const {
+	if (!_state_count)
+		return nullptr;
+	for (uint64_t i = key & _state_mask; _states[i].count; i = (i + 1) & _state_mask)
+		if (_states[i].key == key)
+			return &_states[i];
+	return nullptr;
+}
+
+PackedMove MarkovChain::next(uint64_t key, std::mt19937& prng) const {
+	const State* state = find(key);
+	if (!state)
+		return 0;
+
+	std::uniform_int_distribution<uint32_t> column(0, state->count - 1);
+	std::uniform_real_distribution<float> coin(0, 1);
+	const Outcome* outcomes = &_outcomes[state->offset];
+	const Outcome& outcome = outcomes[column(prng)];
+	return (coin(prng) < outcome.probability) ? outcome.move :
+		outcomes[outcome.alias].move;
+}
+
+double MarkovChain::probability(uint64_t key, PackedMove move) const {
+	const State* state = find(key);
+	if (!state)
+		return 0;
+
+	// A move is drawn from its own column, or from any column aliased to it
+	const Outcome* outcomes = &_outcomes[state->offset];
+	double probability = 0;
+	for (uint32_t i = 0; i < state->count; i++) {
+		if (outcomes[i].move == move)
+			probability += outcomes[i].probability;
+		if (outcomes[outcomes[i].alias].move == move)
+			probability += 1 - outcomes[i].probability;
+	}
+	return probability / state->count;
+}
+
+} // namespace chess
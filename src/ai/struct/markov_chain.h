@@ -1,9 +1,11 @@
 #ifndef AI_MARKOV_CHAIN_H
 #define AI_MARKOV_CHAIN_H
 
+#include "board.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <random>
-#include <utility>
-#include <unordered_map>
 #include <vector>
 
 namespace chess {
@@ -15,41 +17,109 @@ namespace chess {
  * representing state transition probabilities. In the case of chess; however,
  * this matrix is likely to be extremely sparse. A much more memory efficient
  * model is to use a map to associate states to possible next states.
+ *
+ * States are the Zobrist hashes of positions and transitions are the moves
+ * played from them, so that transpositions share a state. While the chain is
+ * trained, the weight of every transition is accumulated in a flat, open
+ * addressed table of a fixed size, rather than in a node based map, so that
+ * training over a corpus of any size stays within its memory budget; once the
+ * table is nearly full, transitions that are not already known are dropped.
+ * Compiling the chain groups the transitions by state and builds an alias
+ * table for each state (Vose's alias method), so that the next state is drawn
+ * in constant time however many transitions the state has. Sampling is
+ * thread-safe; training and compiling are not.
  */
-template <typename T>
 class MarkovChain {
 private:
-	std::unordered_map<std::vector<T>, 
-		std::vector<std::pair<T, double>> _chain;
-	std::vector<T> _seed;
+	/*! A transition while the chain is trained; empty if the move is zero. */
+	struct Transition {
+		uint64_t key;
+		PackedMove move;
+		float weight;
+	};
+
+	/*! The transitions of a state in the compiled chain. */
+	struct State {
+		uint64_t key;
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	/*! A column of the alias table of a state. */
+	struct Outcome {
+		PackedMove move;
+		uint16_t alias;
+		float probability;
+	};
+
+	std::vector<Transition> _transitions;
+	uint64_t _mask;
+	size_t _size;
+	size_t _capacity;
+	uint64_t _dropped;
+
+	std::vector<State> _states;
+	uint64_t _state_mask;
+	size_t _state_count;
+	std::vector<Outcome> _outcomes;
+
+	/*! Returns the slot of the compiled state with the hash, or nullptr. */
+	const State* find(uint64_t key) const;
 
 public:
+	/*!
+	 * Constructs an empty chain whose training table uses roughly the
+	 * specified amount of memory. The number of slots is rounded down to a
+	 * power of two.
+	 * @param[in] megabytes Memory budget of the training table.
+	 */
+	explicit MarkovChain(size_t megabytes);
 
-	/*! Construct Random Seed Markov Chain
-	 * Constructs a Markov Chain from the specified map and randomly selects a
-	 * seed from the set of possible states. 
+	/*!
+	 * Adds weight to the transition from a state. Transitions with no weight
+	 * are never drawn.
+	 * @param[in] key Zobrist hash of the position.
+	 * @param[in] move Move played from the position; must not be zero.
+	 * @param[in] weight Weight to add.
+	 * @return True if the transition was counted, false if the table is full.
 	 */
-	MarkovChain(std::unordered_map<std::vector<T>, 
-			std::vector<std::pair<T, double>> chain); 
+	bool add(uint64_t key, PackedMove move, float weight);
 
-	/*! Construct Markov Chain
-	 * Constructs a Markov Chain from the specified map and uses the specified
-	 * seed as a starting point. Assumes that the specified state is a valid
-	 * possible state (state in chain).
+	/*!
+	 * Builds the alias tables of every state from the weights trained so far,
+	 * replacing any previous compilation. Training may continue afterwards,
+	 * but is not visible to next() until the chain is compiled again.
 	 */
-	MarkovChain(std::unordered_map<std::vector<T>,
-			 std::vector<std::pair<T, double>> chain, 
-			 std::vector<T> seed);
+	void compile();
 
- 	/*! Next State
+	/*!
 	 * Transitions the Markov Chain to the next state by randomly selecting one
-	 * of the possible next states for the current seed. This random selection
+	 * of the possible next states for the current state. This random selection
 	 * is weighted by the transition probability.
-	 * @return Next state
+	 * @param[in] key Zobrist hash of the position.
+	 * @param[in, out] prng Pseudo-random number generator.
+	 * @return Move drawn, or zero if the state is unknown.
+	 */
+	PackedMove next(uint64_t key, std::mt19937& prng) const;
+
+	/*!
+	 * Returns the probability that next() draws the transition.
+	 * @param[in] key Zobrist hash of the position.
+	 * @param[in] move Move played from the position.
+	 * @return Probability of the transition, or zero if it is unknown.
 	 */
-	T next();
+	double probability(uint64_t key, PackedMove move) const;
+
+	/*! Returns the number of transitions trained. */
+	inline size_t size() const { return _size; }
+
+	/*! Returns the number of states compiled. */
+	inline size_t states() const { return _state_count; }
+
+	/*! Returns the number of transitions dropped because the table was full. */
+	inline uint64_t dropped() const { return _dropped; }
 };
 
-}
+} // namespace chess
 
 #endif // AI_MARKOV_CHAIN_H
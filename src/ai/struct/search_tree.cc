@@ -0,0 +1,111 @@
+#include "search_tree.h"
+
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+/*!
+ * Copies the fields of a node. Nodes hold atomics and therefore cannot be
+ * copied by assignment; this must not run concurrently with a search.
+ */
+inline void copy(TreeNode& to, const TreeNode& from) {
+	to.first.store(from.first.load(std::memory_order_relaxed),
+		std::memory_order_relaxed);
+	to.visits.store(from.visits.load(std::memory_order_relaxed),
+		std::memory_order_relaxed);
+	to.value.store(from.value.load(std::memory_order_relaxed),
+		std::memory_order_relaxed);
+	to.prior = from.prior;
+	to.move = from.move;
+	to.size = from.size;
+}
+
+} // namespace
+
+SearchTree::SearchTree(size_t megabytes) {
+	size_t capacity = (megabytes << 20) / (2 * sizeof(TreeNode));
+	capacity = std::min<size_t>(std::max<size_t>(capacity, 1024), UINT32_MAX - 1);
+	_capacity = static_cast<uint32_t>(capacity);
+	_nodes.reset(new TreeNode[_capacity]);
+	_spare.reset(new TreeNode[_capacity]);
+	clear();
+}
+
+void SearchTree::clear() {
+	copy(_nodes[0], TreeNode());
+	_size.store(1, std::memory_order_relaxed);
+}
+
+bool SearchTree::expand(uint32_t node, const MoveList& moves,
+		const float* priors) {
+	TreeNode& parent = _nodes[node];
+	uint32_t claimed = 0;
+	if (!parent.first.compare_exchange_strong(claimed, TreeNode::kBusy,
+			std::memory_order_acquire))
+		return false;
+
+	// Reserve a block at the end of the arena, unless it would overflow
+	uint32_t first = _size.load(std::memory_order_relaxed);
+	do {
+		if (first + static_cast<uint32_t>(moves.size) > _capacity) {
+			parent.first.store(0, std::memory_order_release);
+			return false;
+		}
+	} while (!_size.compare_exchange_weak(first, first + moves.size,
+		std::memory_order_relaxed));
+
+	for (int i = 0; i < moves.size; i++) {
+		TreeNode& child = _nodes[first + i];
+		child.first.store(0, std::memory_order_relaxed);
+		child.visits.store(0, std::memory_order_relaxed);
+		child.value.store(0.0f, std::memory_order_relaxed);
+		child.prior = priors ? priors[i] : 1.0f / moves.size;
+		child.move = moves.moves[i];
+		child.size = 0;
+	}
+
+	// Publishing the offset releases the children to other threads
+	parent.size = static_cast<uint16_t>(moves.size);
+	parent.first.store(first, std::memory_order_release);
+	return true;
+}
+
+uint32_t SearchTree::child(uint32_t node, PackedMove move) const {
+	const TreeNode& parent = _nodes[node];
+	if (!parent.expanded())
+		return 0;
+
+	uint32_t first = parent.first.load(std::memory_order_relaxed);
+	for (uint32_t i = first; i < first + parent.size; i++)
+		if (_nodes[i].move == move)
+			return i;
+	return 0;
+}
+
+void SearchTree::reroot(uint32_t node) {
+	if (node == 0)
+		return;
+
+	// Copy the subtree breadth first. Each copied node is visited once, in the
+	// order it was copied, and its block of children is appended to the end
+	// of the new arena, which keeps every block contiguous.
+	uint32_t size = 1;
+	copy(_spare[0], _nodes[node]);
+	for (uint32_t i = 0; i < size; i++) {
+		TreeNode& parent = _spare[i];
+		if (!parent.expanded())
+			continue;
+
+		uint32_t first = parent.first.load(std::memory_order_relaxed);
+		parent.first.store(size, std::memory_order_relaxed);
+		for (uint32_t j = first; j < first + parent.size; j++)
+			copy(_spare[size++], _nodes[j]);
+	}
+
+	_nodes.swap(_spare);
+	_size.store(size, std::memory_order_relaxed);
+}
+
+} // namespace chess
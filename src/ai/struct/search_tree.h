@@ -0,0 +1,140 @@
+#ifndef AI_SEARCH_TREE_H
+#define AI_SEARCH_TREE_H
+
+#include "board.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace chess {
+
+/*!
+ * A single node of a Monte Carlo search tree. A node stands for the position
+ * reached by its move and accumulates the results of every playout that passed
+ * through it, from the perspective of the side that made the move. The
+ * children of a node occupy a contiguous block of the arena, so a node only
+ * records where its block starts and how long it is. Statistics are atomic, so
+ * that several threads may search the same tree.
+ */
+struct TreeNode {
+	/*! Value of first while one thread is creating the children of a node. */
+	static const uint32_t kBusy = UINT32_MAX;
+
+	std::atomic<uint32_t> first;
+	std::atomic<uint32_t> visits;
+	std::atomic<float> value;
+	float prior;
+	PackedMove move;
+	uint16_t size;
+
+	TreeNode() : first(0), visits(0), value(0.0f), prior(0.0f), move(0),
+		size(0) {}
+
+	/*!
+	 * Returns true if the children of this node have been created. The
+	 * offset and number of children may be read once this returns true.
+	 * @return True if expanded.
+	 */
+	inline bool expanded() const {
+		uint32_t offset = first.load(std::memory_order_acquire);
+		return offset != 0 && offset != kBusy;
+	}
+
+	/*!
+	 * Adds the result of a playout to the value of this node. There is no
+	 * atomic floating point addition in C++11, so this retries until no other
+	 * thread has changed the value in between.
+	 * @param[in] result Result of the playout.
+	 */
+	inline void add(float result) {
+		float current = value.load(std::memory_order_relaxed);
+		while (!value.compare_exchange_weak(current, current + result,
+			std::memory_order_relaxed)) {}
+	}
+};
+
+/*!
+ * This class stores a Monte Carlo search tree in a single contiguous arena.
+ * Nodes refer to each other by 32-bit offsets instead of pointers, which halves
+ * their size, keeps siblings adjacent in memory and makes discarding the tree
+ * free. The arena never grows beyond the capacity it was constructed with;
+ * once it is full, the tree simply stops expanding. Since the root is always
+ * node 0 and no node has node 0 as its child, an offset of zero means that a
+ * node has not been expanded.
+ *
+ * Several threads may expand and update the tree concurrently without a lock:
+ * a thread claims a node by atomically marking it busy, reserves a block of
+ * the arena by atomically advancing its end, and publishes the children by
+ * storing their offset. clear() and reroot() must not run concurrently with
+ * anything else.
+ */
+class SearchTree {
+private:
+	std::unique_ptr<TreeNode[]> _nodes;
+	std::unique_ptr<TreeNode[]> _spare;
+	std::atomic<uint32_t> _size;
+	uint32_t _capacity;
+
+public:
+	/*!
+	 * Constructs an empty tree that uses roughly the specified amount of
+	 * memory, and never more than 2^32 nodes. Half of the budget is set aside
+	 * so that reroot() never allocates.
+	 * @param[in] megabytes Memory budget.
+	 */
+	explicit SearchTree(size_t megabytes);
+
+	/*!
+	 * Discards every node except a new, unexpanded root.
+	 */
+	void clear();
+
+	/*!
+	 * Creates a child of the node for each of the moves, with the specified
+	 * prior probabilities. Expansion fails if the arena cannot fit them all,
+	 * or if another thread has claimed the node.
+	 * @param[in] node Offset of the node to expand.
+	 * @param[in] moves Moves playable from the node.
+	 * @param[in] priors Prior probability of each move, or null for uniform.
+	 * @return True if the node was expanded by this call, false otherwise.
+	 */
+	bool expand(uint32_t node, const MoveList& moves, const float* priors);
+
+	/*!
+	 * Returns the child of the node reached by the specified move.
+	 * @param[in] node Offset of an expanded node.
+	 * @param[in] move Move to look for.
+	 * @return Offset of the child, or zero if there is no such child.
+	 */
+	uint32_t child(uint32_t node, PackedMove move) const;
+
+	/*!
+	 * Makes the specified node the new root and discards every node outside of
+	 * its subtree. The subtree is copied breadth first into the spare arena, so
+	 * that the statistics gathered for the position it stands for survive
+	 * while the tree stays compact.
+	 * @param[in] node Offset of the new root.
+	 */
+	void reroot(uint32_t node);
+
+	/*! Returns the node at the specified offset. */
+	inline TreeNode& operator[](uint32_t node) { return _nodes[node]; }
+
+	/*! Returns the node at the specified offset. */
+	inline const TreeNode& operator[](uint32_t node) const {
+		return _nodes[node];
+	}
+
+	/*! Returns the number of nodes in the tree. */
+	inline size_t size() const {
+		return _size.load(std::memory_order_relaxed);
+	}
+
+	/*! Returns the maximum number of nodes the tree may hold. */
+	inline size_t capacity() const { return _capacity; }
+};
+
+} // namespace chess
+
+#endif // AI_SEARCH_TREE_H
@@ -0,0 +1,118 @@
+#ifndef AI_TRANSPOSITION_TABLE_H
+#define AI_TRANSPOSITION_TABLE_H
+
+#include "board.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * Specifies how a stored score relates to the true minimax value of the
+ * position. Alpha-beta only proves exact values inside the search window;
+ * outside of it a score is merely a lower or upper bound.
+ */
+enum class Bound : uint8_t {
+	kNone,
+	kExact,
+	kLower,
+	kUpper
+};
+
+/*!
+ * A single transposition table entry. Entries are kept to 16 bytes so that
+ * four of them share a cache line.
+ */
+struct TableEntry {
+	uint64_t key;
+	PackedMove move;
+	int16_t score;
+	int8_t depth;
+	Bound bound;
+};
+
+/*!
+ * This class represents a transposition table. Different move orders often
+ * reach the same position, and a search that remembers the result (and best
+ * move) of positions it has already searched can skip or better order most of
+ * its work. The table is a fixed size, direct mapped array indexed by the low
+ * bits of the Zobrist hash. This class is not thread-safe.
+ */
+class TranspositionTable {
+private:
+	std::vector<TableEntry> _entries;
+	uint64_t _mask;
+
+public:
+	/*!
+	 * Constructs a table that uses roughly the specified amount of memory. The
+	 * number of entries is rounded down to a power of two.
+	 * @param[in] megabytes Memory budget.
+	 */
+	explicit TranspositionTable(size_t megabytes) {
+		resize(megabytes);
+	}
+
+	/*!
+	 * Discards every entry and reallocates the table with the new budget.
+	 * @param[in] megabytes Memory budget.
+	 */
+	inline void resize(size_t megabytes) {
+		size_t size = 1;
+		while (2 * size * sizeof(TableEntry) <= (megabytes << 20))
+			size *= 2;
+		_entries.assign(size, TableEntry());
+		_mask = size - 1;
+	}
+
+	/*!
+	 * Discards every entry without changing the size of the table.
+	 */
+	inline void clear() {
+		_entries.assign(_entries.size(), TableEntry());
+	}
+
+	/*!
+	 * Looks up the position with the specified hash.
+	 * @param[in] key Zobrist hash of the position.
+	 * @param[out] entry Stored entry, if found.
+	 * @return True if the position was found, false otherwise.
+	 */
+	inline bool probe(uint64_t key, TableEntry& entry) const {
+		const TableEntry& slot = _entries[key & _mask];
+		if (slot.key != key || slot.bound == Bound::kNone)
+			return false;
+		entry = slot;
+		return true;
+	}
+
+	/*!
+	 * Stores the result of searching a position. Results for a different
+	 * position always replace the slot, but a shallower result for the same
+	 * position never overwrites a deeper one.
+	 * @param[in] key Zobrist hash of the position.
+	 * @param[in] move Best move found (or zero).
+	 * @param[in] score Score of the position.
+	 * @param[in] depth Remaining depth the position was searched to.
+	 * @param[in] bound Relation of the score to the true value.
+	 */
+	inline void store(uint64_t key, PackedMove move, int score, int depth,
+			Bound bound) {
+		TableEntry& slot = _entries[key & _mask];
+		if (slot.key == key && slot.depth > depth && bound != Bound::kExact)
+			return;
+		if (slot.key == key && !move)
+			move = slot.move;
+
+		slot.key = key;
+		slot.move = move;
+		slot.score = static_cast<int16_t>(score);
+		slot.depth = static_cast<int8_t>(depth);
+		slot.bound = bound;
+	}
+};
+
+} // namespace chess
+
+#endif // AI_TRANSPOSITION_TABLE_H
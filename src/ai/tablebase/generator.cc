@@ -0,0 +1,500 @@
+#include "generator.h"
+#include "ai/struct/board.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+namespace chess {
+
+namespace {
+
+/*! Working value of a position that has not been resolved (yet). */
+const int16_t kUnresolved = -1;
+
+/*! Working value of an illegal or non-canonical placement. */
+const int16_t kInvalid = -2;
+
+/*! External bound of a position with a drawing capture or promotion. */
+const int16_t kNever = -1;
+
+/*! Number of positions a thread claims at a time. */
+const uint64_t kBlock = 1 << 14;
+
+/*! Pieces a pawn may promote to. */
+const int kPromotions[] = {kQueen, kRook, kBishop, kKnight};
+
+const int kKingSteps[8][2] = {
+	{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}
+};
+
+const int kKnightSteps[8][2] = {
+	{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}
+};
+
+inline int sign(int x) { return (x > 0) - (x < 0); }
+
+/*! Returns the index of the piece on the square, or -1 if it is empty. */
+inline int occupant(const Placement& p, int sq) {
+	for (int i = 0; i < p.count; i++)
+		if (p.squares[i] == sq)
+			return i;
+	return -1;
+}
+
+/*! Returns true if the piece at the index attacks the target square. */
+bool attacks(const Placement& p, int i, int target) {
+	int piece = p.pieces[i], from = p.squares[i];
+	int dx = (target >> 3) - (from >> 3), dy = (target & 7) - (from & 7);
+	if (!dx && !dy)
+		return false;
+
+	switch (kind(piece)) {
+	case kKing:
+		return std::abs(dx) <= 1 && std::abs(dy) <= 1;
+	case kKnight:
+		return std::abs(dx * dy) == 2;
+	case kPawn:
+		return dx == (color(piece) == kWhite ? -1 : 1) && std::abs(dy) == 1;
+	default:
+		break;
+	}
+
+	bool straight = !dx || !dy, diagonal = std::abs(dx) == std::abs(dy);
+	if ((kind(piece) == kRook && !straight) ||
+			(kind(piece) == kBishop && !diagonal) || (!straight && !diagonal))
+		return false;
+
+	int step = sign(dx) * 8 + sign(dy);
+	for (int sq = from + step; sq != target; sq += step)
+		if (occupant(p, sq) >= 0)
+			return false;
+	return true;
+}
+
+/*! Returns true if the king of the specified color is attacked. */
+bool in_check(const Placement& p, int side) {
+	int king = -1;
+	for (int i = 0; i < p.count; i++)
+		if (p.pieces[i] == (kKing | (side << 3)))
+			king = p.squares[i];
+	for (int i = 0; i < p.count; i++)
+		if (color(p.pieces[i]) != side && attacks(p, i, king))
+			return true;
+	return false;
+}
+
+/*!
+ * Calls visit for every square the piece at the index could move to on an
+ * empty board, stopping each ray of a sliding piece when visit returns false.
+ * Pawns are not handled.
+ */
+template <typename Visit>
+void destinations(const Placement& p, int i, Visit visit) {
+	int type = kind(p.pieces[i]);
+	int x = p.squares[i] >> 3, y = p.squares[i] & 7;
+
+	if (type == kKing || type == kKnight) {
+		const int (*steps)[2] = (type == kKing) ? kKingSteps : kKnightSteps;
+		for (int s = 0; s < 8; s++) {
+			int tx = x + steps[s][0], ty = y + steps[s][1];
+			if (tx >= 0 && tx < 8 && ty >= 0 && ty < 8)
+				visit(tx * 8 + ty);
+		}
+		return;
+	}
+
+	for (int s = 0; s < 8; s++) {
+		bool diagonal = kKingSteps[s][0] && kKingSteps[s][1];
+		if ((type == kRook && diagonal) || (type == kBishop && !diagonal))
+			continue;
+		int tx = x + kKingSteps[s][0], ty = y + kKingSteps[s][1];
+		while (tx >= 0 && tx < 8 && ty >= 0 && ty < 8 && visit(tx * 8 + ty)) {
+			tx += kKingSteps[s][0];
+			ty += kKingSteps[s][1];
+		}
+	}
+}
+
+/*!
+ * Calls visit(child, external) for every legal move in the placement, where
+ * external is true for captures and promotions, which change the material.
+ */
+template <typename Visit>
+void successors(const Placement& p, Visit visit) {
+	int side = p.turn;
+	auto emit = [&](int i, int to, int captured) {
+		bool promotes = kind(p.pieces[i]) == kPawn &&
+			((to >> 3) == 0 || (to >> 3) == 7);
+		for (int n = 0; n < (promotes ? 4 : 1); n++) {
+			Placement child = p;
+			child.squares[i] = to;
+			if (promotes)
+				child.pieces[i] = kPromotions[n] | (side << 3);
+			if (captured >= 0) {
+				child.count--;
+				child.pieces[captured] = child.pieces[child.count];
+				child.squares[captured] = child.squares[child.count];
+			}
+			child.turn ^= 1;
+			if (!in_check(child, side))
+				visit(child, promotes || captured >= 0);
+		}
+	};
+
+	for (int i = 0; i < p.count; i++) {
+		if (color(p.pieces[i]) != side)
+			continue;
+		int sq = p.squares[i];
+
+		if (kind(p.pieces[i]) == kPawn) {
+			int dir = (side == kWhite) ? -8 : 8;
+			int start = (side == kWhite) ? 6 : 1;
+			if (occupant(p, sq + dir) < 0) {
+				emit(i, sq + dir, -1);
+				if ((sq >> 3) == start && occupant(p, sq + 2 * dir) < 0)
+					emit(i, sq + 2 * dir, -1);
+			}
+			for (int dy = -1; dy <= 1; dy += 2) {
+				int y = (sq & 7) + dy;
+				int j = (y >= 0 && y < 8) ? occupant(p, sq + dir + dy) : -1;
+				if (j >= 0 && color(p.pieces[j]) != side && kind(p.pieces[j]) != kKing)
+					emit(i, sq + dir + dy, j);
+			}
+			continue;
+		}
+
+		destinations(p, i, [&](int to) {
+			int j = occupant(p, to);
+			if (j < 0) {
+				emit(i, to, -1);
+				return true;
+			}
+			if (color(p.pieces[j]) != side && kind(p.pieces[j]) != kKing)
+				emit(i, to, j);
+			return false;
+		});
+	}
+}
+
+/*!
+ * Calls visit(parent) for every legal placement from which the opponent of
+ * the side to move could have reached the placement without capturing or
+ * promoting.
+ */
+template <typename Visit>
+void predecessors(const Placement& p, Visit visit) {
+	int side = p.turn ^ 1;
+	auto emit = [&](int i, int from) {
+		Placement parent = p;
+		parent.squares[i] = from;
+		parent.turn = side;
+		if (!in_check(parent, side ^ 1))
+			visit(parent);
+	};
+
+	for (int i = 0; i < p.count; i++) {
+		if (color(p.pieces[i]) != side)
+			continue;
+		int sq = p.squares[i];
+
+		if (kind(p.pieces[i]) == kPawn) {
+			int back = (side == kWhite) ? 8 : -8;
+			int from = sq + back;
+			if ((from >> 3) == 0 || (from >> 3) == 7 || occupant(p, from) >= 0)
+				continue;
+			emit(i, from);
+			if ((sq >> 3) == ((side == kWhite) ? 4 : 3) &&
+					occupant(p, from + back) < 0)
+				emit(i, from + back);
+			continue;
+		}
+
+		destinations(p, i, [&](int from) {
+			if (occupant(p, from) >= 0)
+				return false;
+			emit(i, from);
+			return true;
+		});
+	}
+}
+
+/*! Returns true if the placement could arise in a game. */
+bool valid(const Placement& p) {
+	for (int i = 0; i < p.count; i++) {
+		if (occupant(p, p.squares[i]) != i)
+			return false;
+		int rank = p.squares[i] >> 3;
+		if (kind(p.pieces[i]) == kPawn && (rank == 0 || rank == 7))
+			return false;
+	}
+	return !in_check(p, p.turn ^ 1);
+}
+
+/*! Returns the name of the material of a placement. */
+std::string name(const Placement& p) {
+	std::string sides[2] = {"K", "K"};
+	for (int i = 0; i < p.count; i++)
+		if (kind(p.pieces[i]) != kKing)
+			sides[color(p.pieces[i])] += " PNBRQ"[kind(p.pieces[i])];
+	return sides[0] + sides[1];
+}
+
+/*! Adds the value to the set if it is not already there. */
+inline bool insert(uint64_t* set, int& size, uint64_t value) {
+	if (std::find(set, set + size, value) != set + size)
+		return false;
+	set[size++] = value;
+	return true;
+}
+
+/*! Raises the maximum to the value. */
+inline void raise(std::atomic<int>& maximum, int value) {
+	int current = maximum.load();
+	while (value > current && !maximum.compare_exchange_weak(current, value)) {}
+}
+
+/*!
+ * Runs work(i) for every i below size on the specified number of threads,
+ * which claim blocks of consecutive indices.
+ */
+template <typename Work>
+void parallel(int threads, uint64_t size, Work work) {
+	std::atomic<uint64_t> next(0);
+	auto run = [&]() {
+		for (;;) {
+			uint64_t begin = next.fetch_add(kBlock);
+			if (begin >= size)
+				return;
+			uint64_t end = std::min(size, begin + kBlock);
+			for (uint64_t i = begin; i < end; i++)
+				work(i);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads; t++)
+		pool.push_back(std::thread(run));
+	run();
+	for (auto& thread : pool)
+		thread.join();
+}
+
+} // namespace
+
+TablebaseGenerator::TablebaseGenerator(int threads)
+	: _threads(threads > 0 ? threads :
+		std::max(1u, std::thread::hardware_concurrency())) {}
+
+const TableStats& TablebaseGenerator::generate(const std::string& text) {
+	Material material(text);
+	auto found = _stats.find(material.name());
+	if (found != _stats.end())
+		return found->second;
+
+	Placement pieces;
+	for (int i = 0; i < material.count(); i++)
+		pieces.add(material.piece(i), 0);
+	if (Material::insufficient(pieces))
+		throw std::invalid_argument(material.name() + " cannot be won");
+
+	// Generate every table a capture or promotion leads to
+	std::set<std::string> smaller;
+	for (int i = 2; i < material.count(); i++) {
+		Placement captured = pieces;
+		captured.count--;
+		captured.pieces[i] = captured.pieces[captured.count];
+		smaller.insert(name(captured));
+
+		if (kind(pieces.pieces[i]) != kPawn)
+			continue;
+		for (int promotion : kPromotions) {
+			Placement promoted = pieces;
+			promoted.pieces[i] = promotion | (color(pieces.pieces[i]) << 3);
+			smaller.insert(name(promoted));
+			for (int j = 2; j < material.count(); j++) {
+				if (color(pieces.pieces[j]) == color(pieces.pieces[i]))
+					continue;
+				Placement both = promoted;
+				both.count--;
+				both.pieces[j] = both.pieces[both.count];
+				smaller.insert(name(both));
+			}
+		}
+	}
+	for (auto& child : smaller) {
+		Placement check;
+		Material other(child);
+		for (int i = 0; i < other.count(); i++)
+			check.add(other.piece(i), 0);
+		if (!Material::insufficient(check) && other.name() != material.name())
+			generate(child);
+	}
+
+	std::vector<uint8_t>& entries = _entries[material.name()];
+	TableStats& stats = _stats[material.name()];
+	solve(material, entries, stats);
+	_tablebase.add(material, entries.data());
+	return stats;
+}
+
+void TablebaseGenerator::solve(const Material& material,
+		std::vector<uint8_t>& entries, TableStats& stats) {
+	auto start = std::chrono::steady_clock::now();
+	uint64_t size = material.size();
+	std::unique_ptr<std::atomic<int16_t>[]> plies(new std::atomic<int16_t>[size]);
+	std::unique_ptr<std::atomic<uint8_t>[]> remaining(new std::atomic<uint8_t>[size]);
+	std::unique_ptr<int16_t[]> bound(new int16_t[size]);
+	std::atomic<int> deepest(0);
+	std::atomic<bool> missing(false);
+
+	// Initialization: count the moves that stay within the table and score
+	// those that leave it. A capture or promotion into a lost position is a
+	// win (though there may be a faster one within the table), and one into a
+	// drawn position rules out a loss; bound holds the slowest loss.
+	parallel(_threads, size, [&](uint64_t index) {
+		Placement p = material.decode(index);
+		if (!valid(p) || material.index(p) != index) {
+			plies[index].store(kInvalid, std::memory_order_relaxed);
+			remaining[index].store(0, std::memory_order_relaxed);
+			bound[index] = kNever;
+			return;
+		}
+
+		uint64_t children[256];
+		int internal = 0;
+		bool moves = false, draw = false;
+		int win = INT16_MAX, loss = 0;
+		successors(p, [&](const Placement& child, bool external) {
+			moves = true;
+			if (!external) {
+				insert(children, internal, material.index(child));
+				return;
+			}
+
+			uint8_t entry;
+			if (!_tablebase.lookup(child, entry))
+				missing.store(true);
+			else if (entry == Tablebase::kDraw)
+				draw = true;
+			else if (entry >= Tablebase::kLoss)
+				win = std::min(win, Tablebase::plies(entry) + 1);
+			else
+				loss = std::max(loss, Tablebase::plies(entry) + 1);
+		});
+
+		int16_t value = kUnresolved;
+		if (!moves)
+			value = in_check(p, p.turn) ? 0 : kUnresolved;
+		else if (win != INT16_MAX)
+			value = static_cast<int16_t>(win);
+		else if (!internal && !draw)
+			value = static_cast<int16_t>(loss);
+
+		plies[index].store(value, std::memory_order_relaxed);
+		remaining[index].store(static_cast<uint8_t>(internal),
+			std::memory_order_relaxed);
+		bound[index] = (draw || !moves) ? kNever : static_cast<int16_t>(loss);
+		raise(deepest, value);
+	});
+	if (missing.load())
+		throw std::logic_error("missing a smaller table of " + material.name());
+
+	// Retrograde rounds: resolve the predecessors of every position resolved
+	// at the current depth. A round only ever assigns deeper values.
+	for (int depth = 0; depth <= deepest.load(); depth++) {
+		parallel(_threads, size, [&](uint64_t index) {
+			if (plies[index].load(std::memory_order_relaxed) != depth)
+				return;
+
+			uint64_t parents[256];
+			int count = 0;
+			Placement p = material.decode(index);
+			predecessors(p, [&](const Placement& parent) {
+				insert(parents, count, material.index(parent));
+			});
+
+			for (int i = 0; i < count; i++) {
+				std::atomic<int16_t>& value = plies[parents[i]];
+				int16_t current = value.load(std::memory_order_relaxed);
+				if (depth % 2 == 0) {
+					// The parent can move into a loss, so it wins
+					int16_t win = static_cast<int16_t>(depth + 1);
+					while ((current == kUnresolved || (current > win && current % 2)) &&
+						!value.compare_exchange_weak(current, win)) {}
+					raise(deepest, win);
+				} else if (current == kUnresolved &&
+						remaining[parents[i]].fetch_sub(1) == 1 &&
+						bound[parents[i]] != kNever) {
+					// Every move of the parent leads into a win
+					int16_t loss = static_cast<int16_t>(
+						std::max<int>(depth + 1, bound[parents[i]]));
+					value.compare_exchange_strong(current, loss);
+					raise(deepest, loss);
+				}
+			}
+		});
+	}
+
+	stats = TableStats();
+	entries.resize(size);
+	for (uint64_t i = 0; i < size; i++) {
+		int value = plies[i].load(std::memory_order_relaxed);
+		if (value == kInvalid) {
+			entries[i] = Tablebase::kIllegal;
+			stats.illegal++;
+		} else if (value == kUnresolved) {
+			entries[i] = Tablebase::kDraw;
+			stats.draws++;
+		} else if (value % 2) {
+			entries[i] = static_cast<uint8_t>((value + 1) / 2);
+			stats.wins++;
+		} else {
+			entries[i] = static_cast<uint8_t>(Tablebase::kLoss + value / 2);
+			stats.losses++;
+		}
+		if (value >= 2 * (Tablebase::kIllegal - Tablebase::kLoss))
+			throw std::overflow_error("mate too deep in " + material.name());
+		stats.longest = std::max(stats.longest, (value + 1) / 2);
+	}
+	stats.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+void TablebaseGenerator::save(const std::string& directory) const {
+	for (auto& table : _entries)
+		Tablebase::save(directory + "/" + table.first + ".tb", table.second);
+}
+
+std::vector<std::string> TablebaseGenerator::materials(int pieces) {
+	const char* const kSides[] = {"", "Q", "R", "B", "N", "P", "QQ", "QR", "QB",
+		"QN", "QP", "RR", "RB", "RN", "RP", "BB", "BN", "BP", "NN", "NP", "PP"};
+
+	std::vector<std::string> names;
+	std::set<std::string> seen;
+	for (int count = 3; count <= pieces; count++) {
+		for (auto white : kSides) {
+			for (auto black : kSides) {
+				std::string text = std::string("K") + white + "K" + black;
+				if (static_cast<int>(text.size()) != count)
+					continue;
+
+				Material material(text);
+				Placement check;
+				for (int i = 0; i < material.count(); i++)
+					check.add(material.piece(i), 0);
+				if (!Material::insufficient(check) &&
+						seen.insert(material.name()).second)
+					names.push_back(material.name());
+			}
+		}
+	}
+	return names;
+}
+
+} // namespace chess
@@ -0,0 +1,103 @@
+#ifndef AI_GENERATOR_H
+#define AI_GENERATOR_H
+
+#include "material.h"
+#include "tablebase.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * Counters collected while generating a single table.
+ */
+struct TableStats {
+	uint64_t wins;
+	uint64_t draws;
+	uint64_t losses;
+	uint64_t illegal;
+	int longest;
+	int64_t time;
+
+	TableStats() : wins(0), draws(0), losses(0), illegal(0), longest(0),
+		time(0) {}
+};
+
+/*!
+ * This class generates endgame tables by retrograde analysis. Rather than
+ * searching forward from every position, it works backwards from the end of
+ * the game: checkmates are lost in zero plies, every position with a move into
+ * a position lost in n plies is won in n + 1, and every position whose moves
+ * all lead into positions already known to be won is lost in one more ply than
+ * the slowest of them. Each round visits the positions resolved in the round
+ * before and walks their predecessors by unmaking moves, until a round resolves
+ * nothing; the positions left over are draws.
+ *
+ * Captures and promotions leave the table for a table with less material,
+ * which is generated first and consulted when the table is initialized. The
+ * positions of a table are divided among the threads, both when the table is
+ * initialized and in every round; a round only begins once the previous round
+ * has completed, so that the distances to mate are exact.
+ */
+class TablebaseGenerator {
+private:
+	int _threads;
+	std::map<std::string, std::vector<uint8_t>> _entries;
+	std::map<std::string, TableStats> _stats;
+	Tablebase _tablebase;
+
+	/*!
+	 * Solves a table whose smaller tables have all been generated.
+	 * @param[in] material Material of the table.
+	 * @param[out] entries Entries of the table.
+	 * @param[out] stats Counters of the table.
+	 */
+	void solve(const Material& material, std::vector<uint8_t>& entries,
+		TableStats& stats);
+
+public:
+	/*!
+	 * Constructs a generator that uses the specified number of threads.
+	 * @param[in] threads Number of threads; zero uses every core.
+	 */
+	explicit TablebaseGenerator(int threads = 0);
+
+	/*!
+	 * Generates the table of the material, after any smaller tables it depends
+	 * on. Tables are only generated once.
+	 * @param[in] name Name of the material, e.g. KRK.
+	 * @return Counters of the table.
+	 * @throws std::invalid_argument if the name is malformed or the material
+	 * cannot mate (kings alone, or with a single minor piece).
+	 */
+	const TableStats& generate(const std::string& name);
+
+	/*!
+	 * Writes every generated table to the directory, one file per table.
+	 * @param[in] directory Existing directory.
+	 * @throws std::runtime_error if a table cannot be written.
+	 */
+	void save(const std::string& directory) const;
+
+	/*!
+	 * Returns the tables generated so far, which may be probed while the
+	 * generator lives.
+	 * @return Tablebase of the generated tables.
+	 */
+	inline const Tablebase& tablebase() const { return _tablebase; }
+
+	/*!
+	 * Returns the names of every material with up to the specified number of
+	 * pieces that needs a table, smallest first.
+	 * @param[in] pieces Largest number of pieces, kings included.
+	 * @return Names of the materials.
+	 */
+	static std::vector<std::string> materials(int pieces);
+};
+
+} // namespace chess
+
+#endif // AI_GENERATOR_H
@@ -0,0 +1,255 @@
+#include "material.h"
+#include "ai/struct/board.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*! Number of canonical placements of the kings without pawns. */
+const int kKingPairs = 528;
+
+/*! Letters of the piece types, indexed by PieceType. */
+const char kLetters[] = " PNBRQK";
+
+/*!
+ * Applies one of the eight symmetries of the board to a square. The bits of
+ * the symmetry reflect the files, reflect the ranks and reflect the board in
+ * the a1-h8 diagonal, in that order.
+ */
+inline int transform(int sq, int symmetry) {
+	if (symmetry & 1)
+		sq ^= 7;
+	if (symmetry & 2)
+		sq ^= 56;
+	if (symmetry & 4)
+		sq = (7 - (sq & 7)) * 8 + (7 - (sq >> 3));
+	return sq;
+}
+
+inline int file(int sq) { return sq & 7; }
+inline int rank(int sq) { return 7 - (sq >> 3); }
+
+/*!
+ * Returns true if the kings stand where the symmetry reduction puts them: the
+ * white king in the triangle a1-d1-d4, and the black king on or below the long
+ * diagonal if the white king stands on it.
+ */
+inline bool canonical(int white, int black) {
+	if (file(white) > 3 || rank(white) > file(white))
+		return false;
+	return rank(white) != file(white) || rank(black) <= file(black);
+}
+
+/*!
+ * The placements of the kings without pawns: the symmetry that brings each
+ * pair of squares into canonical form and the index of each canonical pair.
+ */
+struct KingTable {
+	uint8_t symmetry[64][64];
+	int16_t index[64][64];
+	int16_t pairs[kKingPairs][2];
+
+	KingTable() {
+		int count = 0;
+		for (int white = 0; white < 64; white++) {
+			for (int black = 0; black < 64; black++) {
+				index[white][black] = -1;
+				if (canonical(white, black)) {
+					index[white][black] = static_cast<int16_t>(count);
+					pairs[count][0] = static_cast<int16_t>(white);
+					pairs[count++][1] = static_cast<int16_t>(black);
+				}
+				for (int s = 0; s < 8; s++) {
+					if (canonical(transform(white, s), transform(black, s))) {
+						symmetry[white][black] = static_cast<uint8_t>(s);
+						break;
+					}
+				}
+			}
+		}
+	}
+};
+
+const KingTable& kings() {
+	static const KingTable table;
+	return table;
+}
+
+/*! Orders pieces for indexing: kings, then white and black by value. */
+inline int order(int piece) {
+	if (kind(piece) == kKing)
+		return color(piece);
+	return 2 + color(piece) * 8 + (7 - kind(piece));
+}
+
+/*!
+ * Parses the pieces of one side from a name, most valuable first.
+ */
+std::vector<int> side(const std::string& letters) {
+	std::vector<int> kinds;
+	for (char letter : letters) {
+		const char* found = std::find(kLetters + 1, kLetters + 6, letter);
+		if (found == kLetters + 6)
+			throw std::invalid_argument(std::string("unknown piece ") + letter);
+		kinds.push_back(static_cast<int>(found - kLetters));
+	}
+	std::sort(kinds.rbegin(), kinds.rend());
+	return kinds;
+}
+
+} // namespace
+
+Material::Material(const std::string& name) {
+	size_t second = name.find('K', 1);
+	if (name.empty() || name[0] != 'K' || second == std::string::npos)
+		throw std::invalid_argument("malformed material " + name);
+
+	std::vector<int> white = side(name.substr(1, second - 1));
+	std::vector<int> black = side(name.substr(second + 1));
+	if (white.size() + black.size() + 2 > Placement::kMaxPieces)
+		throw std::invalid_argument("too many pieces in " + name);
+
+	// The stronger side, by number and then value of pieces, plays white
+	if (std::make_pair(white.size(), white) < std::make_pair(black.size(), black))
+		std::swap(white, black);
+
+	_count = 0;
+	_pieces[_count++] = kKing;
+	_pieces[_count++] = kKing | 8;
+	_name = "K";
+	for (int piece : white) {
+		_pieces[_count++] = piece;
+		_name += kLetters[piece];
+	}
+	_name += "K";
+	for (int piece : black) {
+		_pieces[_count++] = piece | 8;
+		_name += kLetters[piece];
+	}
+
+	_pawns = false;
+	for (int i = 0; i < _count; i++)
+		_pawns |= kind(_pieces[i]) == kPawn;
+
+	_size = (_pawns ? 32 * 64 : kKingPairs) * 2;
+	for (int i = 2; i < _count; i++)
+		_size *= 64;
+}
+
+uint32_t Material::signature() const {
+	Placement placement;
+	for (int i = 0; i < _count; i++)
+		placement.add(_pieces[i], 0);
+	return signature(placement);
+}
+
+uint64_t Material::index(const Placement& placement) const {
+	int squares[2][Placement::kMaxPieces];
+	int variants = 1;
+
+	if (_pawns) {
+		int mirror = (file(placement.squares[0]) > 3) ? 7 : 0;
+		for (int i = 0; i < _count; i++)
+			squares[0][i] = placement.squares[i] ^ mirror;
+	} else {
+		const KingTable& table = kings();
+		int symmetry = table.symmetry[placement.squares[0]][placement.squares[1]];
+		for (int i = 0; i < _count; i++)
+			squares[0][i] = transform(placement.squares[i], symmetry);
+
+		// Reflecting in the diagonal leaves kings on the diagonal in place
+		int white = squares[0][0], black = squares[0][1];
+		if (file(white) == rank(white) && file(black) == rank(black)) {
+			variants = 2;
+			for (int i = 0; i < _count; i++)
+				squares[1][i] = transform(squares[0][i], 4);
+		}
+	}
+
+	uint64_t best = UINT64_MAX;
+	for (int v = 0; v < variants; v++) {
+		int* sq = squares[v];
+
+		// Identical pieces are interchangeable; list them in square order
+		for (int i = 3; i < _count; i++)
+			if (_pieces[i] == _pieces[i - 1] && sq[i] < sq[i - 1])
+				std::swap(sq[i], sq[i - 1]);
+
+		uint64_t index = _pawns ?
+			((sq[0] >> 3) * 4 + file(sq[0])) * 64 + sq[1] :
+			kings().index[sq[0]][sq[1]];
+		for (int i = 2; i < _count; i++)
+			index = index * 64 + sq[i];
+		best = std::min(best, index * 2 + placement.turn);
+	}
+	return best;
+}
+
+Placement Material::decode(uint64_t index) const {
+	Placement placement;
+	placement.count = _count;
+	placement.turn = static_cast<int>(index & 1);
+	index >>= 1;
+	for (int i = _count - 1; i >= 2; i--) {
+		placement.pieces[i] = _pieces[i];
+		placement.squares[i] = static_cast<int>(index & 63);
+		index >>= 6;
+	}
+
+	placement.pieces[0] = _pieces[0];
+	placement.pieces[1] = _pieces[1];
+	if (_pawns) {
+		int white = static_cast<int>(index >> 6);
+		placement.squares[0] = (white / 4) * 8 + white % 4;
+		placement.squares[1] = static_cast<int>(index & 63);
+	} else {
+		placement.squares[0] = kings().pairs[index][0];
+		placement.squares[1] = kings().pairs[index][1];
+	}
+	return placement;
+}
+
+void Material::arrange(Placement& placement, bool reverse) const {
+	if (reverse) {
+		for (int i = 0; i < placement.count; i++) {
+			placement.pieces[i] ^= 8;
+			placement.squares[i] ^= 56;
+		}
+		placement.turn ^= 1;
+	}
+
+	for (int i = 1; i < placement.count; i++)
+		for (int j = i; j > 0 &&
+				order(placement.pieces[j]) < order(placement.pieces[j - 1]); j--) {
+			std::swap(placement.pieces[j], placement.pieces[j - 1]);
+			std::swap(placement.squares[j], placement.squares[j - 1]);
+		}
+}
+
+uint32_t Material::signature(const Placement& placement) {
+	uint32_t signature = 0;
+	for (int i = 0; i < placement.count; i++)
+		signature += 1u << (2 * placement.pieces[i]);
+	return signature;
+}
+
+uint32_t Material::reverse(uint32_t signature) {
+	return (signature >> 16) | (signature << 16);
+}
+
+bool Material::insufficient(const Placement& placement) {
+	int others = 0, minors = 0;
+	for (int i = 0; i < placement.count; i++) {
+		int type = kind(placement.pieces[i]);
+		others += type != kKing;
+		minors += type == kKnight || type == kBishop;
+	}
+	return others == 0 || (others == 1 && minors == 1);
+}
+
+} // namespace chess
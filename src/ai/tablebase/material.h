@@ -0,0 +1,144 @@
+#ifndef AI_MATERIAL_H
+#define AI_MATERIAL_H
+
+#include <cstdint>
+#include <string>
+
+namespace chess {
+
+/*!
+ * The pieces of a position without regard to where they stand: a placement
+ * of at most four pieces, described by piece codes (see PieceType) and
+ * squares, with a side to move.
+ */
+struct Placement {
+	static const int kMaxPieces = 4;
+
+	int pieces[kMaxPieces];
+	int squares[kMaxPieces];
+	int count;
+	int turn;
+
+	Placement() : count(0), turn(0) {}
+
+	/*!
+	 * Adds a piece to the placement.
+	 * @param[in] piece Piece code.
+	 * @param[in] square Square of the piece.
+	 */
+	inline void add(int piece, int square) {
+		pieces[count] = piece;
+		squares[count++] = square;
+	}
+};
+
+/*!
+ * This class describes the material of an endgame, such as KQKR, and maps the
+ * positions with that material onto the entries of its table. Tables always
+ * give the stronger side the white pieces; positions in which black is the
+ * stronger side are looked up with the colors reversed. The pieces of a
+ * position are indexed in a fixed order: the white king, the black king, the
+ * other white pieces and the other black pieces, from most to least valuable.
+ *
+ * Positions are reduced by symmetry before they are indexed. Without pawns,
+ * the board is rotated and reflected so that the white king stands in the
+ * triangle a1-d1-d4 and the black king on or below the long diagonal, which
+ * leaves 528 placements of the two kings rather than 4096. With pawns, only
+ * the reflection between the a and h files preserves the position, and the
+ * white king is kept on the a-d files. Every other piece takes one of 64
+ * squares. Ties left by the symmetry (both kings on the diagonal, or two
+ * identical pieces) are broken by taking the smallest index, so that each
+ * position has a single, canonical index. Entries whose placement is not
+ * canonical are never looked up.
+ */
+class Material {
+private:
+	std::string _name;
+	int _pieces[Placement::kMaxPieces];
+	int _count;
+	bool _pawns;
+	uint64_t _size;
+
+public:
+	/*!
+	 * Parses the material from its name: a king and the white pieces followed
+	 * by a king and the black pieces, e.g. KQKR or KPK. Names with the weaker
+	 * side first are reversed, so that KKQ is the same material as KQK.
+	 * @param[in] name Name of the material.
+	 * @throws std::invalid_argument if the name is malformed or describes more
+	 * than four pieces.
+	 */
+	explicit Material(const std::string& name);
+
+	/*! Returns the canonical name of the material. */
+	inline const std::string& name() const { return _name; }
+
+	/*! Returns the number of pieces, including the kings. */
+	inline int count() const { return _count; }
+
+	/*! Returns the piece code at the specified position of the index order. */
+	inline int piece(int i) const { return _pieces[i]; }
+
+	/*! Returns true if the material includes pawns. */
+	inline bool pawns() const { return _pawns; }
+
+	/*! Returns the number of entries of the table. */
+	inline uint64_t size() const { return _size; }
+
+	/*! Returns the signature of the material; see signature(). */
+	uint32_t signature() const;
+
+	/*!
+	 * Returns the index of a placement of this material.
+	 * @param[in] placement Placement whose pieces are in index order.
+	 * @return Canonical index.
+	 */
+	uint64_t index(const Placement& placement) const;
+
+	/*!
+	 * Returns the placement at the specified index. The placement may be
+	 * illegal, and its canonical index may differ from the one given.
+	 * @param[in] index Index of the placement.
+	 * @return Placement, with its pieces in index order.
+	 */
+	Placement decode(uint64_t index) const;
+
+	/*!
+	 * Arranges the pieces of a placement of this material, or of the same
+	 * material with the colors reversed, in index order. In the latter case
+	 * the colors are swapped and the board is reflected between the first and
+	 * eighth ranks first.
+	 * @param[in, out] placement Placement to arrange.
+	 * @param[in] reverse True if the colors of the placement are reversed.
+	 */
+	void arrange(Placement& placement, bool reverse) const;
+
+	/*!
+	 * Returns a number that identifies the pieces of a placement regardless of
+	 * their order, as two bits of count for every piece code. Placements of
+	 * the same material with the colors reversed have different signatures.
+	 * @param[in] placement Placement.
+	 * @return Signature of the pieces.
+	 */
+	static uint32_t signature(const Placement& placement);
+
+	/*!
+	 * Returns the signature with the colors of the pieces reversed.
+	 * @param[in] signature Signature of a material.
+	 * @return Signature of the material with the colors reversed.
+	 */
+	static uint32_t reverse(uint32_t signature);
+
+	/*!
+	 * Returns true if no sequence of legal moves can mate with the material of
+	 * the placement: kings alone, or with a single knight or bishop. These
+	 * endings need no table.
+	 * @param[in] placement Placement.
+	 * @return True if the material is a dead draw.
+	 */
+	static bool insufficient(const Placement& placement);
+};
+
+} // namespace chess
+
+#endif // AI_MATERIAL_H
@@ -0,0 +1,174 @@
+#include "tablebase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chess {
+
+namespace {
+
+/*! Identifies table files. */
+const char kMagic[4] = {'C', 'H', 'T', 'B'};
+
+/*! Version of the table format. */
+const uint32_t kVersion = 1;
+
+/*! Extension of table files. */
+const std::string kExtension = ".tb";
+
+} // namespace
+
+const uint8_t Tablebase::kDraw;
+const uint8_t Tablebase::kLoss;
+const uint8_t Tablebase::kIllegal;
+
+Tablebase::Tablebase() : _pieces(0) {}
+
+Tablebase::~Tablebase() {
+	for (auto& table : _tables)
+		if (table.mapping)
+			munmap(table.mapping, table.length);
+}
+
+void Tablebase::add(const Table& table) {
+	uint32_t signature = table.material.signature();
+	auto found = _signatures.find(signature);
+	size_t slot = _tables.size();
+	if (found != _signatures.end()) {
+		slot = found->second >> 1;
+		if (_tables[slot].mapping)
+			munmap(_tables[slot].mapping, _tables[slot].length);
+		_tables[slot] = table;
+	} else {
+		_tables.push_back(table);
+	}
+
+	// The low bit marks the signature of the material with colors reversed
+	_signatures[signature] = slot << 1;
+	if (Material::reverse(signature) != signature)
+		_signatures[Material::reverse(signature)] = (slot << 1) | 1;
+	_pieces = std::max(_pieces, table.material.count());
+}
+
+void Tablebase::add(const Material& material, const uint8_t* entries) {
+	add(Table(material, entries, nullptr, 0));
+}
+
+size_t Tablebase::load(const std::string& directory) {
+	DIR* dir = opendir(directory.c_str());
+	if (!dir)
+		return 0;
+
+	size_t count = 0;
+	while (dirent* file = readdir(dir)) {
+		std::string name = file->d_name;
+		if (name.size() <= kExtension.size() ||
+				name.compare(name.size() - kExtension.size(), kExtension.size(),
+				kExtension) != 0)
+			continue;
+
+		try {
+			Material material(name.substr(0, name.size() - kExtension.size()));
+			count += map(directory + "/" + name, material);
+		} catch (const std::invalid_argument&) {
+			// Not a table
+		}
+	}
+	closedir(dir);
+	return count;
+}
+
+bool Tablebase::map(const std::string& path, const Material& material) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	size_t length = sizeof(Header) + material.size();
+	if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != length) {
+		close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void* mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return false;
+
+	const Header* header = static_cast<const Header*>(mapping);
+	if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+			header->version != kVersion || header->size != material.size()) {
+		munmap(mapping, length);
+		return false;
+	}
+
+	const uint8_t* entries = static_cast<const uint8_t*>(mapping) + sizeof(Header);
+	add(Table(material, entries, mapping, length));
+	return true;
+}
+
+bool Tablebase::lookup(Placement placement, uint8_t& entry) const {
+	if (Material::insufficient(placement)) {
+		entry = kDraw;
+		return true;
+	}
+
+	auto found = _signatures.find(Material::signature(placement));
+	if (found == _signatures.end())
+		return false;
+
+	const Table& table = _tables[found->second >> 1];
+	table.material.arrange(placement, found->second & 1);
+	entry = table.entries[table.material.index(placement)];
+	return entry != kIllegal;
+}
+
+bool Tablebase::probe(const Board& board, int& wdl, int& dtm) const {
+	if (board.castling() || board.enpassant() >= 0)
+		return false;
+
+	int count = 0;
+	for (int piece = kPawn; piece <= kKing; piece++)
+		count += board.count(piece) + board.count(piece | 8);
+	if (count > _pieces)
+		return false;
+
+	Placement placement;
+	placement.turn = board.turn();
+	for (int sq = 0; sq < 64; sq++)
+		if (board.at(sq))
+			placement.add(board.at(sq), sq);
+
+	uint8_t entry;
+	if (!lookup(placement, entry))
+		return false;
+
+	wdl = (entry == kDraw) ? 0 : (entry >= kLoss) ? -1 : 1;
+	dtm = (entry >= kLoss) ? entry - kLoss : entry;
+	return true;
+}
+
+void Tablebase::save(const std::string& path,
+		const std::vector<uint8_t>& entries) {
+	Header header;
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.size = entries.size();
+
+	std::ofstream out(path, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(entries.data()), entries.size());
+	if (!out)
+		throw std::runtime_error("cannot write " + path);
+}
+
+} // namespace chess
@@ -0,0 +1,163 @@
+#ifndef AI_TABLEBASE_H
+#define AI_TABLEBASE_H
+
+#include "material.h"
+#include "ai/struct/board.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace chess {
+
+/*!
+ * This class answers queries about endgames with few pieces from tables that
+ * hold the outcome of every position under perfect play and the distance to
+ * mate (see TablebaseGenerator). Tables are files that are mapped into memory
+ * rather than read, so that loading them is instant, only the pages a search
+ * actually touches are ever read from disk, and every process that plays with
+ * the same tables shares a single copy of them.
+ *
+ * Each entry of a table is a single byte: zero for a draw, n for a win in n
+ * moves and 128 + n for a loss in n moves, for the side to move. Positions
+ * with castling rights or an en passant square are not covered, and the fifty
+ * move rule is ignored. Probing is thread-safe.
+ */
+class Tablebase {
+public:
+	/*! Entry of a drawn position. */
+	static const uint8_t kDraw = 0;
+
+	/*! Entries at or above this value are losses. */
+	static const uint8_t kLoss = 128;
+
+	/*! Entry of an illegal or non-canonical placement. */
+	static const uint8_t kIllegal = 255;
+
+	/*!
+	 * The header at the start of every table file, followed by the entries.
+	 */
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t size;
+	};
+
+private:
+	/*!
+	 * A table and the memory it is read from. Mapped tables own their mapping;
+	 * tables added from memory do not own their entries.
+	 */
+	struct Table {
+		Material material;
+		const uint8_t* entries;
+		void* mapping;
+		size_t length;
+
+		Table(const Material& material, const uint8_t* entries, void* mapping,
+			size_t length) : material(material), entries(entries),
+			mapping(mapping), length(length) {}
+	};
+
+	std::vector<Table> _tables;
+	std::unordered_map<uint32_t, size_t> _signatures;
+	int _pieces;
+
+	/*!
+	 * Registers a table under the signatures of both colorings of its
+	 * material, replacing any table of the same material.
+	 * @param[in] table Table to register.
+	 */
+	void add(const Table& table);
+
+public:
+	/*!
+	 * Constructs an empty tablebase, which covers no positions.
+	 */
+	Tablebase();
+
+	/*!
+	 * Unmaps every mapped table.
+	 */
+	~Tablebase();
+
+	Tablebase(const Tablebase&) = delete;
+	Tablebase& operator=(const Tablebase&) = delete;
+
+	/*!
+	 * Maps every table in the directory; tables are files named after their
+	 * material with the extension .tb (e.g. KQKR.tb).
+	 * @param[in] directory Directory of the tables.
+	 * @return Number of tables mapped.
+	 */
+	size_t load(const std::string& directory);
+
+	/*!
+	 * Maps a single table file.
+	 * @param[in] path Path of the table.
+	 * @param[in] material Material of the table.
+	 * @return True if the table was mapped, false if the file is missing or
+	 * is not a valid table of the material.
+	 */
+	bool map(const std::string& path, const Material& material);
+
+	/*!
+	 * Adds a table held in memory, which must outlive the tablebase.
+	 * @param[in] material Material of the table.
+	 * @param[in] entries Entries of the table.
+	 */
+	void add(const Material& material, const uint8_t* entries);
+
+	/*!
+	 * Looks up the entry of a placement.
+	 * @param[in] placement Placement, in any order and of either coloring.
+	 * @param[out] entry Entry of the placement. Dead draws (kings alone, or
+	 * with a single minor piece) need no table and are always found.
+	 * @return True if the placement is covered, false otherwise.
+	 */
+	bool lookup(Placement placement, uint8_t& entry) const;
+
+	/*!
+	 * Looks up the position on the board.
+	 * @param[in] board Position to look up.
+	 * @param[out] wdl 1 if the side to move wins, -1 if it loses and 0 if the
+	 * position is drawn.
+	 * @param[out] dtm Moves to mate, or zero if drawn or mated.
+	 * @return True if the position is covered, false otherwise.
+	 */
+	bool probe(const Board& board, int& wdl, int& dtm) const;
+
+	/*!
+	 * Returns the largest number of pieces, kings included, of any table.
+	 * @return Number of pieces, or zero if there are no tables.
+	 */
+	inline int pieces() const { return _pieces; }
+
+	/*! Returns the number of tables. */
+	inline size_t size() const { return _tables.size(); }
+
+	/*!
+	 * Converts an entry into the number of plies to mate: odd if the side to
+	 * move wins and even if it loses.
+	 * @param[in] entry Entry of a won or lost position.
+	 * @return Plies to mate.
+	 */
+	static inline int plies(uint8_t entry) {
+		return (entry >= kLoss) ? 2 * (entry - kLoss) : 2 * entry - 1;
+	}
+
+	/*!
+	 * Writes a table to a file.
+	 * @param[in] path Path of the table.
+	 * @param[in] entries Entries of the table.
+	 * @throws std::runtime_error if the file cannot be written.
+	 */
+	static void save(const std::string& path,
+		const std::vector<uint8_t>& entries);
+};
+
+} // namespace chess
+
+#endif // AI_TABLEBASE_H
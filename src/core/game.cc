@@ -123,8 +123,8 @@ std::string Game::to_string() const {
 	for (int x = 0; x < 8; x++) {
 		text += std::to_string(8 - x);
 		for (int y = 0; y < 8; y++) {
-			Piece* wpiece = _white->piece(Position(x, y));
-			Piece* bpiece = _black->piece(Position(x, y));
+			Piece* wpiece = _white->at(Position(x, y));
+			Piece* bpiece = _black->at(Position(x, y));
 			if (!wpiece && !bpiece) text += " ―";
 			else if (wpiece) text += " " + wpiece->to_string();
 			else if (bpiece) text += " " + bpiece->to_string();
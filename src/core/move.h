@@ -140,7 +140,7 @@ inline void load_construct_data(Archive& ar,
 	int cx, cy, nx, ny;
 	ar >> type >> cx >> cy >> nx >> ny;
 	
-	chess::Position cur(nx, ny);
+	chess::Position cur(cx, cy);
 	chess::Position nxt(nx, ny);
 	::new(move) chess::Move(type, cur, nxt);
 }
@@ -0,0 +1,434 @@
+#include "ai/alpha_beta_engine.h"
+#include "ai/mcts_engine.h"
+#include "ai/parse/blocking_queue.h"
+#include "ai/parse/bzip2_stream.h"
+#include "ai/parse/move_codec.h"
+#include "ai/parse/parallel_bzip2.h"
+#include "ai/parse/parser.h"
+#include "ai/parse/ring_buffer.h"
+#include "ai/parse/sample_file.h"
+#include "ai/search/playout.h"
+#include "ai/struct/board.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+
+namespace chess {
+
+namespace {
+
+/*! Positions every benchmark is run on: the opening, a middlegame and an endgame. */
+const char* const kPositions[] = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+/*!
+ * Reads a stream to the end.
+ * @param[in] in Stream to read.
+ * @return Number of bytes read.
+ * @throws std::runtime_error if the stream fails before its end.
+ */
+uint64_t drain(std::istream& in) {
+	static char buffer[1 << 16];
+	uint64_t bytes = 0;
+	while (in.read(buffer, sizeof(buffer)) || in.gcount())
+		bytes += in.gcount();
+	if (in.bad())
+		throw std::runtime_error("corrupt bzip2 data");
+	return bytes;
+}
+
+/*!
+ * Measures the decompression rate of a bzip2 file (e.g. all-games.pgn.bz2),
+ * decoded as a single stream and then by blocks on a doubling number of
+ * threads.
+ * @param[in] path Path of the file.
+ * @param[in] limit Largest number of threads.
+ */
+void bzip2(const std::string& path, int limit) {
+	std::cout << "decoder      threads  MB/s  speedup\n";
+	double base = 0.0;
+	for (int threads = 0; threads <= limit; threads = threads ? threads * 2 : 1) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			throw std::invalid_argument("cannot open " + path);
+
+		auto start = std::chrono::steady_clock::now();
+		uint64_t bytes;
+		if (threads) {
+			ParallelBzip2Stream in(file, threads);
+			bytes = drain(in);
+		} else {
+			Bzip2Stream in(file);
+			bytes = drain(in);
+		}
+		double time = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+
+		double rate = bytes / 1e6 / std::max(time, 1e-6);
+		if (!threads)
+			base = rate;
+		std::printf("%-11s  %7d  %4.0f  %7.2f\n", threads ? "parallel" : "single",
+			std::max(threads, 1), rate, rate / base);
+	}
+}
+
+/*!
+ * Measures the playout rate of the Monte Carlo tree search.
+ * @param[in] playouts Playouts per position.
+ */
+void mcts(uint64_t playouts) {
+	for (auto fen : kPositions) {
+		Board board((std::string(fen)));
+		MoveList moves;
+		board.legal(moves);
+
+		MctsOptions options;
+		options.playouts = playouts;
+		options.seed = 1;
+		MctsEngine engine(options);
+		PackedMove move = engine.select(board, moves);
+
+		const MctsStats& stats = engine.stats();
+		int64_t time = stats.time ? stats.time : 1;
+		std::cout << fen << "\n  " << notation(move) << ": "
+			<< stats.playouts << " playouts in " << time << " ms, "
+			<< stats.playouts * 1000 / time << " playouts/s, "
+			<< stats.plies * 1000 / time << " plies/s, "
+			<< engine.tree().size() << " nodes\n";
+	}
+}
+
+/*!
+ * Measures how the playout rate of the Monte Carlo tree search scales with the
+ * number of threads, from one thread up to twice the hardware concurrency.
+ * @param[in] time Milliseconds to search at each thread count.
+ */
+void mcts_scaling(int64_t time) {
+	Board board((std::string(kPositions[1])));
+	MoveList moves;
+	board.legal(moves);
+
+	Limits limits;
+	limits.move_time = time;
+	int cores = std::max(1u, std::thread::hardware_concurrency());
+	double base = 0.0;
+
+	std::cout << "threads  playouts/s  speedup  efficiency\n";
+	for (int threads = 1; threads <= 2 * cores; threads *= 2) {
+		MctsOptions options;
+		options.threads = threads;
+		options.seed = 1;
+		MctsEngine engine(options);
+		engine.select(board, moves, limits);
+
+		const MctsStats& stats = engine.stats();
+		double rate = stats.playouts * 1000.0 / (stats.time ? stats.time : 1);
+		if (threads == 1)
+			base = rate;
+		std::printf("%7d  %10.0f  %7.2f  %9.0f%%\n", threads, rate, rate / base,
+			100.0 * rate / base / threads);
+	}
+}
+
+/*!
+ * Measures the parse rate of a file of PGN games (e.g. all-games.pgn, not
+ * compressed), mapped into memory, as the games are handed to the workers one
+ * at a time and then in batches of a growing size.
+ * @param[in] path Path of the file.
+ * @param[in] threads Number of parsing threads.
+ */
+void parse(const std::string& path, int threads) {
+	std::ofstream out("/dev/null", std::ios::binary);
+	std::ostringstream log;
+	std::cout << "batch KB  games/s  parse s  write s\n";
+	for (size_t batch : {0, 4 << 10, 64 << 10, 256 << 10, 1 << 20}) {
+		Parser parser(out, log, threads, batch);
+		ParseStats stats = parser.parse_file(path);
+		double seconds = std::max<int64_t>(stats.time, 1) / 1000.0;
+		std::printf("%8zu  %7.0f  %7.2f  %7.2f\n", batch >> 10,
+			stats.games / seconds, stats.parse_time / 1000.0,
+			stats.write_time / 1000.0);
+	}
+}
+
+/*!
+ * Measures the rate at which random games are played to completion.
+ * @param[in] games Games per position.
+ */
+void playout(uint64_t games) {
+	Playout kernel(1);
+	for (auto fen : kPositions) {
+		Board board((std::string(fen)));
+		uint64_t plies = 0, results[3] = {0, 0, 0};
+
+		auto start = std::chrono::steady_clock::now();
+		for (uint64_t i = 0; i < games; i++) {
+			int result = kernel.play(board);
+			plies += kernel.plies();
+			kernel.rewind(board);
+			if (result != Playout::kUnfinished)
+				results[result + 1]++;
+		}
+		int64_t time = std::max<int64_t>(1,
+			std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start).count());
+
+		std::cout << fen << "\n  " << games << " games in " << time << " ms, "
+			<< games * 1000 / time << " games/s, "
+			<< plies * 1000 / time << " plies/s, "
+			<< plies / games << " plies/game, +" << results[2] << " ="
+			<< results[1] << " -" << results[0] << "\n";
+	}
+}
+
+/*! Returns the seconds elapsed since the start. */
+inline double seconds(std::chrono::steady_clock::time_point start) {
+	return std::max(1e-6, std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count());
+}
+
+/*!
+ * Measures the size and the write and read rates of samples in the binary
+ * sample format and in a boost text archive, on games of random moves.
+ * @param[in] games Number of games.
+ */
+void samples(int games) {
+	std::mt19937 prng(1);
+	std::vector<Sample> samples(games);
+	for (auto& sample : samples) {
+		Board board;
+		for (int ply = 0; ply < 80; ply++) {
+			MoveList moves;
+			board.legal(moves);
+			if (!moves.size)
+				break;
+			PackedMove move = moves[prng() % moves.size];
+			board.make(move);
+			sample.moves.push_back(unpack(move));
+		}
+		sample.result = static_cast<int>(prng() % 3) - 1;
+		sample.white_elo = 1200 + prng() % 1200;
+		sample.black_elo = 1200 + prng() % 1200;
+	}
+
+	std::cout << "format  MB     write MB/s  read MB/s  read samples/s\n";
+	for (int binary = 1; binary >= 0; binary--) {
+		std::stringstream stream;
+		auto start = std::chrono::steady_clock::now();
+		if (binary) {
+			SampleWriter writer(stream);
+			for (const auto& sample : samples)
+				writer.write(sample);
+		} else {
+			boost::archive::text_oarchive archive(stream);
+			for (const auto& sample : samples)
+				archive << sample;
+		}
+		double write = seconds(start);
+		double size = stream.str().size() / 1e6;
+
+		start = std::chrono::steady_clock::now();
+		Sample sample;
+		if (binary) {
+			SampleReader reader(stream);
+			while (reader.read(sample)) {}
+		} else {
+			boost::archive::text_iarchive archive(stream);
+			for (int i = 0; i < games; i++)
+				archive >> sample;
+		}
+		double read = seconds(start);
+		std::printf("%-6s  %5.1f  %10.0f  %9.0f  %14.0f\n",
+			binary ? "binary" : "text", size, size / write, size / read,
+			games / read);
+	}
+}
+
+/*!
+ * Measures how compactly and how fast the games of a sample file (e.g. the
+ * FICS corpus, as written by chess-parse) are stored as indices of their
+ * moves among the legal moves, against two bytes per packed move.
+ * @param[in] path Path of the sample file.
+ */
+void moves(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		throw std::invalid_argument("cannot open " + path);
+	SampleReader reader(file);
+	std::vector<std::vector<Move>> games;
+	uint64_t count = 0;
+	Sample sample;
+	while (reader.read(sample)) {
+		count += sample.moves.size();
+		games.push_back(sample.moves);
+	}
+	count = std::max<uint64_t>(count, 1);
+
+	std::cout << games.size() << " games, " << count << " moves\n"
+		<< "coding  bytes/move  encode moves/s  decode moves/s\n";
+	std::printf("packed  %10.3f\n", 2.0);
+	for (auto coding : {MoveCodec::kFixed, MoveCodec::kRange}) {
+		MoveCodec codec(coding);
+		std::string data;
+		auto start = std::chrono::steady_clock::now();
+		for (const auto& game : games)
+			codec.encode(game, data);
+		double encode = seconds(start);
+
+		start = std::chrono::steady_clock::now();
+		std::vector<Move> decoded;
+		for (size_t position = 0; position < data.size();)
+			position += codec.decode(data.data() + position,
+				data.size() - position, decoded);
+		double decode = seconds(start);
+		std::printf("%-6s  %10.3f  %14.0f  %14.0f\n",
+			coding == MoveCodec::kFixed ? "fixed" : "range",
+			static_cast<double>(data.size()) / count, count / encode,
+			count / decode);
+	}
+}
+
+/*!
+ * Moves items from producers to consumers through a queue.
+ * @param[in] queue Queue.
+ * @param[in] threads Number of producers, and of consumers.
+ * @param[in] items Number of items each producer pushes.
+ * @return Seconds taken.
+ */
+template <typename Queue>
+double transfer(Queue& queue, int threads, uint64_t items) {
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; i++) {
+		workers.emplace_back([&queue]() {
+			while (queue.pop()) {}
+		});
+	}
+	std::vector<std::thread> producers;
+	for (int i = 0; i < threads; i++) {
+		producers.emplace_back([&queue, items]() {
+			for (uint64_t item = 1; item <= items; item++)
+				queue.push(uint64_t(item));
+		});
+	}
+	for (auto& producer : producers)
+		producer.join();
+	for (int i = 0; i < threads; i++)
+		queue.push(0);
+	for (auto& worker : workers)
+		worker.join();
+	return seconds(start);
+}
+
+/*!
+ * Measures the rate at which items pass through the parser's queue (a
+ * RingBuffer) against the locked BlockingQueue it replaced, with one, two and
+ * four producers and as many consumers.
+ * @param[in] items Number of items each producer pushes.
+ */
+void queue(uint64_t items) {
+	const size_t kCapacity = 256;
+	std::cout << "threads  BlockingQueue Mitems/s  RingBuffer Mitems/s\n";
+	for (int threads : {1, 2, 4}) {
+		BlockingQueue<uint64_t> blocking(kCapacity);
+		RingBuffer<uint64_t> ring(kCapacity);
+		double total = static_cast<double>(threads) * items / 1e6;
+		std::printf("%dx%d  %24.2f  %19.2f\n", threads, threads,
+			total / transfer(blocking, threads, items),
+			total / transfer(ring, threads, items));
+	}
+}
+
+/*!
+ * Measures the node rate of the alpha-beta search.
+ * @param[in] depth Search depth.
+ */
+void search(int depth) {
+	for (auto fen : kPositions) {
+		Board board((std::string(fen)));
+		MoveList moves;
+		board.legal(moves);
+
+		SearchOptions options;
+		options.depth = depth;
+		AlphaBetaEngine engine(options);
+		PackedMove move = engine.select(board, moves);
+
+		const SearchStats& stats = engine.stats();
+		uint64_t nodes = stats.nodes + stats.qnodes;
+		int64_t time = stats.time ? stats.time : 1;
+		std::cout << fen << "\n  " << notation(move) << ": "
+			<< nodes << " nodes in " << time << " ms, "
+			<< nodes * 1000 / time << " nodes/s\n";
+	}
+}
+
+} // namespace
+
+} // namespace chess
+
+int main(int argc, char** argv) {
+	std::string benchmark = (argc > 1) ? argv[1] : "";
+	if (benchmark == "bzip2" && argc > 2) {
+		try {
+			chess::bzip2(argv[2], (argc > 3) ? std::atoi(argv[3]) :
+				std::max(1u, std::thread::hardware_concurrency()));
+		} catch (const std::exception& error) {
+			std::cerr << error.what() << "\n";
+			return 1;
+		}
+	} else if (benchmark == "mcts") {
+		chess::mcts((argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 20000);
+	} else if (benchmark == "mcts-scaling") {
+		chess::mcts_scaling((argc > 2) ? std::atoll(argv[2]) : 2000);
+	} else if (benchmark == "parse" && argc > 2) {
+		try {
+			chess::parse(argv[2], (argc > 3) ? std::atoi(argv[3]) : 0);
+		} catch (const std::exception& error) {
+			std::cerr << error.what() << "\n";
+			return 1;
+		}
+	} else if (benchmark == "playout") {
+		chess::playout((argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 10000);
+	} else if (benchmark == "moves" && argc > 2) {
+		try {
+			chess::moves(argv[2]);
+		} catch (const std::exception& error) {
+			std::cerr << error.what() << "\n";
+			return 1;
+		}
+	} else if (benchmark == "queue") {
+		chess::queue((argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1000000);
+	} else if (benchmark == "samples") {
+		chess::samples((argc > 2) ? std::atoi(argv[2]) : 100000);
+	} else if (benchmark == "search") {
+		chess::search((argc > 2) ? std::atoi(argv[2]) : 8);
+	} else {
+		std::cerr << "Usage: chess-bench bzip2 file [threads]\n"
+			<< "       chess-bench mcts [playouts]\n"
+			<< "       chess-bench mcts-scaling [milliseconds]\n"
+			<< "       chess-bench moves samples\n"
+			<< "       chess-bench parse file [threads]\n"
+			<< "       chess-bench playout [games]\n"
+			<< "       chess-bench queue [items]\n"
+			<< "       chess-bench samples [games]\n"
+			<< "       chess-bench search [depth]\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include "ai/book/builder.h"
+#include "ai/parse/sample_dataset.h"
+#include "ai/parse/sample_file.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*! Adds a sample to the book and reports progress. */
+void add(const Sample& sample, BookBuilder& builder) {
+	builder.add(sample);
+	if (builder.games() % 100000 == 0)
+		std::fprintf(stderr, "%llu games\n",
+			static_cast<unsigned long long>(builder.games()));
+}
+
+/*!
+ * Counts every sample of a file, as written by chess-parse or
+ * chess-selfplay, until the end of the stream.
+ * @throws std::runtime_error if the stream is not a file of samples.
+ */
+void read(std::istream& in, BookBuilder& builder) {
+	Sample sample;
+	SampleReader reader(in);
+	try {
+		while (reader.read(sample))
+			add(sample, builder);
+	} catch (const std::runtime_error& error) {
+		std::cerr << "stopped reading: " << error.what() << "\n";
+	}
+}
+
+void usage() {
+	std::cerr << "Usage: chess-book <book> [options] [samples...]\n"
+		<< "  book:     path of the book to write\n"
+		<< "  samples:  files of samples, or manifests of shards\n"
+		<< "            (default: standard input)\n"
+		<< "  -plies N       plies of each game to count\n"
+		<< "  -min N         times a move must be played to be kept\n"
+		<< "  -elo N         rating either player must reach\n";
+}
+
+} // namespace
+
+} // namespace chess
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		chess::usage();
+		return 1;
+	}
+
+	try {
+		std::string path = argv[1];
+		std::vector<std::string> inputs;
+		chess::BookOptions options;
+
+		for (int i = 2; i < argc; i++) {
+			std::string flag = argv[i];
+			if (flag[0] != '-') {
+				inputs.push_back(flag);
+				continue;
+			}
+			if (i + 1 >= argc) {
+				chess::usage();
+				return 1;
+			}
+			if (flag == "-plies") {
+				options.max_plies = std::atoi(argv[++i]);
+			} else if (flag == "-min") {
+				options.min_count = static_cast<uint32_t>(std::atoi(argv[++i]));
+			} else if (flag == "-elo") {
+				options.min_elo = std::atoi(argv[++i]);
+			} else {
+				chess::usage();
+				return 1;
+			}
+		}
+
+		chess::BookBuilder builder(options);
+		if (inputs.empty())
+			chess::read(std::cin, builder);
+		for (const auto& input : inputs) {
+			if (input.size() > 9 &&
+					input.compare(input.size() - 9, 9, ".manifest") == 0) {
+				chess::SampleDataset dataset(input);
+				chess::Sample sample;
+				while (dataset.read(sample))
+					chess::add(sample, builder);
+				continue;
+			}
+			std::ifstream in(input, std::ios::binary);
+			if (!in)
+				throw std::invalid_argument("cannot open " + input);
+			chess::read(in, builder);
+		}
+
+		size_t entries = builder.save(path);
+		std::fprintf(stderr, "Games: %llu  %llu moves  %zu entries\n",
+			static_cast<unsigned long long>(builder.games()),
+			static_cast<unsigned long long>(builder.positions()), entries);
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,131 @@
+#include "ai/match/elo.h"
+#include "ai/match/factory.h"
+#include "ai/match/tournament.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace chess {
+
+namespace {
+
+/*!
+ * Prints the score, the Elo difference with its 95% confidence interval and,
+ * if enabled, the log-likelihood ratio of the SPRT.
+ */
+void report(const Score& score, const Tournament& match, bool sprt) {
+	std::printf("Games: %llu  +%llu =%llu -%llu  %.1f%%  Elo %.1f +/- %.1f",
+		static_cast<unsigned long long>(score.games()),
+		static_cast<unsigned long long>(score.wins),
+		static_cast<unsigned long long>(score.draws),
+		static_cast<unsigned long long>(score.losses),
+		100.0 * score.ratio(), elo(score), elo_error(score));
+	if (sprt)
+		std::printf("  LLR %.2f [%.2f, %.2f]", match.sprt().llr(score),
+			match.sprt().lower(), match.sprt().upper());
+	std::printf("\n");
+	std::fflush(stdout);
+}
+
+void usage() {
+	std::cerr << "Usage: chess-match <engine> <engine> [options]\n"
+		<< "  engines: random[:seed=N],\n"
+		<< "           alphabeta[:depth=N,hash=MB,null=0|1,lmr=0|1,rfp=0|1,"
+		<< "futility=0|1],\n"
+		<< "           mcts[:playouts=N,tree=MB,puct=0|1,threads=N,seed=N]\n"
+		<< "  -games N         maximum number of games\n"
+		<< "  -threads N       concurrent games\n"
+		<< "  -tc BASE+INC     clock per game, in seconds\n"
+		<< "  -movetime MS     time per move\n"
+		<< "  -depth N         depth per move\n"
+		<< "  -nodes N         nodes (or playouts) per move\n"
+		<< "  -maxplies N      plies before a game is drawn\n"
+		<< "  -openings FILE   openings, one FEN or move sequence per line\n"
+		<< "  -sprt ELO0 ELO1  stop once either hypothesis is accepted\n";
+}
+
+} // namespace
+
+} // namespace chess
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		chess::usage();
+		return 1;
+	}
+
+	try {
+		chess::EngineFactory first = chess::factory(argv[1]);
+		chess::EngineFactory second = chess::factory(argv[2]);
+		chess::MatchOptions options;
+
+		for (int i = 3; i < argc; i++) {
+			std::string flag = argv[i];
+			bool value = i + 1 < argc;
+			if (flag == "-games" && value) {
+				options.games = std::strtoull(argv[++i], nullptr, 10);
+			} else if (flag == "-threads" && value) {
+				options.threads = std::atoi(argv[++i]);
+			} else if (flag == "-tc" && value) {
+				std::string tc = argv[++i];
+				size_t plus = tc.find('+');
+				options.time = static_cast<int64_t>(
+					1000 * std::atof(tc.substr(0, plus).c_str()));
+				if (plus != std::string::npos)
+					options.increment = static_cast<int64_t>(
+						1000 * std::atof(tc.substr(plus + 1).c_str()));
+			} else if (flag == "-movetime" && value) {
+				options.limits.move_time = std::atoll(argv[++i]);
+			} else if (flag == "-depth" && value) {
+				options.limits.depth = std::atoi(argv[++i]);
+			} else if (flag == "-nodes" && value) {
+				options.limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+			} else if (flag == "-maxplies" && value) {
+				options.max_plies = std::atoi(argv[++i]);
+			} else if (flag == "-openings" && value) {
+				std::ifstream file(argv[++i]);
+				if (!file)
+					throw std::invalid_argument(std::string("cannot open ") + argv[i]);
+				options.openings.clear();
+				std::string line;
+				while (std::getline(file, line))
+					if (!line.empty())
+						options.openings.push_back(line);
+			} else if (flag == "-sprt" && i + 2 < argc) {
+				options.sprt = true;
+				options.elo0 = std::atof(argv[++i]);
+				options.elo1 = std::atof(argv[++i]);
+			} else {
+				chess::usage();
+				return 1;
+			}
+		}
+
+		for (auto& opening : options.openings)
+			chess::Tournament::setup(opening);
+
+		chess::Tournament match(first, second, options);
+		bool sprt = options.sprt;
+		match.listen([&match, sprt](const chess::Score& score) {
+			if (score.games() % 10 == 0)
+				chess::report(score, match, sprt);
+		});
+
+		const chess::Score& score = match.run();
+		std::cout << argv[1] << " vs " << argv[2] << "\n";
+		chess::report(score, match, sprt);
+		if (match.time_losses())
+			std::cout << match.time_losses() << " games lost on time\n";
+		if (sprt)
+			std::cout << "SPRT: " << (match.decision() > 0 ? "H1 accepted" :
+				match.decision() < 0 ? "H0 accepted" : "inconclusive") << "\n";
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
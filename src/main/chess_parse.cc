@@ -0,0 +1,115 @@
+#include "ai/parse/bzip2_stream.h"
+#include "ai/parse/parallel_bzip2.h"
+#include "ai/parse/parser.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace chess {
+
+namespace {
+
+void usage() {
+	std::cerr << "Usage: chess-parse [options] [input]\n"
+		<< "  input: PGN games, optionally compressed with bzip2 (e.g.\n"
+		<< "         all-games.pgn.bz2; default: standard input); files that\n"
+		<< "         are not compressed are mapped into memory\n"
+		<< "  -threads N     parsing and decompression threads (default: every\n"
+		<< "                 core)\n"
+		<< "  -out FILE      file of samples (default: standard output)\n"
+		<< "  -shards PATH   one file of samples per thread, PATH.N.samples,\n"
+		<< "                 listed in PATH.manifest, instead of -out\n"
+		<< "  -log FILE      parse errors and timings (default: standard error)\n"
+		<< "  -batch KB      input handed to a worker at a time; 0 hands out games\n"
+		<< "                 one at a time (default: 256)\n";
+}
+
+} // namespace
+
+} // namespace chess
+
+int main(int argc, char** argv) {
+	// Lets the standard streams buffer, and put back what compressed() read
+	std::ios::sync_with_stdio(false);
+
+	try {
+		std::string input, output, shards, log;
+		int threads = 0;
+		size_t batch = chess::Parser::kBatchBytes;
+
+		for (int i = 1; i < argc; i++) {
+			std::string flag = argv[i];
+			if (flag[0] != '-' && input.empty()) {
+				input = flag;
+				continue;
+			}
+			if (i + 1 >= argc) {
+				chess::usage();
+				return 1;
+			}
+			if (flag == "-threads") {
+				threads = std::atoi(argv[++i]);
+			} else if (flag == "-out") {
+				output = argv[++i];
+			} else if (flag == "-shards") {
+				shards = argv[++i];
+			} else if (flag == "-log") {
+				log = argv[++i];
+			} else if (flag == "-batch") {
+				batch = std::strtoul(argv[++i], nullptr, 10) << 10;
+			} else {
+				chess::usage();
+				return 1;
+			}
+		}
+
+		std::ifstream in;
+		if (!input.empty()) {
+			in.open(input);
+			if (!in)
+				throw std::invalid_argument("cannot open " + input);
+		}
+		std::ofstream out;
+		if (!output.empty()) {
+			out.open(output, std::ios::binary);
+			if (!out)
+				throw std::invalid_argument("cannot open " + output);
+		}
+		std::ofstream errors;
+		if (!log.empty()) {
+			errors.open(log);
+			if (!errors)
+				throw std::invalid_argument("cannot open " + log);
+		}
+
+		// Compressed input is decompressed as it is parsed, never to disk, with
+		// its blocks decoded on every core
+		std::istream& source = input.empty() ? std::cin : in;
+		std::unique_ptr<std::istream> decompressed;
+		if (chess::Bzip2Buffer::compressed(source))
+			decompressed.reset(new chess::ParallelBzip2Stream(source, threads));
+
+		// Workers share the output, or each write a shard of their own
+		std::ostream& messages = log.empty() ? std::cerr : errors;
+		std::unique_ptr<chess::Parser> parser(shards.empty() ?
+			new chess::Parser(output.empty() ? std::cout : out, messages, threads,
+				batch) :
+			new chess::Parser(shards, messages, threads, batch));
+
+		// Decompressed files are mapped and parsed where they lie
+		if (!decompressed && !input.empty()) {
+			in.close();
+			parser->parse_file(input);
+		} else {
+			parser->parse(decompressed ? *decompressed : source);
+		}
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
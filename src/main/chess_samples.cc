@@ -0,0 +1,72 @@
+#include "ai/parse/sample_dataset.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace chess {
+
+namespace {
+
+void usage() {
+	std::cerr << "Usage: chess-samples <manifest> [options]\n"
+		<< "  manifest: manifest of shards, as written by chess-parse -shards\n"
+		<< "  -out FILE      merge every shard into a single file of samples\n";
+}
+
+} // namespace
+
+} // namespace chess
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		chess::usage();
+		return 1;
+	}
+
+	try {
+		std::string manifest = argv[1], output;
+		for (int i = 2; i < argc; i++) {
+			std::string flag = argv[i];
+			if (flag == "-out" && i + 1 < argc) {
+				output = argv[++i];
+			} else {
+				chess::usage();
+				return 1;
+			}
+		}
+
+		// Reading every sample checks each shard against the manifest
+		chess::SampleDataset dataset(manifest);
+		uint64_t samples = 0, moves = 0;
+		if (!output.empty()) {
+			std::ofstream out(output, std::ios::binary);
+			if (!out)
+				throw std::invalid_argument("cannot open " + output);
+			samples = dataset.merge(out);
+			if (!out)
+				throw std::runtime_error("cannot write " + output);
+		} else {
+			chess::Sample sample;
+			while (dataset.read(sample)) {
+				samples++;
+				moves += sample.moves.size();
+			}
+		}
+
+		for (const auto& shard : dataset.shards())
+			std::printf("%12llu  %s\n", static_cast<unsigned long long>(shard.count),
+				shard.path.c_str());
+		std::printf("%12llu  samples in %zu shards",
+			static_cast<unsigned long long>(samples), dataset.shards().size());
+		if (output.empty())
+			std::printf(", %llu moves", static_cast<unsigned long long>(moves));
+		std::printf("\n");
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
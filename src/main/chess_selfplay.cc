@@ -0,0 +1,113 @@
+#include "ai/match/factory.h"
+#include "ai/match/self_play.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace chess {
+
+namespace {
+
+/*!
+ * Prints the counters of the run and its throughput to the standard error, so
+ * that samples may be written to the standard output.
+ */
+void report(const SelfPlayStats& stats) {
+	double seconds = std::max<int64_t>(stats.time, 1) / 1000.0;
+	std::fprintf(stderr, "Games: %llu  +%llu =%llu -%llu  %llu positions  "
+		"%.2f games/s  %.0f positions/s\n",
+		static_cast<unsigned long long>(stats.score.games()),
+		static_cast<unsigned long long>(stats.score.wins),
+		static_cast<unsigned long long>(stats.score.draws),
+		static_cast<unsigned long long>(stats.score.losses),
+		static_cast<unsigned long long>(stats.plies),
+		stats.score.games() / seconds, stats.plies / seconds);
+}
+
+void usage() {
+	std::cerr << "Usage: chess-selfplay <engine> [options]\n"
+		<< "  engine: see chess-match\n"
+		<< "  -games N       number of games\n"
+		<< "  -threads N     concurrent games\n"
+		<< "  -seed N        seed of the random openings\n"
+		<< "  -random N      random plies at the start of each game\n"
+		<< "  -movetime MS   time per move\n"
+		<< "  -depth N       depth per move\n"
+		<< "  -nodes N       nodes (or playouts) per move\n"
+		<< "  -maxplies N    plies before a game is drawn\n"
+		<< "  -rating N      rating written for both players\n"
+		<< "  -out FILE      file of samples (default: standard output)\n";
+}
+
+} // namespace
+
+} // namespace chess
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		chess::usage();
+		return 1;
+	}
+
+	try {
+		chess::EngineFactory engine = chess::factory(argv[1]);
+		chess::SelfPlayOptions options;
+		std::string path;
+
+		for (int i = 2; i < argc; i++) {
+			std::string flag = argv[i];
+			if (i + 1 >= argc) {
+				chess::usage();
+				return 1;
+			}
+			if (flag == "-games") {
+				options.games = std::strtoull(argv[++i], nullptr, 10);
+			} else if (flag == "-threads") {
+				options.threads = std::atoi(argv[++i]);
+			} else if (flag == "-seed") {
+				options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			} else if (flag == "-random") {
+				options.random_plies = std::atoi(argv[++i]);
+			} else if (flag == "-movetime") {
+				options.limits.move_time = std::atoll(argv[++i]);
+			} else if (flag == "-depth") {
+				options.limits.depth = std::atoi(argv[++i]);
+			} else if (flag == "-nodes") {
+				options.limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+			} else if (flag == "-maxplies") {
+				options.max_plies = std::atoi(argv[++i]);
+			} else if (flag == "-rating") {
+				options.rating = std::atoi(argv[++i]);
+			} else if (flag == "-out") {
+				path = argv[++i];
+			} else {
+				chess::usage();
+				return 1;
+			}
+		}
+
+		std::ofstream file;
+		if (!path.empty()) {
+			file.open(path, std::ios::binary);
+			if (!file)
+				throw std::invalid_argument("cannot open " + path);
+		}
+		chess::SampleWriter out(path.empty() ? std::cout : file);
+
+		chess::SelfPlay games(engine, out, options);
+		games.listen([](const chess::SelfPlayStats& stats) {
+			if (stats.score.games() % 10 == 0)
+				chess::report(stats);
+		});
+		chess::report(games.run());
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,83 @@
+#include "ai/tablebase/generator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*!
+ * Prints the counters of a table once it has been generated.
+ */
+void report(const std::string& name, const TableStats& stats) {
+	std::printf("%-6s  +%llu =%llu -%llu  %llu illegal  longest %d  %.2fs\n",
+		name.c_str(),
+		static_cast<unsigned long long>(stats.wins),
+		static_cast<unsigned long long>(stats.draws),
+		static_cast<unsigned long long>(stats.losses),
+		static_cast<unsigned long long>(stats.illegal),
+		stats.longest, stats.time / 1000.0);
+	std::fflush(stdout);
+}
+
+void usage() {
+	std::cerr << "Usage: chess-tbgen <directory> [options] [tables...]\n"
+		<< "  directory: existing directory the tables are written to\n"
+		<< "  tables:    materials to generate, e.g. KQKR (default: every table)\n"
+		<< "  -threads N     threads (default: every core)\n"
+		<< "  -pieces N      largest number of pieces, kings included (3 or 4)\n";
+}
+
+} // namespace
+
+} // namespace chess
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		chess::usage();
+		return 1;
+	}
+
+	try {
+		std::string directory = argv[1];
+		std::vector<std::string> names;
+		int threads = 0, pieces = 4;
+
+		for (int i = 2; i < argc; i++) {
+			std::string flag = argv[i];
+			if (flag[0] != '-') {
+				names.push_back(flag);
+				continue;
+			}
+			if (i + 1 >= argc) {
+				chess::usage();
+				return 1;
+			}
+			if (flag == "-threads") {
+				threads = std::atoi(argv[++i]);
+			} else if (flag == "-pieces") {
+				pieces = std::atoi(argv[++i]);
+			} else {
+				chess::usage();
+				return 1;
+			}
+		}
+		if (names.empty())
+			names = chess::TablebaseGenerator::materials(pieces);
+
+		// Smaller tables a table depends on are generated before it
+		chess::TablebaseGenerator generator(threads);
+		for (const auto& name : names)
+			chess::report(name, generator.generate(name));
+		generator.save(directory);
+	} catch (const std::exception& error) {
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
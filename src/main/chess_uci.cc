@@ -0,0 +1,429 @@
+#include "ai/alpha_beta_engine.h"
+#include "ai/book_engine.h"
+#include "ai/random_engine.h"
+#include "ai/struct/board.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*!
+ * Writes a line to standard output. Both the reader thread and the searching
+ * thread write to the GUI, so every line is written under a lock and flushed
+ * immediately.
+ * @param[in] line Line to write.
+ */
+void send(const std::string& line) {
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
+	std::cout << line << std::endl;
+}
+
+/*!
+ * Reads the value of a spin option, clamped to the range advertised for it.
+ * Values that are not numbers, or out of range, are reported to the GUI.
+ * @param[in] name Name of the option.
+ * @param[in] value Value sent by the GUI.
+ * @param[in] min Smallest value of the option.
+ * @param[in] max Largest value of the option.
+ * @param[out] result Value of the option.
+ * @return False if the value is not a number.
+ */
+bool spin(const std::string& name, const std::string& value, long min,
+		long max, long& result) {
+	char* end;
+	long number = std::strtol(value.c_str(), &end, 10);
+	if (value.empty() || *end) {
+		send("info string invalid value " + value + " for " + name);
+		return false;
+	}
+	result = std::min(std::max(number, min), max);
+	if (result != number)
+		send("info string " + name + " set to " + std::to_string(result));
+	return true;
+}
+
+/*!
+ * Formats a score as either centipawns or moves until mate.
+ * @param[in] score Search score.
+ * @return UCI score string.
+ */
+std::string score(int score) {
+	if (score > AlphaBetaEngine::kMateBound)
+		return "mate " + std::to_string((AlphaBetaEngine::kMate - score + 1) / 2);
+	if (score < -AlphaBetaEngine::kMateBound)
+		return "mate " + std::to_string(-(AlphaBetaEngine::kMate + score) / 2);
+	return "cp " + std::to_string(score);
+}
+
+/*!
+ * Formats the statistics of a completed iteration as one info line per line of
+ * analysis.
+ * @param[in] stats Search statistics.
+ * @param[in] lines Best lines, best first.
+ * @return UCI info lines.
+ */
+std::string info(const SearchStats& stats, const std::vector<Line>& lines) {
+	uint64_t nodes = stats.nodes + stats.qnodes;
+	std::ostringstream out;
+	for (size_t i = 0; i < lines.size(); i++) {
+		if (i)
+			out << "\n";
+		out << "info depth " << stats.depth << " multipv " << i + 1
+			<< " score " << score(lines[i].score) << " nodes " << nodes
+			<< " nps " << nodes * 1000 / (stats.time ? stats.time : 1)
+			<< " time " << stats.time << " pv";
+		for (auto move : lines[i].moves)
+			out << " " << notation(move);
+	}
+	return out.str();
+}
+
+/*!
+ * This class implements the Universal Chess Interface, the text protocol that
+ * chess GUIs and match runners use to drive engines. Commands are read from
+ * the input stream on the calling thread while searches run on a separate
+ * thread, so that "stop", "isready" and "quit" are answered immediately even
+ * during an infinite search. The engine is kept between searches, so that its
+ * transposition table carries over from move to move and from pondering on
+ * the expected reply to the search that follows a ponder hit.
+ */
+class Uci {
+private:
+	Board _board;
+	SearchOptions _options;
+	std::string _engine_name;
+	int _multi_pv;
+	std::unique_ptr<AlphaBetaEngine> _engine;
+	std::unique_ptr<Tablebase> _tablebase;
+	std::unique_ptr<Book> _book;
+	std::mt19937 _prng;
+	RandomEngine _random;
+	std::thread _search;
+	std::mutex _mutex;
+	std::condition_variable _released;
+	bool _held;
+
+	/*!
+	 * Allows a search that is held back (see go()) to report its best move.
+	 */
+	void release() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_held = false;
+		}
+		_released.notify_all();
+	}
+
+	/*!
+	 * Blocks until the running search, if any, has reported its best move.
+	 * Infinite and pondering searches only finish when told to, so they are
+	 * stopped first.
+	 */
+	void wait() {
+		if (!_search.joinable())
+			return;
+
+		bool held;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			held = _held;
+		}
+		if (held) {
+			_engine->stop();
+			release();
+		}
+		_search.join();
+	}
+
+	/*!
+	 * Handles "position [startpos | fen <fen>] [moves <move>...]".
+	 * @param[in] in Remaining tokens of the command.
+	 */
+	void position(std::istringstream& in) {
+		std::string token, fen;
+		in >> token;
+		if (token == "fen") {
+			while (in >> token && token != "moves")
+				fen += token + " ";
+		} else {
+			in >> token;
+		}
+
+		try {
+			_board = fen.empty() ? Board() : Board(fen);
+		} catch (const std::invalid_argument& e) {
+			send(std::string("info string ") + e.what());
+			_board = Board();
+			return;
+		}
+
+		// The board must keep room for the deepest search on top of the game
+		while (in >> token) {
+			if (_board.ply() >= Board::kMaxPly - AlphaBetaEngine::kMaxDepth) {
+				send("info string game too long, stopped before " + token);
+				return;
+			}
+			PackedMove move = _board.parse(token);
+			if (!move) {
+				send("info string illegal move " + token);
+				return;
+			}
+			_board.make(move);
+		}
+	}
+
+	/*!
+	 * Handles "go" and its search limits, and starts the search thread.
+	 * @param[in] in Remaining tokens of the command.
+	 */
+	void go(std::istringstream& in) {
+		Limits limits;
+		MoveList root;
+		std::string token;
+		bool white = _board.turn() == kWhite;
+
+		while (in >> token) {
+			if (token == "wtime" || token == "btime") {
+				int64_t time;
+				in >> time;
+				if ((token == "wtime") == white) limits.time = time;
+			} else if (token == "winc" || token == "binc") {
+				int64_t increment;
+				in >> increment;
+				if ((token == "winc") == white) limits.increment = increment;
+			} else if (token == "movestogo") {
+				in >> limits.moves_to_go;
+			} else if (token == "movetime") {
+				in >> limits.move_time;
+			} else if (token == "nodes") {
+				in >> limits.nodes;
+			} else if (token == "depth") {
+				in >> limits.depth;
+			} else if (token == "infinite") {
+				limits.infinite = true;
+			} else if (token == "ponder") {
+				limits.ponder = true;
+			} else if (token == "searchmoves") {
+				PackedMove move;
+				while (in >> token && (move = _board.parse(token)))
+					root.push(move);
+			}
+		}
+
+		if (!root.size)
+			_board.legal(root);
+
+		// Reset before the thread starts, so that a "stop" or "ponderhit" read
+		// right after this "go" can never be overwritten by the search starting
+		// up. The protocol forbids reporting the best move of an infinite or
+		// pondering search before being told to, even if the search ends early.
+		_engine->reset();
+		_held = limits.infinite || limits.ponder;
+		Board board = _board;
+		_search = std::thread([this, board, root, limits]() mutable {
+			PackedMove best = 0, ponder = 0;
+			if (root.size && _engine_name == "Random") {
+				best = _random.select(root);
+			} else if (root.size && _book && !limits.infinite &&
+					(best = BookEngine::choose(*_book, board, root, _prng))) {
+				send("info string book move");
+			} else if (root.size) {
+				const std::vector<Line>& lines =
+					_engine->analyse(board, root, limits, _multi_pv);
+				best = lines.empty() ? root[0] : lines.front().moves.front();
+				ponder = _engine->prediction();
+				const SearchStats& stats = _engine->stats();
+				send("info string null " + std::to_string(stats.null_cutoffs) +
+					"/" + std::to_string(stats.null_tries) +
+					" lmr " + std::to_string(stats.lmr_researches) +
+					"/" + std::to_string(stats.lmr_reductions) +
+					" rfp " + std::to_string(stats.reverse_futility_prunes) +
+					" fp " + std::to_string(stats.futility_prunes) +
+					" tbhits " + std::to_string(stats.tablebase_hits) +
+					" pawnhits " + std::to_string(
+						static_cast<int>(100 * _engine->pawns().hit_rate())) + "%");
+			}
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			_released.wait(lock, [this]() { return !_held; });
+			lock.unlock();
+			send("bestmove " + notation(best) +
+				(ponder ? " ponder " + notation(ponder) : ""));
+		});
+	}
+
+	/*!
+	 * Handles "setoption name <name> [value <value>]". Changing an option
+	 * while searching waits for the search to finish. Only a new table size
+	 * requires the engine, and everything it has learned, to be replaced.
+	 * @param[in] in Remaining tokens of the command.
+	 */
+	void setoption(std::istringstream& in) {
+		std::string token, name, value;
+		in >> token;
+		while (in >> token && token != "value")
+			name += (name.empty() ? "" : " ") + token;
+		while (in >> token)
+			value += (value.empty() ? "" : " ") + token;
+
+		wait();
+		bool enabled = (value == "true");
+		long number;
+		if (name == "Hash") {
+			if (!spin(name, value, 1, 4096, number))
+				return;
+			// The engine is only replaced once the new table is allocated
+			SearchOptions options = _options;
+			options.table_size = static_cast<size_t>(number);
+			try {
+				_engine.reset(new AlphaBetaEngine(options));
+			} catch (const std::bad_alloc&) {
+				send("info string cannot allocate " + value + " MB of hash");
+				return;
+			}
+			_options = options;
+			_engine->tablebase(_tablebase.get());
+			listen();
+		} else if (name == "TablebasePath") {
+			_tablebase.reset(new Tablebase());
+			size_t tables = _tablebase->load(value);
+			_engine->tablebase(_tablebase.get());
+			send("info string " + std::to_string(tables) + " tables");
+		} else if (name == "BookFile") {
+			_book.reset(new Book());
+			if (!_book->open(value)) {
+				_book.reset();
+				if (!value.empty() && value != "<empty>")
+					send("info string cannot open book " + value);
+			} else {
+				send("info string book of " + std::to_string(_book->size()) +
+					" entries");
+			}
+		} else if (name == "Depth") {
+			if (spin(name, value, 1, 64, number))
+				_options.depth = static_cast<int>(number);
+		} else if (name == "MultiPV") {
+			if (spin(name, value, 1, 256, number))
+				_multi_pv = static_cast<int>(number);
+		} else if (name == "Engine") {
+			_engine_name = value;
+		} else if (name == "NullMove") {
+			_options.null_move = enabled;
+		} else if (name == "LateMoveReductions") {
+			_options.late_move_reductions = enabled;
+		} else if (name == "ReverseFutility") {
+			_options.reverse_futility = enabled;
+		} else if (name == "Futility") {
+			_options.futility = enabled;
+		} else if (name != "Ponder") {
+			// Pondering needs no configuration; the GUI asks for it with "go
+			// ponder" when the option is on.
+			send("info string unknown option " + name);
+		}
+		_engine->options() = _options;
+	}
+
+	/*!
+	 * Connects the engine's progress reports to the GUI.
+	 */
+	void listen() {
+		_engine->listen([](const SearchStats& stats,
+				const std::vector<Line>& lines) {
+			send(info(stats, lines));
+		});
+	}
+
+public:
+	Uci() : _engine_name("AlphaBeta"), _multi_pv(1),
+		_engine(new AlphaBetaEngine(_options)), _prng(std::random_device()()),
+		_held(false) {
+		listen();
+	}
+
+	~Uci() {
+		_engine->stop();
+		release();
+		wait();
+	}
+
+	/*!
+	 * Reads and executes commands until "quit" or the end of the stream.
+	 * @param[in] in Command stream.
+	 */
+	void run(std::istream& in) {
+		std::string line, command;
+		while (std::getline(in, line)) {
+			std::istringstream tokens(line);
+			if (!(tokens >> command))
+				continue;
+
+			if (command == "uci") {
+				send("id name Deep Orange");
+				send("id author Ashwin Madavan");
+				send("option name Hash type spin default 16 min 1 max 4096");
+				send("option name Depth type spin default 6 min 1 max 64");
+				send("option name MultiPV type spin default 1 min 1 max 256");
+				send("option name Ponder type check default false");
+				send("option name Engine type combo default AlphaBeta "
+					"var AlphaBeta var Random");
+				send("option name NullMove type check default true");
+				send("option name LateMoveReductions type check default true");
+				send("option name ReverseFutility type check default true");
+				send("option name Futility type check default true");
+				send("option name TablebasePath type string default <empty>");
+				send("option name BookFile type string default <empty>");
+				send("uciok");
+			} else if (command == "isready") {
+				send("readyok");
+			} else if (command == "ucinewgame") {
+				wait();
+				_engine->clear();
+				_board = Board();
+			} else if (command == "position") {
+				wait();
+				position(tokens);
+			} else if (command == "go") {
+				wait();
+				go(tokens);
+			} else if (command == "ponderhit") {
+				_engine->ponderhit();
+				release();
+			} else if (command == "stop") {
+				_engine->stop();
+				wait();
+			} else if (command == "setoption") {
+				setoption(tokens);
+			} else if (command == "quit") {
+				break;
+			} else {
+				send("info string unknown command " + command);
+			}
+		}
+	}
+};
+
+} // namespace
+
+} // namespace chess
+
+int main() {
+	// The front end holds transposition and pawn tables of several megabytes,
+	// so it lives on the heap rather than the stack.
+	std::unique_ptr<chess::Uci> uci(new chess::Uci());
+	uci->run(std::cin);
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include "src/ai/alpha_beta_engine.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+namespace chess {
+
+/*!
+ * Searches the position described by the FEN string and returns the selected
+ * move in coordinate notation (e.g. e2e4).
+ */
+std::string best_move(const std::string& fen, const SearchOptions& options) {
+	Board board(fen);
+	MoveList moves;
+	board.legal(moves);
+
+	AlphaBetaEngine engine(options);
+	Move move = unpack(engine.select(board, moves));
+	return std::string() + move.cur.file() + std::to_string(move.cur.rank()) +
+		move.nxt.file() + std::to_string(move.nxt.rank());
+}
+
+SearchOptions exhaustive(int depth) {
+	SearchOptions options;
+	options.depth = depth;
+	options.null_move = false;
+	options.late_move_reductions = false;
+	options.reverse_futility = false;
+	options.futility = false;
+	return options;
+}
+
+TEST(AlphaBetaEngineTest, Select_MateInOne) {
+	std::string fen =
+		"r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5Q2/PPPP1PPP/RNB1K1NR w KQkq - 0 1";
+	EXPECT_EQ("f3f7", best_move(fen, exhaustive(3)));
+
+	SearchOptions options;
+	options.depth = 3;
+	EXPECT_EQ("f3f7", best_move(fen, options));
+}
+
+TEST(AlphaBetaEngineTest, Select_WinsHangingQueen) {
+	std::string fen = "4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1";
+	EXPECT_EQ("d2d5", best_move(fen, exhaustive(2)));
+}
+
+TEST(AlphaBetaEngineTest, Select_NoNullMoveInPawnEndings) {
+	// King and pawn endings are riddled with zugzwang, where passing would be
+	// the best move, so null move pruning must never be attempted in them.
+	Board board(std::string("8/8/1p4k1/1P6/8/5K2/6P1/8 w - - 0 1"));
+	MoveList moves;
+	board.legal(moves);
+
+	SearchOptions options;
+	options.depth = 8;
+	AlphaBetaEngine engine(options);
+	engine.select(board, moves);
+	EXPECT_EQ(0, engine.stats().null_tries);
+}
+
+TEST(AlphaBetaEngineTest, Select_HeuristicsReduceNodes) {
+	Board board(std::string(
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+	MoveList moves;
+	board.legal(moves);
+
+	AlphaBetaEngine full(exhaustive(5));
+	full.select(board, moves);
+
+	SearchOptions options;
+	options.depth = 5;
+	AlphaBetaEngine selective(options);
+	selective.select(board, moves);
+
+	EXPECT_LT(selective.stats().nodes, full.stats().nodes);
+	EXPECT_GT(selective.stats().null_tries, 0);
+	EXPECT_GT(selective.stats().lmr_reductions, 0);
+	EXPECT_EQ(0, full.stats().null_tries);
+	EXPECT_EQ(0, full.stats().futility_prunes);
+}
+
+TEST(AlphaBetaEngineTest, Analyse_MultipleLines) {
+	// Only the rook on d2 can capture the queen
+	std::string fen = "4k3/8/8/3q4/8/8/3R4/3RK3 w - - 0 1";
+	Board board(fen);
+	MoveList moves;
+	board.legal(moves);
+
+	AlphaBetaEngine engine(exhaustive(3));
+	std::vector<Line> lines = engine.analyse(board, moves, Limits(), 3);
+	ASSERT_EQ(3, lines.size());
+	EXPECT_EQ("d2d5", notation(lines[0].moves.front()));
+	EXPECT_GE(lines[0].score, lines[1].score);
+	EXPECT_GE(lines[1].score, lines[2].score);
+	EXPECT_NE(lines[0].moves.front(), lines[1].moves.front());
+	EXPECT_NE(lines[1].moves.front(), lines[2].moves.front());
+	EXPECT_EQ(Board(fen).key(), board.key());
+}
+
+} // namespace chess
@@ -0,0 +1,128 @@
+#include "src/ai/struct/board.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+namespace chess {
+
+/*!
+ * Perft counts the leaves of the legal move tree and is the standard way to
+ * validate a move generator. The reference counts below are well known and
+ * exercise castling, en passant, promotion and pins.
+ */
+TEST(BoardTest, Perft_Initial) {
+	Board board;
+	EXPECT_EQ(20, board.perft(1));
+	EXPECT_EQ(400, board.perft(2));
+	EXPECT_EQ(8902, board.perft(3));
+	EXPECT_EQ(197281, board.perft(4));
+}
+
+TEST(BoardTest, Perft_Kiwipete) {
+	Board board(std::string(
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+	EXPECT_EQ(48, board.perft(1));
+	EXPECT_EQ(2039, board.perft(2));
+	EXPECT_EQ(97862, board.perft(3));
+}
+
+TEST(BoardTest, Perft_Enpassant) {
+	Board board(std::string("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"));
+	EXPECT_EQ(2812, board.perft(3));
+	EXPECT_EQ(43238, board.perft(4));
+}
+
+TEST(BoardTest, Perft_Promotion) {
+	Board board(std::string(
+		"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"));
+	EXPECT_EQ(44, board.perft(1));
+	EXPECT_EQ(62379, board.perft(3));
+}
+
+TEST(BoardTest, MakeUndo_RestoresKey) {
+	Board board;
+	uint64_t key = board.key();
+
+	MoveList list;
+	board.legal(list);
+	for (auto move : list) {
+		ASSERT_TRUE(board.make(move));
+		board.undo();
+		EXPECT_EQ(key, board.key());
+	}
+}
+
+TEST(BoardTest, Make_StopsAtMaxPly) {
+	const char* const kShuffle[] = {"g1f3", "g8f6", "f3g1", "f6g8"};
+	Board board;
+	PackedMove first = Board().parse(kShuffle[0]);
+	for (int i = 0; !board.full(); i++)
+		ASSERT_TRUE(board.make(board.parse(kShuffle[i % 4])));
+	EXPECT_EQ(Board::kMaxPly, board.ply());
+
+	uint64_t key = board.key();
+	EXPECT_FALSE(board.make(first));
+	EXPECT_EQ(Board::kMaxPly, board.ply());
+	EXPECT_EQ(key, board.key());
+	board.undo();
+	EXPECT_FALSE(board.full());
+	EXPECT_TRUE(board.make(board.parse("g8f6")));
+}
+
+TEST(BoardTest, Key_Transposition) {
+	// 1. Nf3 Nf6 2. Nc3 and 1. Nc3 Nf6 2. Nf3 reach the same position
+	Board a, b;
+	a.make(pack(Move(MoveType::kDefault, Position("g1"), Position("f3"))));
+	a.make(pack(Move(MoveType::kDefault, Position("g8"), Position("f6"))));
+	a.make(pack(Move(MoveType::kDefault, Position("b1"), Position("c3"))));
+	b.make(pack(Move(MoveType::kDefault, Position("b1"), Position("c3"))));
+	b.make(pack(Move(MoveType::kDefault, Position("g8"), Position("f6"))));
+	b.make(pack(Move(MoveType::kDefault, Position("g1"), Position("f3"))));
+	EXPECT_EQ(a.key(), b.key());
+}
+
+TEST(BoardTest, IsDraw_Repetition) {
+	Board board;
+	Move out(MoveType::kDefault, Position("g1"), Position("f3"));
+	Move in(MoveType::kDefault, Position("f3"), Position("g1"));
+	Move bout(MoveType::kDefault, Position("g8"), Position("f6"));
+	Move bin(MoveType::kDefault, Position("f6"), Position("g8"));
+
+	EXPECT_FALSE(board.is_draw());
+	board.make(pack(out));
+	board.make(pack(bout));
+	board.make(pack(in));
+	board.make(pack(bin));
+	EXPECT_TRUE(board.is_draw());
+}
+
+TEST(BoardTest, PackUnpack) {
+	Move move(MoveType::kPromoteKnight, Position("b7"), Position("a8"));
+	EXPECT_EQ(move, unpack(pack(move)));
+}
+
+TEST(BoardTest, ParseSan) {
+	Board board(std::string("r3k2r/1P6/8/3pP3/8/2N2N2/8/R3K2R w KQkq d6 0 1"));
+	EXPECT_EQ(board.parse("e1g1"), board.parse_san("O-O"));
+	EXPECT_EQ(board.parse("e1c1"), board.parse_san("O-O-O+"));
+	EXPECT_EQ(board.parse("e5d6"), board.parse_san("exd6"));
+	EXPECT_EQ(board.parse("b7a8q"), board.parse_san("bxa8=Q"));
+	EXPECT_EQ(board.parse("b7b8n"), board.parse_san("b8N#"));
+	EXPECT_EQ(board.parse("b7b8q"), board.parse_san("b8"));
+	EXPECT_EQ(board.parse("c3d5"), board.parse_san("Ncxd5"));
+	EXPECT_EQ(board.parse("f3d4"), board.parse_san("Nd4!?"));
+	EXPECT_EQ(board.parse("a1a8"), board.parse_san("Rxa8"));
+
+	EXPECT_EQ(0, board.parse_san("e4"));
+	EXPECT_EQ(0, board.parse_san("Zf3"));
+	EXPECT_EQ(0, board.parse_san(""));
+
+	// Both knights reach e4
+	Board knights(std::string("4k3/8/8/8/8/2N3N1/8/4K3 w - - 0 1"));
+	EXPECT_EQ(0, knights.parse_san("Ne4"));
+	EXPECT_EQ(0, knights.parse_san("N3e4"));
+	EXPECT_EQ(knights.parse("c3e4"), knights.parse_san("Nce4"));
+	EXPECT_EQ(knights.parse("g3e4"), knights.parse_san("Ngxe4"));
+}
+
+} // namespace chess
@@ -0,0 +1,156 @@
+#include "src/ai/book/builder.h"
+#include "src/ai/book_engine.h"
+#include "src/ai/random_engine.h"
+#include "sample_helper.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace chess {
+
+namespace {
+
+/*! Returns the entry of the move from the position, or nullptr. */
+const BookEntry* find(const Book& book, const Board& board,
+		const std::string& text) {
+	Board copy = board;
+	PackedMove move = copy.parse(text);
+	Book::Range range = book.probe(board.key());
+	for (const BookEntry* entry = range.first; entry != range.second; entry++)
+		if (entry->move == move)
+			return entry;
+	return nullptr;
+}
+
+/*! Writes the builder to a temporary file and maps it. */
+void open(const BookBuilder& builder, Book& book) {
+	char path[] = "/tmp/book_testXXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_GE(fd, 0);
+	close(fd);
+	builder.save(path);
+	ASSERT_TRUE(book.open(path));
+	std::remove(path);
+}
+
+} // namespace
+
+TEST(BookTest, Build_AggregatesMovesAndTranspositions) {
+	BookOptions options;
+	options.min_count = 1;
+	BookBuilder builder(options);
+	EXPECT_EQ(3, builder.add(game({"g1f3", "g8f6", "b1c3"}, 1)));
+	EXPECT_EQ(3, builder.add(game({"b1c3", "g8f6", "g1f3"}, -1)));
+	EXPECT_EQ(1, builder.add(game({"e2e4"}, 0, 2400, 0)));
+
+	Book book;
+	open(builder, book);
+	EXPECT_EQ(7u, book.size());
+
+	Board start;
+	Book::Range range = book.probe(start.key());
+	EXPECT_EQ(3, range.second - range.first);
+
+	const BookEntry* e4 = find(book, start, "e2e4");
+	ASSERT_NE(nullptr, e4);
+	EXPECT_EQ(1u, e4->count);
+	EXPECT_EQ(1u, e4->draws);
+	EXPECT_EQ(2400, e4->elo);
+
+	// Both move orders reach the same position after two plies
+	Board after(game({"g1f3", "g8f6"}, 0).moves);
+	Board other(game({"b1c3", "g8f6"}, 0).moves);
+	const BookEntry* nc3 = find(book, after, "b1c3");
+	ASSERT_NE(nullptr, nc3);
+	EXPECT_EQ(1u, nc3->wins);
+	const BookEntry* nf3 = find(book, other, "g1f3");
+	ASSERT_NE(nullptr, nf3);
+	EXPECT_EQ(1u, nf3->losses);
+
+	// Black's reply is counted from black's perspective
+	const BookEntry* nf6 = find(book, Board(game({"g1f3"}, 0).moves), "g8f6");
+	ASSERT_NE(nullptr, nf6);
+	EXPECT_EQ(1u, nf6->count);
+	EXPECT_EQ(1u, nf6->losses);
+	EXPECT_EQ(1800, nf6->elo);
+}
+
+TEST(BookTest, Build_FiltersRareMovesAndShortensGames) {
+	BookOptions options;
+	options.min_count = 2;
+	options.max_plies = 2;
+	BookBuilder builder(options);
+	for (int i = 0; i < 3; i++)
+		builder.add(game({"e2e4", "e7e5", "g1f3"}, 1));
+	builder.add(game({"d2d4"}, 1));
+
+	std::vector<BookEntry> entries = builder.entries();
+	EXPECT_EQ(2u, entries.size());
+	for (const auto& entry : entries)
+		EXPECT_EQ(3u, entry.count);
+	EXPECT_EQ(7u, builder.positions());
+}
+
+TEST(BookTest, Build_StopsAtIllegalMoves) {
+	BookBuilder builder;
+	Sample sample = game({"e2e4", "e7e5"}, 0);
+	sample.moves.insert(sample.moves.begin() + 1, sample.moves[0]);
+	EXPECT_EQ(1, builder.add(sample));
+
+	BookOptions options;
+	options.min_elo = 2500;
+	BookBuilder strong(options);
+	EXPECT_EQ(0, strong.add(game({"e2e4"}, 0)));
+}
+
+TEST(BookTest, Open_RejectsInvalidFiles) {
+	Book book;
+	EXPECT_FALSE(book.open("/nonexistent/book.bin"));
+
+	char path[] = "/tmp/book_testXXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(4, write(fd, "junk", 4));
+	close(fd);
+	EXPECT_FALSE(book.open(path));
+	std::remove(path);
+	EXPECT_EQ(0u, book.size());
+
+	Board start;
+	Book::Range range = book.probe(start.key());
+	EXPECT_EQ(range.first, range.second);
+}
+
+TEST(BookTest, Select_PlaysBookMovesThenFallsBack) {
+	BookOptions options;
+	options.min_count = 1;
+	BookBuilder builder(options);
+	builder.add(game({"e2e4", "e7e5"}, 1));
+	builder.add(game({"d2d4"}, -1));
+
+	Book book;
+	open(builder, book);
+	BookEngine engine(book, std::unique_ptr<Engine>(new RandomEngine(1)), 1);
+
+	// The move that always lost is never chosen
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+	for (int i = 0; i < 20; i++)
+		EXPECT_EQ(board.parse("e2e4"), engine.select(board, moves, Limits()));
+	EXPECT_EQ(20u, engine.hits());
+
+	board.make(board.parse("e2e4"));
+	board.make(board.parse("e7e5"));
+	moves.size = 0;
+	board.legal(moves);
+	EXPECT_NE(0, engine.select(board, moves, Limits()));
+	EXPECT_EQ(20u, engine.hits());
+}
+
+} // namespace chess
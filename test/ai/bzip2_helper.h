@@ -0,0 +1,40 @@
+#ifndef BZIP2_HELPER_H
+#define BZIP2_HELPER_H
+
+#include "gtest/gtest.h"
+
+#include <bzlib.h>
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+/*! Bzip2 test helpers
+ * The bzip2 decoders are tested against data compressed by libbz2 itself,
+ * and read through an istream, as the parser reads them.
+ */
+
+/*! Compresses the text into a single bzip2 stream of blocks of level 100 kB. */
+inline std::string compress(const std::string& text, int level = 9) {
+	std::vector<char> out(text.size() + text.size() / 100 + 600);
+	unsigned int size = static_cast<unsigned int>(out.size());
+	std::string in(text);
+	EXPECT_EQ(BZ_OK, BZ2_bzBuffToBuffCompress(out.data(), &size, &in[0],
+		static_cast<unsigned int>(in.size()), level, 0, 0));
+	return std::string(out.data(), size);
+}
+
+/*! Reads the whole stream, through the istream so that errors set badbit. */
+inline std::string read(std::istream& in) {
+	std::string text;
+	char buffer[4096];
+	while (in.read(buffer, sizeof(buffer)) || in.gcount())
+		text.append(buffer, in.gcount());
+	return text;
+}
+
+} // namespace chess
+
+#endif // BZIP2_HELPER_H
@@ -0,0 +1,83 @@
+#include "src/ai/parse/bzip2_stream.h"
+#include "src/ai/parse/parser.h"
+#include "bzip2_helper.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*! Returns some text that compresses well but not trivially. */
+std::string text(int lines) {
+	std::string text;
+	for (int i = 0; i < lines; i++)
+		text += "1. e4 e5 2. Nf3 Nc6 " + std::to_string(i * 7919 % 1000) + "\n";
+	return text;
+}
+
+} // namespace
+
+TEST(Bzip2StreamTest, Read_Decompresses) {
+	std::string original = text(20000);
+	std::istringstream source(compress(original));
+	Bzip2Stream in(source);
+	EXPECT_EQ(original, read(in));
+	EXPECT_FALSE(in.bad());
+}
+
+TEST(Bzip2StreamTest, Read_SmallBuffersAndConcatenatedStreams) {
+	std::string first = text(300), second = "[Event \"second\"]\n";
+	std::istringstream source(compress(first) + compress(second));
+	Bzip2Buffer buffer(source, 7);
+	std::istream in(&buffer);
+	EXPECT_EQ(first + second, read(in));
+}
+
+TEST(Bzip2StreamTest, Compressed_DetectsWithoutConsuming) {
+	std::istringstream compressed(compress("abc"));
+	EXPECT_TRUE(Bzip2Buffer::compressed(compressed));
+	Bzip2Stream in(compressed);
+	EXPECT_EQ("abc", read(in));
+
+	std::istringstream plain("[Event");
+	EXPECT_FALSE(Bzip2Buffer::compressed(plain));
+	EXPECT_EQ("[Event", read(plain));
+
+	std::istringstream empty("");
+	EXPECT_FALSE(Bzip2Buffer::compressed(empty));
+}
+
+TEST(Bzip2StreamTest, Read_CorruptOrTruncatedDataFails) {
+	std::string data = compress(text(1000));
+	std::istringstream truncated(data.substr(0, data.size() / 2));
+	Bzip2Stream short_stream(truncated);
+	read(short_stream);
+	EXPECT_TRUE(short_stream.bad());
+
+	data[data.size() / 2] ^= 0x55;
+	std::istringstream corrupt(data);
+	Bzip2Stream bad_stream(corrupt);
+	read(bad_stream);
+	EXPECT_TRUE(bad_stream.bad());
+}
+
+TEST(Bzip2StreamTest, Parse_CompressedGames) {
+	std::string pgn;
+	for (int i = 0; i < 100; i++)
+		pgn += "[Result \"0-1\"]\n\n1. f3 e5 2. g4 Qh4# 0-1\n\n";
+	std::istringstream source(compress(pgn));
+	Bzip2Stream in(source);
+
+	std::stringstream out;
+	std::ostringstream log;
+	Parser parser(out, log, 3);
+	ParseStats stats = parser.parse(in);
+	EXPECT_EQ(100u, stats.games);
+	EXPECT_EQ(pgn.size(), stats.bytes);
+}
+
+} // namespace chess
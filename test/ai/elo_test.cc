@@ -0,0 +1,85 @@
+#include "src/ai/match/elo.h"
+#include "gtest/gtest.h"
+
+namespace chess {
+
+TEST(EloTest, Elo_Score) {
+	Score even;
+	even.wins = 10;
+	even.losses = 10;
+	EXPECT_NEAR(0.0, elo(even), 1e-9);
+
+	// A score of 75% corresponds to a difference of about 191 Elo
+	Score strong;
+	strong.wins = 75;
+	strong.losses = 25;
+	EXPECT_NEAR(190.85, elo(strong), 0.01);
+
+	Score weak;
+	weak.wins = 25;
+	weak.losses = 75;
+	EXPECT_NEAR(-elo(strong), elo(weak), 1e-9);
+
+	Score perfect;
+	perfect.wins = 5;
+	EXPECT_EQ(1000.0, elo(perfect));
+}
+
+TEST(EloTest, EloError_ShrinksWithGames) {
+	Score few, many;
+	few.add(1);
+	few.add(0);
+	few.add(-1);
+	for (int i = 0; i < 100; i++) {
+		many.add(1);
+		many.add(0);
+		many.add(-1);
+	}
+	EXPECT_GT(elo_error(few), elo_error(many));
+	EXPECT_GT(elo_error(many), 0.0);
+}
+
+TEST(EloTest, Sprt_Decide) {
+	Sprt sprt(0.0, 10.0, 0.05, 0.05);
+	EXPECT_NEAR(-2.944, sprt.lower(), 0.001);
+	EXPECT_NEAR(2.944, sprt.upper(), 0.001);
+
+	Score undecided;
+	undecided.wins = 5;
+	undecided.draws = 5;
+	undecided.losses = 5;
+	EXPECT_EQ(0, sprt.decide(undecided));
+
+	Score better;
+	better.wins = 600;
+	better.draws = 200;
+	better.losses = 400;
+	EXPECT_EQ(1, sprt.decide(better));
+
+	Score worse;
+	worse.wins = 400;
+	worse.draws = 200;
+	worse.losses = 600;
+	EXPECT_EQ(-1, sprt.decide(worse));
+}
+
+TEST(EloTest, Sprt_DecidesOneSidedMatches) {
+	Sprt sprt(0.0, 10.0, 0.05, 0.05);
+	Score wins;
+	wins.wins = 1;
+	EXPECT_GT(sprt.llr(wins), 0.0);
+	EXPECT_EQ(0, sprt.decide(wins));
+	wins.wins = 20;
+	EXPECT_EQ(1, sprt.decide(wins));
+
+	Score losses;
+	losses.losses = 20;
+	EXPECT_EQ(-1, sprt.decide(losses));
+
+	Score draws;
+	draws.draws = 400;
+	EXPECT_LT(sprt.llr(draws), 0.0);
+	EXPECT_EQ(-1, sprt.decide(draws));
+}
+
+} // namespace chess
@@ -0,0 +1,65 @@
+#include "src/ai/eval/evaluation.h"
+#include "src/ai/struct/board.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+
+namespace chess {
+
+/*!
+ * Recomputes the midgame and endgame sums of the board from scratch, so that
+ * the incrementally maintained values can be checked against them.
+ */
+void recompute(const Board& board, int& mg, int& eg) {
+	mg = eg = 0;
+	for (int sq = 0; sq < 64; sq++) {
+		if (board.at(sq)) {
+			mg += midgame(board.at(sq), sq);
+			eg += endgame(board.at(sq), sq);
+		}
+	}
+}
+
+TEST(EvaluationTest, Evaluate_InitialIsBalanced) {
+	Board board;
+	EXPECT_EQ(0, evaluate(board));
+	EXPECT_EQ(kMaxPhase, board.phase());
+}
+
+TEST(EvaluationTest, Evaluate_Symmetric) {
+	// The same position with colors reversed scores the same for the side to
+	// move.
+	Board white(std::string("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1"));
+	Board black(std::string("4k3/3r4/8/8/3Q4/8/8/4K3 b - - 0 1"));
+	EXPECT_EQ(evaluate(white), evaluate(black));
+	EXPECT_LT(evaluate(white), 0);
+}
+
+TEST(EvaluationTest, MakeUndo_Incremental) {
+	Board board(std::string(
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+	int initial = evaluate(board);
+	std::mt19937 prng(7);
+
+	// Play random games and compare the incremental sums with a full rescan
+	// after every move (including castles, promotions and en passant).
+	for (int ply = 0; ply < 200; ply++) {
+		MoveList list;
+		board.legal(list);
+		if (!list.size)
+			break;
+		board.make(list[prng() % list.size]);
+
+		int mg, eg;
+		recompute(board, mg, eg);
+		ASSERT_EQ(mg, board.midgame());
+		ASSERT_EQ(eg, board.endgame());
+	}
+
+	while (board.ply())
+		board.undo();
+	EXPECT_EQ(initial, evaluate(board));
+}
+
+} // namespace chess
@@ -0,0 +1,94 @@
+#include "src/ai/markov_engine.h"
+#include "sample_helper.h"
+#include "gtest/gtest.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+TEST(MarkovChainTest, Next_FollowsWeights) {
+	MarkovChain chain(1);
+	EXPECT_TRUE(chain.add(7, 1, 1.0f));
+	EXPECT_TRUE(chain.add(7, 2, 2.0f));
+	EXPECT_TRUE(chain.add(7, 2, 1.0f));
+	EXPECT_TRUE(chain.add(9, 3, 0.5f));
+	chain.compile();
+	EXPECT_EQ(3u, chain.size());
+	EXPECT_EQ(2u, chain.states());
+	EXPECT_NEAR(0.25, chain.probability(7, 1), 1e-6);
+	EXPECT_NEAR(0.75, chain.probability(7, 2), 1e-6);
+	EXPECT_NEAR(1.0, chain.probability(9, 3), 1e-6);
+
+	std::mt19937 prng(1);
+	std::map<PackedMove, int> counts;
+	for (int i = 0; i < 40000; i++)
+		counts[chain.next(7, prng)]++;
+	EXPECT_EQ(2u, counts.size());
+	EXPECT_NEAR(0.75, counts[2] / 40000.0, 0.01);
+	EXPECT_EQ(3, chain.next(9, prng));
+	EXPECT_EQ(0, chain.next(8, prng));
+}
+
+TEST(MarkovChainTest, Compile_AliasTablesMatchWeights) {
+	MarkovChain chain(1);
+	std::mt19937 prng(5);
+	std::uniform_real_distribution<float> weight(0.1f, 10.0f);
+	std::vector<float> weights(40);
+	double total = 0;
+	for (size_t i = 0; i < weights.size(); i++) {
+		weights[i] = weight(prng);
+		total += weights[i];
+		chain.add(42, static_cast<PackedMove>(i + 1), weights[i]);
+	}
+	chain.compile();
+
+	double sum = 0;
+	for (size_t i = 0; i < weights.size(); i++) {
+		double probability = chain.probability(42, static_cast<PackedMove>(i + 1));
+		EXPECT_NEAR(weights[i] / total, probability, 1e-5);
+		sum += probability;
+	}
+	EXPECT_NEAR(1.0, sum, 1e-5);
+}
+
+TEST(MarkovChainTest, Add_StaysWithinBudget) {
+	MarkovChain chain(1);
+	size_t added = 0;
+	for (uint64_t key = 1; key <= 100000; key++)
+		added += chain.add(key * 0x9E3779B97F4A7C15ull, 1, 1.0f);
+	EXPECT_EQ(added, chain.size());
+	EXPECT_LT(added, 100000u);
+	EXPECT_EQ(100000u - added, chain.dropped());
+
+	// Known transitions keep accumulating once the table is full
+	EXPECT_TRUE(chain.add(0x9E3779B97F4A7C15ull, 1, 1.0f));
+	chain.compile();
+	EXPECT_EQ(added, chain.states());
+}
+
+TEST(MarkovEngineTest, Select_PlaysTrainedMoves) {
+	MarkovChain chain(1);
+	EXPECT_EQ(2, MarkovEngine::train(chain, game({"e2e4", "e7e5"}, 1, 0, 0), 10));
+	EXPECT_EQ(1, MarkovEngine::train(chain, game({"d2d4", "d7d5"}, -1, 0, 0), 1));
+	chain.compile();
+
+	// Only the move that scored points is played, and black's losing reply
+	// to e4 is never learned
+	MarkovEngine engine(chain, 3);
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+	for (int i = 0; i < 20; i++)
+		EXPECT_EQ(board.parse("e2e4"), engine.select(board, moves, Limits()));
+	EXPECT_EQ(20u, engine.hits());
+
+	board.make(board.parse("e2e4"));
+	moves.size = 0;
+	board.legal(moves);
+	EXPECT_NE(0, engine.select(board, moves, Limits()));
+	EXPECT_EQ(20u, engine.hits());
+}
+
+} // namespace chess
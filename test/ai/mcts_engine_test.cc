@@ -0,0 +1,84 @@
+#include "src/ai/mcts_engine.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+namespace chess {
+
+/*!
+ * Searches the position described by the FEN string and returns the selected
+ * move in coordinate notation (e.g. e2e4).
+ */
+std::string mcts_move(const std::string& fen, const MctsOptions& options) {
+	Board board(fen);
+	MoveList moves;
+	board.legal(moves);
+
+	MctsEngine engine(options);
+	return notation(engine.select(board, moves));
+}
+
+TEST(MctsEngineTest, Select_WinsHangingQueen) {
+	MctsOptions options;
+	options.playouts = 3000;
+	options.seed = 1;
+	EXPECT_EQ("d2d5", mcts_move("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1", options));
+
+	options.puct = true;
+	EXPECT_EQ("d2d5", mcts_move("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1", options));
+}
+
+TEST(MctsEngineTest, Select_ReusesSubtree) {
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+
+	MctsOptions options;
+	options.playouts = 2000;
+	options.seed = 1;
+	MctsEngine engine(options);
+	PackedMove move = engine.select(board, moves);
+	EXPECT_EQ(0, engine.stats().reused);
+
+	// Play the engine's move and the reply it explored most
+	board.make(move);
+	const SearchTree& tree = engine.tree();
+	uint32_t node = tree.child(0, move), first = tree[node].first.load();
+	uint32_t reply = first;
+	for (uint32_t i = first; i < first + tree[node].size; i++)
+		if (tree[i].visits.load() > tree[reply].visits.load())
+			reply = i;
+	uint32_t visits = tree[reply].visits.load();
+	board.make(tree[reply].move);
+
+	MoveList next;
+	board.legal(next);
+	engine.select(board, next);
+	EXPECT_GT(visits, 0);
+	EXPECT_EQ(visits, engine.stats().reused);
+	EXPECT_EQ(visits + 2000, engine.tree()[0].visits.load());
+}
+
+TEST(MctsEngineTest, Select_Parallel) {
+	Board board(std::string("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1"));
+	MoveList moves;
+	board.legal(moves);
+
+	MctsOptions options;
+	options.playouts = 4000;
+	options.threads = 4;
+	options.seed = 1;
+	MctsEngine engine(options);
+	EXPECT_EQ("d2d5", notation(engine.select(board, moves)));
+
+	// Every playout is counted exactly once, at the root and at one child
+	const SearchTree& tree = engine.tree();
+	uint32_t visits = 0, first = tree[0].first.load();
+	for (uint32_t i = first; i < first + tree[0].size; i++)
+		visits += tree[i].visits.load();
+	EXPECT_EQ(4000, engine.stats().playouts);
+	EXPECT_EQ(4000, tree[0].visits.load());
+	EXPECT_EQ(4000, visits);
+}
+
+} // namespace chess
@@ -0,0 +1,85 @@
+#include "src/ai/parse/move_codec.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*! Plays a game of random legal moves. */
+std::vector<Move> random_game(uint32_t seed, int plies) {
+	std::mt19937 prng(seed);
+	std::vector<Move> moves;
+	Board board;
+	for (int ply = 0; ply < plies; ply++) {
+		MoveList list;
+		board.legal(list);
+		if (!list.size)
+			break;
+		PackedMove move = list[prng() % list.size];
+		board.make(move);
+		moves.push_back(unpack(move));
+	}
+	return moves;
+}
+
+} // namespace
+
+TEST(MoveCodecTest, Rank_OrdersEveryLegalMoveBestFirst) {
+	Board board(std::string(
+		"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2"));
+	MoveList legal, ranked;
+	board.legal(legal);
+	MoveCodec::rank(board, ranked);
+	ASSERT_EQ(legal.size, ranked.size);
+	EXPECT_EQ("e4d5", notation(ranked[0]));
+}
+
+TEST(MoveCodecTest, Decode_RoundTripsGames) {
+	for (auto coding : {MoveCodec::kFixed, MoveCodec::kRange}) {
+		MoveCodec codec(coding);
+		std::string data;
+		std::vector<std::vector<Move>> games;
+		for (uint32_t seed = 0; seed < 20; seed++) {
+			games.push_back(random_game(seed, 300));
+			codec.encode(games.back(), data);
+		}
+		games.push_back(std::vector<Move>());
+		codec.encode(games.back(), data);
+
+		size_t position = 0, moves = 0;
+		std::vector<Move> decoded;
+		for (const auto& game : games) {
+			position += codec.decode(data.data() + position,
+				data.size() - position, decoded);
+			EXPECT_EQ(game, decoded);
+			moves += game.size();
+		}
+		EXPECT_EQ(data.size(), position);
+		EXPECT_LT(data.size(), moves);
+	}
+}
+
+TEST(MoveCodecTest, Decode_CorruptOrIllegalFails) {
+	MoveCodec codec(MoveCodec::kFixed);
+	std::vector<Move> moves = random_game(1, 40), decoded;
+	std::string data;
+	codec.encode(moves, data);
+	EXPECT_THROW(codec.decode(data.data(), data.size() / 2, decoded),
+		std::runtime_error);
+
+	MoveCodec range(MoveCodec::kRange);
+	data.clear();
+	range.encode(moves, data);
+	EXPECT_THROW(range.decode(data.data(), data.size() - 1, decoded),
+		std::runtime_error);
+
+	moves.insert(moves.begin(), moves[1]);
+	EXPECT_THROW(codec.encode(moves, data), std::invalid_argument);
+}
+
+} // namespace chess
@@ -0,0 +1,120 @@
+#include "src/ai/parse/parallel_bzip2.h"
+#include "bzip2_helper.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*! Returns text of the specified size that compresses about as well as PGN. */
+std::string text(size_t size, uint32_t seed) {
+	static const char* const kMoves[] = {"e4", "e5", "Nf3", "Nc6", "Bb5", "a6",
+		"O-O", "d6", "c3", "Bg4", "h3", "Qxd8+", "Rxe1#", "1-0\n\n"};
+	std::mt19937 prng(seed);
+	std::uniform_int_distribution<int> move(0, 13);
+	std::string text;
+	for (int i = 1; text.size() < size; i++)
+		text += std::to_string(i) + ". " + kMoves[move(prng)] + " " +
+			kMoves[move(prng)] + " ";
+	text.resize(size);
+	return text;
+}
+
+/*! Decompresses the data with the specified threads and chunk size. */
+std::string decompress(const std::string& data, int threads, size_t chunk,
+		bool& bad) {
+	std::istringstream source(data);
+	ParallelBzip2Buffer buffer(source, threads, chunk);
+	std::istream in(&buffer);
+	std::string text = read(in);
+	bad = in.bad();
+	return text;
+}
+
+} // namespace
+
+TEST(ParallelBzip2Test, Read_MatchesInputForAnyThreadsAndChunks) {
+	std::string original = text(1500000, 1);
+	std::string data = compress(original, 1);
+	bool bad;
+	EXPECT_EQ(original, decompress(data, 1, 1 << 20, bad));
+	EXPECT_FALSE(bad);
+	EXPECT_EQ(original, decompress(data, 4, 1 << 20, bad));
+	EXPECT_FALSE(bad);
+	EXPECT_EQ(original, decompress(data, 3, 999, bad));
+	EXPECT_FALSE(bad);
+}
+
+TEST(ParallelBzip2Test, Read_ConcatenatedStreamsOfAnyLevel) {
+	std::string first = text(250000, 2), second = text(10, 3), third = text(0, 4);
+	std::string data = compress(first, 1) + compress(second, 9) +
+		compress(third, 5) + compress(first, 2);
+	bool bad;
+	EXPECT_EQ(first + second + third + first, decompress(data, 2, 4096, bad));
+	EXPECT_FALSE(bad);
+
+	std::istringstream empty("");
+	ParallelBzip2Stream in(empty);
+	EXPECT_EQ("", read(in));
+	EXPECT_FALSE(in.bad());
+}
+
+TEST(ParallelBzip2Test, Read_ChunkEndsBeforeFirstMagicOfStream) {
+	// A chunk that ends within the first block magic of a stream, just after
+	// the stream header, must not lose the magic
+	std::string first = text(1000, 6), second = text(2000, 7),
+		third = text(3000, 8);
+	std::string head = compress(first, 9) + compress(second, 9);
+	std::string data = head + compress(third, 9);
+	for (size_t extra = 2; extra <= 10; extra++) {
+		bool bad;
+		EXPECT_EQ(first + second + third,
+			decompress(data, 1, head.size() + extra, bad)) << extra;
+		EXPECT_FALSE(bad);
+	}
+}
+
+TEST(ParallelBzip2Test, Read_BlockSplitByFalseMagic) {
+	// The bitmap of the bytes used by a block, near its beginning, holds 16
+	// bits per group of 16 byte values; bytes 0x80 to 0xaf are chosen so that
+	// the bitmaps of their groups spell the magic number of a block
+	const uint16_t kMagic[] = {0x3141, 0x5926, 0x5359};
+	std::string bytes;
+	for (int group = 0; group < 3; group++)
+		for (int bit = 0; bit < 16; bit++)
+			if (kMagic[group] & (0x8000 >> bit))
+				bytes += static_cast<char>(0x80 + group * 16 + bit);
+
+	// The split block is the second of the stream, so that with small chunks
+	// it ends a batch before the rest of it is read
+	std::string original = text(120000, 9) + bytes + text(150000, 10);
+	std::string data = compress(original, 1);
+	for (int threads : {1, 2, 3}) {
+		for (size_t chunk : {size_t(999), size_t(1) << 20}) {
+			bool bad;
+			EXPECT_EQ(original, decompress(data, threads, chunk, bad));
+			EXPECT_FALSE(bad);
+		}
+	}
+}
+
+TEST(ParallelBzip2Test, Read_CorruptOrTruncatedDataFails) {
+	std::string data = compress(text(400000, 5), 1);
+	bool bad;
+	decompress(data.substr(0, data.size() * 2 / 3), 2, 1 << 16, bad);
+	EXPECT_TRUE(bad);
+
+	data[data.size() / 2] ^= 0x10;
+	decompress(data, 2, 1 << 16, bad);
+	EXPECT_TRUE(bad);
+
+	decompress("[Event \"plain text\"]\n", 2, 1 << 16, bad);
+	EXPECT_TRUE(bad);
+}
+
+} // namespace chess
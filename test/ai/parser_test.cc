@@ -0,0 +1,173 @@
+#include "src/ai/parse/bzip2_stream.h"
+#include "src/ai/parse/parser.h"
+#include "src/ai/parse/sample_file.h"
+#include "bzip2_helper.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace chess {
+
+namespace {
+
+const char kGames[] =
+	"[Event \"FICS rated blitz game\"]\n"
+	"[WhiteElo \"1850\"]\n"
+	"[BlackElo \"1790\"]\n"
+	"[Result \"1-0\"]\n"
+	"\n"
+	"1. e4 e5 2. Nf3 Nc6 3. Bc4 Nf6 4. Ng5 d5 5. exd5 Nxd5 6. Nxf7 Kxf7\n"
+	"7. Qf3+ Ke6 {Black resigns} 1-0\n"
+	"\n"
+	"[Event \"FICS rated blitz game\"]\r\n"
+	"[Result \"1/2-1/2\"]\r\n"
+	"\r\n"
+	"1. d4 d5 2. c4 e6 3. Nc3 {book} 3... Nf6 1/2-1/2\r\n"
+	"\n"
+	"[Event \"FICS rated blitz game\"]\n"
+	"[WhiteElo \"1500\"]\n"
+	"[BlackElo \"1600\"]\n"
+	"[Result \"0-1\"]\n"
+	"\n"
+	"1. e4 e5 2. Ke3 0-1\n";
+
+/*!
+ * Parses the games, from a stream or from a mapped file, and reads the samples
+ * back, fewest moves first.
+ */
+std::vector<Sample> parse(const std::string& pgn, int threads,
+		ParseStats& stats, bool mapped = false,
+		size_t batch = Parser::kBatchBytes) {
+	std::stringstream out;
+	std::ostringstream log;
+	{
+		Parser parser(out, log, threads, batch);
+		if (mapped) {
+			char path[] = "/tmp/parser_testXXXXXX";
+			int fd = mkstemp(path);
+			EXPECT_EQ(static_cast<ssize_t>(pgn.size()),
+				write(fd, pgn.data(), pgn.size()));
+			close(fd);
+			stats = parser.parse_file(path);
+			unlink(path);
+		} else {
+			std::istringstream in(pgn);
+			stats = parser.parse(in);
+		}
+	}
+
+	std::vector<Sample> samples;
+	SampleReader reader(out);
+	Sample sample;
+	while (reader.read(sample))
+		samples.push_back(sample);
+	EXPECT_EQ(stats.games, samples.size());
+	std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) {
+		return a.moves.size() < b.moves.size();
+	});
+	return samples;
+}
+
+} // namespace
+
+TEST(ParserTest, Parse_SplitsAndParsesGames) {
+	ParseStats stats;
+	std::vector<Sample> samples = parse(kGames, 2, stats);
+	EXPECT_EQ(2u, stats.games);
+	EXPECT_EQ(1u, stats.errors);
+	EXPECT_EQ(sizeof(kGames) - 1, stats.bytes);
+	ASSERT_EQ(2u, samples.size());
+
+	EXPECT_EQ(6u, samples[0].moves.size());
+	EXPECT_EQ(0, samples[0].result);
+	EXPECT_EQ(0, samples[0].white_elo);
+	EXPECT_EQ(0, samples[0].black_elo);
+
+	EXPECT_EQ(14u, samples[1].moves.size());
+	EXPECT_EQ(1, samples[1].result);
+	EXPECT_EQ(1850, samples[1].white_elo);
+	EXPECT_EQ(1790, samples[1].black_elo);
+}
+
+TEST(ParserTest, Parse_ManyGamesManyThreads) {
+	std::string pgn;
+	for (int i = 0; i < 200; i++)
+		pgn += "[Result \"1-0\"]\n\n1. f3 e5 2. g4 Qh4 1-0\n\n";
+
+	ParseStats stats;
+	std::vector<Sample> samples = parse(pgn, 8, stats);
+	EXPECT_EQ(200u, stats.games);
+	EXPECT_EQ(0u, stats.errors);
+	for (const auto& sample : samples)
+		EXPECT_EQ(4u, sample.moves.size());
+}
+
+TEST(ParserTest, Parse_BatchesOfAnySize) {
+	std::string pgn;
+	for (int i = 0; i < 50; i++)
+		pgn += kGames;
+
+	for (bool mapped : {false, true}) {
+		for (size_t batch : {size_t(0), size_t(1000), size_t(1) << 20}) {
+			ParseStats stats;
+			std::vector<Sample> samples = parse(pgn, 3, stats, mapped, batch);
+			EXPECT_EQ(100u, stats.games);
+			EXPECT_EQ(50u, stats.errors);
+			ASSERT_EQ(100u, samples.size());
+			EXPECT_EQ(6u, samples.front().moves.size());
+			EXPECT_EQ(14u, samples.back().moves.size());
+		}
+	}
+}
+
+TEST(ParserTest, Parse_FailedInputThrows) {
+	std::string pgn;
+	for (int i = 0; i < 2000; i++)
+		pgn += kGames;
+	std::string data = compress(pgn);
+	std::istringstream source(data.substr(0, data.size() / 2));
+	Bzip2Stream in(source);
+
+	std::stringstream out;
+	std::ostringstream log;
+	Parser parser(out, log, 2);
+	EXPECT_THROW(parser.parse(in), std::runtime_error);
+	EXPECT_NE(std::string::npos, log.str().find("input failed"));
+}
+
+TEST(ParserTest, Parse_EmptyInput) {
+	ParseStats stats;
+	EXPECT_TRUE(parse("", 4, stats).empty());
+	EXPECT_EQ(0u, stats.games);
+	EXPECT_TRUE(parse("", 4, stats, true).empty());
+	EXPECT_EQ(0u, stats.games);
+}
+
+TEST(ParserTest, ParseFile_MatchesStream) {
+	ParseStats streamed, mapped;
+	std::string pgn = std::string(kGames) + "\r\n[Result \"*\"]\n1. e4 *";
+	std::vector<Sample> expected = parse(pgn, 3, streamed);
+	std::vector<Sample> samples = parse(pgn, 3, mapped, true);
+	EXPECT_EQ(3u, mapped.games);
+	EXPECT_EQ(streamed.games, mapped.games);
+	EXPECT_EQ(streamed.errors, mapped.errors);
+	EXPECT_EQ(pgn.size(), mapped.bytes);
+	ASSERT_EQ(expected.size(), samples.size());
+	for (size_t i = 0; i < samples.size(); i++) {
+		EXPECT_EQ(expected[i].moves, samples[i].moves);
+		EXPECT_EQ(expected[i].result, samples[i].result);
+		EXPECT_EQ(expected[i].white_elo, samples[i].white_elo);
+	}
+
+	std::ostringstream out, log;
+	Parser parser(out, log, 1);
+	EXPECT_THROW(parser.parse_file("/nonexistent/games.pgn"), std::runtime_error);
+}
+
+} // namespace chess
@@ -0,0 +1,53 @@
+#include "src/ai/eval/pawn_table.h"
+#include "src/ai/struct/board.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+namespace chess {
+
+TEST(PawnTableTest, Probe_CachesStructure) {
+	PawnTable pawns(1);
+	Board board;
+
+	pawns.probe(board);
+	EXPECT_EQ(0, pawns.hits());
+	EXPECT_EQ(1, pawns.misses());
+
+	// Knight moves leave the pawn structure, and therefore the key, unchanged
+	board.make(pack(Move(MoveType::kDefault, Position("g1"), Position("f3"))));
+	pawns.probe(board);
+	EXPECT_EQ(1, pawns.hits());
+	EXPECT_DOUBLE_EQ(0.5, pawns.hit_rate());
+}
+
+TEST(PawnTableTest, PawnKey_OnlyPawns) {
+	Board a(std::string("4k3/pp6/8/8/8/8/PP6/4K3 w - - 0 1"));
+	Board b(std::string("r3k3/pp6/8/8/8/8/PP6/1N2K3 w - - 0 1"));
+	Board c(std::string("4k3/p7/1p6/8/8/8/PP6/4K3 w - - 0 1"));
+	EXPECT_EQ(a.pawn_key(), b.pawn_key());
+	EXPECT_NE(a.pawn_key(), c.pawn_key());
+}
+
+TEST(PawnTableTest, Probe_Symmetric) {
+	PawnTable pawns(1);
+	Board board;
+	EXPECT_EQ(0, pawns.probe(board).midgame);
+	EXPECT_EQ(0, pawns.probe(board).endgame);
+}
+
+TEST(PawnTableTest, Probe_PassedPawn) {
+	// White's a-pawn is passed; black's h-pawn is blocked by white's g-pawn
+	PawnTable pawns(1);
+	Board board(std::string("4k3/7p/8/P7/8/6P1/8/4K3 w - - 0 1"));
+	EXPECT_GT(pawns.probe(board).endgame, 0);
+}
+
+TEST(PawnTableTest, Probe_DoubledIsolated) {
+	PawnTable pawns(1);
+	Board healthy(std::string("4k3/8/8/8/8/8/3PP3/4K3 w - - 0 1"));
+	Board doubled(std::string("4k3/8/8/8/8/4P3/4P3/4K3 w - - 0 1"));
+	EXPECT_LT(pawns.probe(doubled).endgame, pawns.probe(healthy).endgame);
+}
+
+} // namespace chess
@@ -0,0 +1,70 @@
+#include "src/ai/parse/pgn_lexer.h"
+#include "src/ai/struct/board.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+/*! Lexes the text into a list of tokens, each prefixed by its type. */
+std::vector<std::string> lex(const std::string& text) {
+	static const char kTypes[] = "TMR";
+	std::vector<std::string> tokens;
+	PgnLexer lexer(text);
+	PgnToken token;
+	while (lexer.next(token)) {
+		std::string lexed(1, kTypes[token.type]);
+		lexed += std::string(token.text, token.length);
+		if (token.type == PgnToken::kTag)
+			lexed += "=" + std::string(token.value, token.value_length);
+		tokens.push_back(lexed);
+	}
+	return tokens;
+}
+
+} // namespace
+
+TEST(PgnLexerTest, Next_TagsMovesAndResult) {
+	std::vector<std::string> expected = {"TEvent=FICS rated", "TWhiteElo=1850",
+		"Me4", "Me5", "MNf3", "MNc6", "MO-O", "R1-0"};
+	EXPECT_EQ(expected, lex("[Event \"FICS rated\"]\n[WhiteElo \"1850\"]\n\n"
+		"1. e4 e5 2.Nf3 2... Nc6 3. O-O 1-0\n"));
+}
+
+TEST(PgnLexerTest, Next_SkipsCommentsGlyphsAndVariations) {
+	std::vector<std::string> expected = {"Me4", "Me5!?", "MNf3", "MNc6",
+		"M0-0-0", "R1/2-1/2"};
+	EXPECT_EQ(expected, lex("% escaped line\n1. e4 {a comment (with a paren}"
+		" e5!? $14 ; rest of line e6\n2. Nf3 (2. Nc3 (2. f4 {)} exf4) Nf6) !"
+		" Nc6 $1 3. 0-0-0 1/2-1/2"));
+}
+
+TEST(PgnLexerTest, Next_EscapedAndMalformedTags) {
+	std::vector<std::string> expected = {"TWhite=a \\\"b\\\"", "TBlack=",
+		"R*"};
+	EXPECT_EQ(expected, lex("[White \"a \\\"b\\\"\"]\n[Site unquoted]\n"
+		"[Round \"unterminated\n[Black \"\"]\n*"));
+	EXPECT_TRUE(lex("").empty());
+	EXPECT_TRUE(lex(" {unterminated comment").empty());
+}
+
+TEST(PgnLexerTest, Next_TokensResolveWithoutCopies) {
+	std::string text = "1. e4 e5 2. Nf3 Nc6 3. Bb5 a6 4. Bxc6 dxc6 5. O-O f6+";
+	PgnLexer lexer(text);
+	PgnToken token;
+	Board board;
+	int moves = 0;
+	while (lexer.next(token)) {
+		PackedMove move = board.parse_san(token.text, token.length);
+		ASSERT_TRUE(move) << std::string(token.text, token.length);
+		board.make(move);
+		moves++;
+	}
+	EXPECT_EQ(10, moves);
+	EXPECT_EQ(text.size(), lexer.offset());
+}
+
+} // namespace chess
@@ -0,0 +1,49 @@
+#include "src/ai/search/playout.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+namespace chess {
+
+TEST(PlayoutTest, Play_RestoresBoard) {
+	// Black has a bare king and can never win
+	Board board(std::string("7k/8/6K1/8/8/8/8/R7 w - - 0 1"));
+	Playout playout(7);
+	for (int i = 0; i < 100; i++) {
+		int result = playout.play(board);
+		EXPECT_TRUE(result == 1 || result == 0);
+		playout.rewind(board);
+	}
+	EXPECT_EQ(Board(std::string("7k/8/6K1/8/8/8/8/R7 w - - 0 1")).key(),
+		board.key());
+}
+
+TEST(PlayoutTest, Play_NoLegalMoves) {
+	Playout playout(1);
+	Board mated(std::string("R6k/6pp/8/8/8/8/8/6K1 b - - 0 1"));
+	EXPECT_EQ(1, playout.play(mated));
+	EXPECT_EQ(0, playout.plies());
+
+	Board stalemate(std::string("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"));
+	EXPECT_EQ(0, playout.play(stalemate));
+}
+
+TEST(PlayoutTest, Play_Limit) {
+	Board board;
+	Playout playout(1);
+	EXPECT_EQ(Playout::kUnfinished, playout.play(board, 10));
+	EXPECT_EQ(10, playout.plies());
+	EXPECT_EQ(10, board.ply());
+	playout.rewind(board);
+	EXPECT_EQ(0, board.ply());
+	EXPECT_EQ(Board().key(), board.key());
+}
+
+TEST(PlayoutTest, Play_InsufficientMaterial) {
+	Board board(std::string("8/8/4k3/8/8/3NK3/8/8 w - - 0 1"));
+	Playout playout(1);
+	EXPECT_EQ(0, playout.play(board));
+	EXPECT_EQ(0, playout.plies());
+}
+
+} // namespace chess
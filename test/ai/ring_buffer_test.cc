@@ -0,0 +1,103 @@
+#include "src/ai/parse/ring_buffer.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace chess {
+
+TEST(RingBufferTest, TryPushPop_FifoAndBounded) {
+	RingBuffer<int> queue(3);
+	EXPECT_EQ(4u, queue.capacity());
+	for (int i = 0; i < 4; i++)
+		EXPECT_TRUE(queue.try_push(int(i)));
+	EXPECT_FALSE(queue.try_push(4));
+	EXPECT_EQ(4u, queue.size());
+
+	int value;
+	for (int i = 0; i < 4; i++) {
+		ASSERT_TRUE(queue.try_pop(value));
+		EXPECT_EQ(i, value);
+	}
+	EXPECT_FALSE(queue.try_pop(value));
+	EXPECT_EQ(0u, queue.size());
+}
+
+TEST(RingBufferTest, Push_MovesOnlyOnSuccess) {
+	RingBuffer<std::unique_ptr<int>> queue(2);
+	queue.push(std::unique_ptr<int>(new int(1)));
+	queue.push(std::unique_ptr<int>(new int(2)));
+	std::unique_ptr<int> rejected(new int(3));
+	EXPECT_FALSE(queue.try_push(std::move(rejected)));
+	ASSERT_TRUE(rejected);
+	EXPECT_EQ(1, *queue.pop());
+	EXPECT_TRUE(queue.try_push(std::move(rejected)));
+	EXPECT_FALSE(rejected);
+	EXPECT_EQ(2, *queue.pop());
+	EXPECT_EQ(3, *queue.pop());
+}
+
+TEST(RingBufferTest, PushPopBatch_KeepsOrder) {
+	RingBuffer<int> queue(8);
+	std::vector<int> batch = {1, 2, 3, 4, 5};
+	queue.push(batch);
+	EXPECT_TRUE(batch.empty());
+
+	std::vector<int> popped;
+	EXPECT_EQ(3u, queue.pop(popped, 3));
+	EXPECT_EQ(2u, queue.pop(popped, 10));
+	EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 5}), popped);
+}
+
+TEST(RingBufferTest, PushPop_ManyProducersAndConsumers) {
+	const int kProducers = 4, kConsumers = 4, kItems = 20000;
+	RingBuffer<int> queue(16);
+	std::atomic<long long> sum(0);
+	std::atomic<int> count(0);
+
+	std::vector<std::thread> threads;
+	for (int c = 0; c < kConsumers; c++) {
+		threads.emplace_back([&]() {
+			std::vector<int> batch;
+			while (true) {
+				batch.clear();
+				queue.pop(batch, 4);
+				for (int value : batch) {
+					if (value < 0)
+						return;
+					sum += value;
+					count++;
+				}
+			}
+		});
+	}
+	std::vector<std::thread> producers;
+	for (int p = 0; p < kProducers; p++) {
+		producers.emplace_back([&]() {
+			for (int i = 1; i <= kItems; i++)
+				queue.push(int(i));
+		});
+	}
+	for (auto& producer : producers)
+		producer.join();
+
+	// Each consumer stops at the first pill in its batch, so every consumer
+	// gets a batch of its own
+	for (int c = 0; c < kConsumers; c++) {
+		while (queue.size())
+			std::this_thread::yield();
+		queue.push(-1);
+		while (queue.size())
+			std::this_thread::yield();
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(kProducers * kItems, count.load());
+	EXPECT_EQ(static_cast<long long>(kProducers) * kItems * (kItems + 1) / 2,
+		sum.load());
+}
+
+} // namespace chess
@@ -0,0 +1,89 @@
+#include "src/ai/parse/parser.h"
+#include "src/ai/parse/sample_dataset.h"
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace chess {
+
+namespace {
+
+/*! A temporary directory, removed with its contents. */
+class SampleDatasetTest : public ::testing::Test {
+protected:
+	std::string _directory;
+
+	void SetUp() override {
+		char path[] = "/tmp/sample_datasetXXXXXX";
+		ASSERT_TRUE(mkdtemp(path));
+		_directory = path;
+	}
+
+	void TearDown() override {
+		ASSERT_EQ(0, std::system(("rm -rf " + _directory).c_str()));
+	}
+
+	/*! Parses the games into four shards. */
+	ParseStats parse(int games) {
+		std::string pgn;
+		for (int i = 0; i < games; i++)
+			pgn += "[Result \"1-0\"]\n\n1. f3 e5 2. g4 Qh4 1-0\n\n";
+		std::ostringstream log;
+		Parser parser(_directory + "/games", log, 4);
+		std::istringstream in(pgn);
+		return parser.parse(in);
+	}
+};
+
+} // namespace
+
+TEST_F(SampleDatasetTest, Read_EveryShardAsOneDataset) {
+	EXPECT_EQ(150u, parse(150).games);
+
+	SampleDataset dataset(_directory + "/games.manifest");
+	ASSERT_EQ(4u, dataset.shards().size());
+	EXPECT_EQ("games.2.samples", dataset.shards()[2].path);
+	EXPECT_EQ(150u, dataset.size());
+
+	Sample sample;
+	uint64_t count = 0;
+	while (dataset.read(sample)) {
+		EXPECT_EQ(4u, sample.moves.size());
+		count++;
+	}
+	EXPECT_EQ(150u, count);
+	EXPECT_FALSE(dataset.read(sample));
+
+	dataset.rewind();
+	std::stringstream merged;
+	EXPECT_EQ(150u, dataset.merge(merged));
+	SampleReader reader(merged);
+	for (count = 0; reader.read(sample); count++) {}
+	EXPECT_EQ(150u, count);
+}
+
+TEST_F(SampleDatasetTest, Read_MismatchedOrMissingShardsFail) {
+	parse(10);
+	std::vector<Shard> shards = {{"games.0.samples", 1000}};
+	SampleDataset::save(_directory + "/wrong.manifest", shards);
+	SampleDataset wrong(_directory + "/wrong.manifest");
+	Sample sample;
+	EXPECT_THROW(while (wrong.read(sample)) {}, std::runtime_error);
+
+	shards = {{"missing.samples", 0}};
+	SampleDataset::save(_directory + "/missing.manifest", shards);
+	SampleDataset missing(_directory + "/missing.manifest");
+	EXPECT_THROW(missing.read(sample), std::runtime_error);
+
+	std::ofstream(_directory + "/bad.manifest") << "CHSM 1\nmany games\n";
+	EXPECT_THROW(SampleDataset(_directory + "/bad.manifest"),
+		std::runtime_error);
+	EXPECT_THROW(SampleDataset(_directory + "/none.manifest"),
+		std::runtime_error);
+}
+
+} // namespace chess
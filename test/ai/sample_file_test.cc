@@ -0,0 +1,74 @@
+#include "src/ai/parse/sample_file.h"
+#include "src/ai/struct/board.h"
+#include "sample_helper.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+TEST(SampleFileTest, Read_RoundTripsSamples) {
+	std::vector<Sample> samples = {
+		game({"e2e4", "e7e5", "g1f3"}, 1, 1850, 2210),
+		game({}, 0, 0, 2210),
+		game({"e2e4", "d7d5", "e4d5"}, -1, 1850, 2210),
+	};
+	samples[2].scores = {20, -35, 32767};
+
+	std::stringstream stream;
+	SampleWriter writer(stream);
+	for (const auto& sample : samples)
+		writer.write(sample);
+	EXPECT_EQ(3u, writer.count());
+	EXPECT_EQ(8u + 3 * 12 + 6 + 6 + 2 + 6, stream.str().size());
+
+	EXPECT_TRUE(SampleReader::matches(stream));
+	SampleReader reader(stream);
+	Sample sample;
+	for (const auto& expected : samples) {
+		ASSERT_TRUE(reader.read(sample));
+		EXPECT_EQ(expected.moves, sample.moves);
+		EXPECT_EQ(expected.scores, sample.scores);
+		EXPECT_EQ(expected.result, sample.result);
+		EXPECT_EQ(expected.white_elo, sample.white_elo);
+		EXPECT_EQ(expected.black_elo, sample.black_elo);
+	}
+	EXPECT_FALSE(reader.read(sample));
+	EXPECT_EQ(3u, reader.count());
+}
+
+TEST(SampleFileTest, Read_RejectsForeignAndTruncatedFiles) {
+	std::istringstream archive("22 serialization::archive 17 0 0");
+	EXPECT_FALSE(SampleReader::matches(archive));
+	EXPECT_THROW(SampleReader reader(archive), std::runtime_error);
+
+	std::stringstream stream;
+	SampleWriter writer(stream);
+	writer.write(game({"e2e4", "e7e5"}, 1));
+	std::string data = stream.str();
+
+	std::istringstream truncated(data.substr(0, data.size() - 1));
+	SampleReader reader(truncated);
+	Sample sample;
+	EXPECT_THROW(reader.read(sample), std::runtime_error);
+
+	std::string oversized = data;
+	oversized.replace(8, 4, "\xff\xff\xff\x7f");
+	std::istringstream corrupt(oversized);
+	SampleReader corrupt_reader(corrupt);
+	try {
+		corrupt_reader.read(sample);
+		ADD_FAILURE() << "oversized record was read";
+	} catch (const std::runtime_error& error) {
+		EXPECT_STREQ("malformed sample record", error.what());
+	}
+
+	data[4] = 99;
+	std::istringstream version(data);
+	EXPECT_THROW(SampleReader reader(version), std::runtime_error);
+}
+
+} // namespace chess
@@ -0,0 +1,39 @@
+#ifndef SAMPLE_HELPER_H
+#define SAMPLE_HELPER_H
+
+#include "src/ai/parse/sample_file.h"
+#include "src/ai/struct/board.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace chess {
+
+/*! Sample test helper
+ * Samples are what the parser produces and what the book builder and the
+ * Markov engine learn from; tests build them from moves in coordinate
+ * notation rather than from PGN.
+ */
+
+/*! Builds a sample from moves in coordinate notation. */
+inline Sample game(const std::vector<std::string>& moves, int result,
+		int white_elo = 2000, int black_elo = 1800) {
+	Sample sample;
+	Board board;
+	for (const auto& text : moves) {
+		PackedMove move = board.parse(text);
+		EXPECT_NE(0, move) << text;
+		board.make(move);
+		sample.moves.push_back(unpack(move));
+	}
+	sample.result = result;
+	sample.white_elo = white_elo;
+	sample.black_elo = black_elo;
+	return sample;
+}
+
+} // namespace chess
+
+#endif // SAMPLE_HELPER_H
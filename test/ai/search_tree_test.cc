@@ -0,0 +1,77 @@
+#include "src/ai/struct/search_tree.h"
+#include "gtest/gtest.h"
+
+namespace chess {
+
+TEST(SearchTreeTest, Expand_ContiguousChildren) {
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+
+	SearchTree tree(1);
+	ASSERT_TRUE(tree.expand(0, moves, nullptr));
+	EXPECT_EQ(21, tree.size());
+	EXPECT_EQ(1, tree[0].first.load());
+	EXPECT_EQ(20, tree[0].size);
+	EXPECT_FLOAT_EQ(1.0f / 20, tree[1].prior);
+	EXPECT_EQ(moves[7], tree[8].move);
+	EXPECT_EQ(8, tree.child(0, moves[7]));
+	EXPECT_EQ(0, tree.child(0, 0));
+}
+
+TEST(SearchTreeTest, Expand_FullArena) {
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+
+	SearchTree tree(0);
+	uint32_t node = 0;
+	while (tree.size() + moves.size <= tree.capacity()) {
+		ASSERT_TRUE(tree.expand(node, moves, nullptr));
+		node = tree[node].first.load();
+	}
+	EXPECT_FALSE(tree.expand(node, moves, nullptr));
+	EXPECT_FALSE(tree[node].expanded());
+}
+
+TEST(SearchTreeTest, Reroot_KeepsSubtree) {
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+
+	SearchTree tree(1);
+	tree.expand(0, moves, nullptr);
+	uint32_t e4 = tree.child(0, board.parse("e2e4"));
+	tree[e4].visits = 7;
+
+	board.make(board.parse("e2e4"));
+	MoveList replies;
+	board.legal(replies);
+	tree.expand(e4, replies, nullptr);
+	uint32_t e5 = tree.child(e4, board.parse("e7e5"));
+	tree[e5].visits = 3;
+
+	tree.reroot(e4);
+	EXPECT_EQ(1 + replies.size, tree.size());
+	EXPECT_EQ(7, tree[0].visits.load());
+	EXPECT_EQ(3, tree[tree.child(0, board.parse("e7e5"))].visits.load());
+}
+
+TEST(SearchTreeTest, Expand_ClaimedOnce) {
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+
+	SearchTree tree(1);
+	tree[0].first.store(TreeNode::kBusy);
+	EXPECT_FALSE(tree[0].expanded());
+	EXPECT_FALSE(tree.expand(0, moves, nullptr));
+	EXPECT_EQ(1, tree.size());
+
+	tree[0].first.store(0);
+	EXPECT_TRUE(tree.expand(0, moves, nullptr));
+	EXPECT_FALSE(tree.expand(0, moves, nullptr));
+	EXPECT_EQ(21, tree.size());
+}
+
+} // namespace chess
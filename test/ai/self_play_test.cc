@@ -0,0 +1,93 @@
+#include "src/ai/match/self_play.h"
+#include "src/ai/alpha_beta_engine.h"
+#include "src/ai/random_engine.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <sstream>
+
+namespace chess {
+
+namespace {
+
+/*! Plays a run of self-play and reads the samples back. */
+std::vector<Sample> generate(const SelfPlayOptions& options) {
+	std::stringstream stream;
+	{
+		SampleWriter out(stream);
+		SelfPlay games([]() {
+			SearchOptions search;
+			search.table_size = 1;
+			return std::unique_ptr<Engine>(new AlphaBetaEngine(search));
+		}, out, options);
+		const SelfPlayStats& stats = games.run();
+		EXPECT_EQ(options.games, stats.score.games());
+	}
+
+	std::vector<Sample> samples(options.games);
+	SampleReader in(stream);
+	for (auto& sample : samples)
+		EXPECT_TRUE(in.read(sample));
+	EXPECT_FALSE(in.read(samples.back()));
+	return samples;
+}
+
+} // namespace
+
+TEST(SelfPlayTest, Play_ScoresEveryPosition) {
+	RandomEngine engine(3);
+	std::mt19937 prng(1);
+	SelfPlayOptions options;
+	options.max_plies = 50;
+	options.rating = 1500;
+
+	Sample sample = SelfPlay::play(engine, prng, options);
+	EXPECT_LE(sample.moves.size(), 50u);
+	EXPECT_EQ(sample.moves.size(), sample.scores.size());
+	EXPECT_EQ(1500, sample.white_elo);
+	EXPECT_EQ(1500, sample.black_elo);
+}
+
+TEST(SelfPlayTest, Run_RoundTrip) {
+	SelfPlayOptions options;
+	options.games = 4;
+	options.threads = 2;
+	options.limits.depth = 1;
+	options.max_plies = 40;
+
+	std::vector<Sample> samples = generate(options);
+	for (auto& sample : samples) {
+		EXPECT_FALSE(sample.moves.empty());
+		EXPECT_EQ(sample.moves.size(), sample.scores.size());
+
+		// Every recorded move must be legal in sequence
+		Board board;
+		for (auto& move : sample.moves) {
+			MoveList moves;
+			board.legal(moves);
+			PackedMove packed = pack(move);
+			ASSERT_NE(moves.end(), std::find(moves.begin(), moves.end(), packed));
+			board.make(packed);
+		}
+	}
+}
+
+TEST(SelfPlayTest, Run_Deterministic) {
+	SelfPlayOptions options;
+	options.games = 2;
+	options.threads = 1;
+	options.limits.depth = 1;
+	options.max_plies = 30;
+
+	std::vector<Sample> first = generate(options);
+	std::vector<Sample> second = generate(options);
+	for (size_t i = 0; i < first.size(); i++) {
+		EXPECT_EQ(first[i].moves, second[i].moves);
+		EXPECT_EQ(first[i].scores, second[i].scores);
+	}
+
+	// Different games are opened differently
+	EXPECT_NE(first[0].moves, first[1].moves);
+}
+
+} // namespace chess
@@ -0,0 +1,167 @@
+#include "src/ai/tablebase/generator.h"
+#include "src/ai/tablebase/tablebase.h"
+#include "src/ai/alpha_beta_engine.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+namespace chess {
+
+/*!
+ * Generates the tables once for every test, since the larger ones take a while.
+ */
+class TablebaseTest : public ::testing::Test {
+protected:
+	static TablebaseGenerator* generator;
+
+	static void SetUpTestCase() {
+		generator = new TablebaseGenerator(2);
+		generator->generate("KQK");
+		generator->generate("KRK");
+		generator->generate("KPK");
+	}
+
+	static void TearDownTestCase() {
+		delete generator;
+		generator = nullptr;
+	}
+
+	/*! Probes the position described by the FEN string. */
+	static bool probe(const Tablebase& tablebase, const std::string& fen,
+			int& wdl, int& dtm) {
+		Board board(fen);
+		return tablebase.probe(board, wdl, dtm);
+	}
+};
+
+TablebaseGenerator* TablebaseTest::generator = nullptr;
+
+TEST(MaterialTest, Material_StrongerSidePlaysWhite) {
+	EXPECT_EQ("KRK", Material("KKR").name());
+	EXPECT_EQ("KQKR", Material("KRKQ").name());
+	EXPECT_EQ("KRNK", Material("KNRK").name());
+	EXPECT_EQ(528u * 2 * 64, Material("KQK").size());
+	EXPECT_EQ(32u * 64 * 2 * 64, Material("KPK").size());
+	EXPECT_THROW(Material("KQRPKR"), std::invalid_argument);
+	EXPECT_THROW(Material("QK"), std::invalid_argument);
+	EXPECT_THROW(Material("KXK"), std::invalid_argument);
+}
+
+TEST(MaterialTest, Index_DecodeRoundTrips) {
+	const char* names[] = {"KQK", "KPK", "KRKN", "KNNK"};
+	for (const char* name : names) {
+		Material material(name);
+		for (uint64_t index = 0; index < material.size(); index += 97) {
+			Placement placement = material.decode(index);
+			uint64_t canonical = material.index(placement);
+			EXPECT_LE(canonical, index);
+			EXPECT_EQ(canonical, material.index(material.decode(canonical)));
+		}
+	}
+}
+
+TEST(MaterialTest, Index_SymmetricPlacementsShareIndex) {
+	Material material("KRK");
+	Placement placement;
+	placement.add(kKing, 63);
+	placement.add(kKing | 8, 0);
+	placement.add(kRook, 9);
+
+	// Reflect in either axis, or in the diagonal
+	const int symmetries[][3] = {{56, 7, 14}, {7, 56, 49}, {0, 63, 54}};
+	for (const auto& squares : symmetries) {
+		Placement other;
+		other.add(kKing, squares[0]);
+		other.add(kKing | 8, squares[1]);
+		other.add(kRook, squares[2]);
+		EXPECT_EQ(material.index(placement), material.index(other));
+	}
+}
+
+TEST_F(TablebaseTest, Generate_LongestMates) {
+	// The longest wins with a queen, rook and pawn take 10, 16 and 28 moves
+	EXPECT_EQ(10, generator->generate("KQK").longest);
+	EXPECT_EQ(16, generator->generate("KRK").longest);
+	EXPECT_EQ(28, generator->generate("KPK").longest);
+
+	const TableStats& stats = generator->generate("KQK");
+	EXPECT_EQ(Material("KQK").size(),
+		stats.wins + stats.draws + stats.losses + stats.illegal);
+	EXPECT_THROW(generator->generate("KNK"), std::invalid_argument);
+}
+
+TEST_F(TablebaseTest, Probe_KnownPositions) {
+	const Tablebase& tablebase = generator->tablebase();
+	int wdl, dtm;
+
+	ASSERT_TRUE(probe(tablebase, "k7/1Q6/1K6/8/8/8/8/8 b - - 0 1", wdl, dtm));
+	EXPECT_EQ(-1, wdl);
+	EXPECT_EQ(0, dtm);
+
+	ASSERT_TRUE(probe(tablebase, "k7/8/1K6/8/8/8/8/6Q1 w - - 0 1", wdl, dtm));
+	EXPECT_EQ(1, wdl);
+	EXPECT_EQ(1, dtm);
+
+	// Either color may hold the extra piece
+	ASSERT_TRUE(probe(tablebase, "8/8/8/8/8/1k6/7q/K7 b - - 0 1", wdl, dtm));
+	EXPECT_EQ(1, wdl);
+	EXPECT_EQ(1, dtm);
+
+	// The king in front of its pawn on the sixth rank wins whoever moves
+	ASSERT_TRUE(probe(tablebase, "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", wdl, dtm));
+	EXPECT_EQ(1, wdl);
+	ASSERT_TRUE(probe(tablebase, "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", wdl, dtm));
+	EXPECT_EQ(-1, wdl);
+	ASSERT_TRUE(probe(tablebase, "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", wdl, dtm));
+	EXPECT_EQ(0, wdl);
+
+	ASSERT_TRUE(probe(tablebase, "8/8/8/4k3/8/8/8/KB6 w - - 0 1", wdl, dtm));
+	EXPECT_EQ(0, wdl);
+	EXPECT_FALSE(probe(tablebase, "8/8/8/4k3/8/8/8/KRR5 w - - 0 1", wdl, dtm));
+	EXPECT_FALSE(probe(tablebase, "4k3/8/8/8/8/8/8/R3K3 w Q - 0 1", wdl, dtm));
+}
+
+TEST_F(TablebaseTest, Load_MapsSavedTables) {
+	char directory[] = "/tmp/tablebase_testXXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(directory));
+	generator->save(directory);
+
+	{
+		Tablebase tablebase;
+		EXPECT_EQ(3u, tablebase.load(directory));
+		EXPECT_EQ(3, tablebase.pieces());
+
+		int wdl, dtm, expected_wdl, expected_dtm;
+		std::string fen = "8/8/8/4k3/8/8/8/KR6 w - - 0 1";
+		ASSERT_TRUE(probe(tablebase, fen, wdl, dtm));
+		ASSERT_TRUE(probe(generator->tablebase(), fen, expected_wdl, expected_dtm));
+		EXPECT_EQ(expected_wdl, wdl);
+		EXPECT_EQ(expected_dtm, dtm);
+	}
+
+	const char* names[] = {"KQK", "KRK", "KPK"};
+	for (const char* name : names)
+		std::remove((std::string(directory) + "/" + name + ".tb").c_str());
+	rmdir(directory);
+}
+
+TEST_F(TablebaseTest, Search_FindsMateBeyondHorizon) {
+	Board board(std::string("8/8/8/4k3/8/8/8/KR6 w - - 0 1"));
+	MoveList moves;
+	board.legal(moves);
+
+	SearchOptions options;
+	options.depth = 2;
+	AlphaBetaEngine engine(options);
+	engine.tablebase(&generator->tablebase());
+	engine.select(board, moves);
+	int bound = AlphaBetaEngine::kMateBound;
+	EXPECT_GT(engine.stats().score, bound);
+	EXPECT_GT(engine.stats().tablebase_hits, 0u);
+}
+
+} // namespace chess
@@ -0,0 +1,127 @@
+#include "src/ai/search/time_manager.h"
+#include "src/ai/alpha_beta_engine.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace chess {
+
+TEST(TimeManagerTest, Start_Unlimited) {
+	TimeManager clock;
+	clock.start(Limits());
+	EXPECT_EQ(-1, clock.soft());
+	EXPECT_EQ(-1, clock.hard());
+	EXPECT_TRUE(clock.deepen());
+	EXPECT_FALSE(clock.check(1000000));
+}
+
+TEST(TimeManagerTest, Start_MoveTime) {
+	Limits limits;
+	limits.move_time = 1000;
+	TimeManager clock;
+	clock.start(limits);
+	EXPECT_EQ(1000 - TimeManager::kOverhead, clock.soft());
+	EXPECT_EQ(clock.soft(), clock.hard());
+}
+
+TEST(TimeManagerTest, Start_Clock) {
+	Limits limits;
+	limits.time = 60000;
+	limits.increment = 1000;
+	TimeManager clock;
+	clock.start(limits);
+
+	// Roughly a thirtieth of the clock plus most of the increment, and never
+	// more than a third of what is left.
+	EXPECT_GT(clock.soft(), 2000);
+	EXPECT_LT(clock.soft(), 4000);
+	EXPECT_GE(clock.hard(), clock.soft());
+	EXPECT_LE(clock.hard(), 60000 / 3 + 1000);
+}
+
+TEST(TimeManagerTest, Check_NodeLimit) {
+	Limits limits;
+	limits.nodes = 5000;
+	TimeManager clock;
+	clock.start(limits);
+	EXPECT_FALSE(clock.check(100));
+	EXPECT_FALSE(clock.check(4999));
+	EXPECT_TRUE(clock.check(5000));
+	EXPECT_TRUE(clock.aborted());
+}
+
+TEST(TimeManagerTest, Stop_BeforeStart) {
+	TimeManager clock;
+	clock.stop();
+	clock.start(Limits());
+	EXPECT_TRUE(clock.check(TimeManager::kCheckInterval));
+	EXPECT_FALSE(clock.deepen());
+
+	clock.reset();
+	clock.start(Limits());
+	EXPECT_FALSE(clock.check(TimeManager::kCheckInterval));
+}
+
+TEST(TimeManagerTest, Ponder_LimitsApplyAfterHit) {
+	Limits limits;
+	limits.move_time = 40;
+	limits.ponder = true;
+	TimeManager clock;
+	clock.start(limits);
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+
+	// While pondering the allotment is ignored...
+	EXPECT_TRUE(clock.pondering());
+	EXPECT_TRUE(clock.deepen());
+	EXPECT_FALSE(clock.check(TimeManager::kCheckInterval));
+
+	// ...but time spent pondering counts once the expected reply is played
+	clock.ponderhit();
+	EXPECT_FALSE(clock.pondering());
+	EXPECT_FALSE(clock.deepen());
+	EXPECT_TRUE(clock.check(2 * TimeManager::kCheckInterval));
+}
+
+TEST(TimeManagerTest, Select_MoveTime) {
+	Board board(std::string(
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+	MoveList moves;
+	board.legal(moves);
+
+	Limits limits;
+	limits.move_time = 200;
+	AlphaBetaEngine engine;
+
+	auto start = std::chrono::steady_clock::now();
+	PackedMove move = engine.select(board, moves, limits);
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - start).count();
+
+	EXPECT_NE(0, move);
+	EXPECT_GT(engine.stats().depth, 0);
+	EXPECT_LT(elapsed, 400);
+}
+
+TEST(TimeManagerTest, Select_ExternalStop) {
+	Board board;
+	MoveList moves;
+	board.legal(moves);
+
+	Limits limits;
+	limits.infinite = true;
+	AlphaBetaEngine engine;
+
+	std::thread stopper([&engine] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		engine.stop();
+	});
+	PackedMove move = engine.select(board, moves, limits);
+	stopper.join();
+
+	EXPECT_NE(0, move);
+	EXPECT_GT(engine.stats().depth, 0);
+}
+
+} // namespace chess
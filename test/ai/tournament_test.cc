@@ -0,0 +1,70 @@
+#include "src/ai/match/tournament.h"
+#include "src/ai/alpha_beta_engine.h"
+#include "src/ai/random_engine.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+
+namespace chess {
+
+TEST(TournamentTest, Setup_Opening) {
+	Board moves = Tournament::setup("e2e4 e7e5");
+	EXPECT_EQ(kWhite, moves.turn());
+	EXPECT_EQ(2, moves.ply());
+
+	Board fen = Tournament::setup("7k/8/6K1/8/8/8/8/R7 w - - 0 1");
+	EXPECT_EQ(Board(std::string("7k/8/6K1/8/8/8/8/R7 w - - 0 1")).key(),
+		fen.key());
+
+	EXPECT_THROW(Tournament::setup("e2e5"), std::invalid_argument);
+}
+
+TEST(TournamentTest, Play_Mate) {
+	SearchOptions search;
+	search.depth = 2;
+	search.table_size = 1;
+	AlphaBetaEngine white(search);
+	RandomEngine black(1);
+
+	bool timeout = true;
+	MatchOptions options;
+	EXPECT_EQ(1, Tournament::play(white, black,
+		"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", options, timeout));
+	EXPECT_FALSE(timeout);
+}
+
+TEST(TournamentTest, Play_Insufficient) {
+	RandomEngine white(1), black(2);
+	bool timeout;
+	MatchOptions options;
+	EXPECT_EQ(0, Tournament::play(white, black,
+		"7k/8/6K1/8/8/8/8/N7 w - - 0 1", options, timeout));
+}
+
+TEST(TournamentTest, Run_StrongerEngineWins) {
+	MatchOptions options;
+	options.games = 4;
+	options.threads = 2;
+	options.limits.depth = 2;
+	options.max_plies = 200;
+
+	Tournament match(
+		[]() {
+			SearchOptions search;
+			search.table_size = 1;
+			return std::unique_ptr<Engine>(new AlphaBetaEngine(search));
+		},
+		[]() { return std::unique_ptr<Engine>(new RandomEngine(7)); },
+		options);
+
+	uint64_t reports = 0;
+	match.listen([&reports](const Score&) { reports++; });
+	const Score& score = match.run();
+	EXPECT_EQ(4u, score.games());
+	EXPECT_EQ(4u, reports);
+	EXPECT_GT(score.wins, score.losses);
+	EXPECT_EQ(0, match.decision());
+}
+
+} // namespace chess